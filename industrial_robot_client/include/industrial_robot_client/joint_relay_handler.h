@@ -36,11 +36,16 @@
 #include <string>
 #include <vector>
 
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+
 #include "ros/ros.h"
 #include "control_msgs/FollowJointTrajectoryFeedback.h"
 #include "sensor_msgs/JointState.h"
 #include "simple_message/message_handler.h"
 #include "simple_message/messages/joint_message.h"
+#include "industrial_robot_client/spsc_ring.h"
 
 
 namespace industrial_robot_client
@@ -50,11 +55,89 @@ namespace joint_relay_handler
 
 using industrial::joint_message::JointMessage;
 using industrial::simple_message::SimpleMessage;
+using industrial_robot_client::spsc_ring::SpscRing;
+using industrial_robot_client::spsc_ring::OverflowPolicy;
+namespace OverflowPolicies = industrial_robot_client::spsc_ring::OverflowPolicies;
+
+/**
+ * \brief Converts joint messages into the ROS messages published by
+ * JointRelayHandler.  The joints to publish (names and indices) are resolved
+ * once, in init(), and the ROS messages are filled in place, so that (once
+ * the ROS messages have been filled the first time) converting a message does
+ * not allocate memory.
+ *
+ * THIS CLASS IS NOT THREAD-SAFE
+ *
+ */
+class JointMessageConverter
+{
+public:
+
+  /**
+   * \brief Constructor
+   */
+  JointMessageConverter() : num_joints_(0) {};
+
+  /**
+   * \brief Class initializer
+   *
+   * \param num_joints number of joints, matching data from robot connection
+   * \param pub_joint_names joint names selected for publishing
+   * \param pub_joint_indices index (in robot connection data) of each joint
+   * selected for publishing
+   *
+   * \return true on success, false otherwise (an invalid joint index)
+   */
+  bool init(unsigned int num_joints, const std::vector<std::string>& pub_joint_names,
+            const std::vector<int>& pub_joint_indices);
+
+  /**
+   * \brief Reads joint positions from a joint message
+   *
+   * \param[in] msg_in Joint message from robot connection
+   * \param[out] all_joint_pos joint positions, in count/order matching robot
+   * connection (resized as required)
+   *
+   * \return true on success, false otherwise
+   */
+  bool getPositions(JointMessage& msg_in, std::vector<double>* all_joint_pos);
+
+  /**
+   * \brief Fills ROS messages with the joints selected for publishing.  Message
+   * fields other than the header stamp, joint names and positions are left
+   * untouched.
+   *
+   * \param[in] all_joint_pos joint positions, in count/order matching robot connection
+   * \param[in] stamp message time stamp
+   * \param[out] control_state FollowJointTrajectoryFeedback message for ROS publishing
+   * \param[out] sensor_state JointState message for ROS publishing
+   *
+   * \return true on success, false otherwise
+   */
+  bool toMessages(const std::vector<double>& all_joint_pos, const ros::Time& stamp,
+                  control_msgs::FollowJointTrajectoryFeedback* control_state,
+                  sensor_msgs::JointState* sensor_state);
+
+private:
+
+  unsigned int num_joints_;
+  std::vector<std::string> pub_joint_names_;
+  std::vector<int> pub_joint_indices_;
+};
 
 /**
  * \brief Message handler that relays joint positions (converts simple message
  * types to ROS message types and publishes them)
  *
+ * By default, messages are converted and published by the thread that
+ * receives them.  With a publish queue (see setPublishQueue), received joint
+ * messages are queued (lock-free) and converted/published by a separate
+ * thread, so that slow publishing never delays the connection.
+ *
+ * The joints to publish are selected (see select_joints) once, in init(), and
+ * messages are converted (see create_messages) into reused ROS messages, so
+ * that relaying a message does not allocate memory.
+ *
  * THIS CLASS IS NOT THREAD-SAFE
  *
  */
@@ -68,7 +151,12 @@ public:
   /**
 * \brief Constructor
 */
-  JointRelayHandler() {};
+  JointRelayHandler();
+
+  /**
+   * \brief Destructor, stops the publish thread (if any)
+   */
+  ~JointRelayHandler();
 
 
  /**
@@ -83,14 +171,118 @@ public:
   */
  bool init(industrial::smpl_msg_connection::SmplMsgConnection* connection, std::vector<std::string> &joint_names);
 
+  /**
+   * \brief Enables/disables the publish queue (disabled by default).  When
+   * enabled, received joint messages are queued and published by a separate
+   * thread.  Should be called before messages are received.
+   *
+   * \param size queue size (messages), 0 disables the queue (messages are
+   * published by the receiving thread)
+   * \param policy queue overflow policy (see OverflowPolicy)
+   *
+   * \return true on success, false otherwise
+   */
+  bool setPublishQueue(unsigned int size,
+                       OverflowPolicy policy = OverflowPolicies::DROP_OLDEST);
+
+  /**
+   * \brief returns the number of joint messages queued for publishing (see
+   * setPublishQueue)
+   *
+   * \return number of queued messages
+   */
+  unsigned long getNumQueued()
+  {
+    return this->publish_queue_.getNumPushed();
+  }
+
+  /**
+   * \brief returns the number of queued joint messages dropped (not
+   * published) because the publish queue overflowed
+   *
+   * \return number of dropped messages
+   */
+  unsigned long getNumDropped()
+  {
+    return this->publish_queue_.getNumDropped();
+  }
+
+  /**
+   * \brief returns the number of joint messages published
+   *
+   * \return number of published messages
+   */
+  unsigned long getNumPublished()
+  {
+    return this->num_published_.load(boost::memory_order_relaxed);
+  }
+
 protected:
 
+  /**
+   * \brief joint message, as queued for publishing
+   */
+  struct JointSample
+  {
+    JointMessage msg;
+    ros::Time stamp;  // time the message was received
+  };
+
   std::vector<std::string> all_joint_names_;
 
   ros::Publisher pub_joint_control_state_;
   ros::Publisher pub_joint_sensor_state_;
   ros::NodeHandle node_;
 
+  /**
+   * \brief time the joint message being published was received (used to
+   * stamp the published messages, see create_messages)
+   */
+  ros::Time stamp_;
+
+  /**
+   * \brief joint message conversion (see create_messages).  Positions and ROS
+   * messages are reused from one joint message to the next.
+   */
+  JointMessageConverter converter_;
+  std::vector<double> all_joint_pos_;
+  std::vector<double> xform_joint_pos_;
+  control_msgs::FollowJointTrajectoryFeedback control_state_;
+  sensor_msgs::JointState sensor_state_;
+
+  /**
+   * \brief publish queue and thread (see setPublishQueue).  The publish
+   * thread sleeps on the condition (only) when the queue is empty.
+   */
+  SpscRing<JointSample> publish_queue_;
+  bool publish_queued_;
+  boost::thread* publish_thread_;
+  boost::mutex publish_mutex_;
+  boost::condition_variable publish_cond_;
+  boost::atomic<bool> publish_idle_;
+  boost::atomic<bool> publish_stop_;
+  boost::atomic<unsigned long> num_published_;
+
+  /**
+   * \brief Converts and publishes a joint message
+   *
+   * \param in joint message
+   * \param stamp time the message was received
+   *
+   * \return true on success, false otherwise
+   */
+  bool publish(JointMessage& in, const ros::Time& stamp);
+
+  /**
+   * \brief Publishes queued joint messages until stopped
+   */
+  void publishThread();
+
+  /**
+   * \brief Stops (and joins) the publish thread, if running
+   */
+  void stopPublishThread();
+
   /**
    * \brief Convert joint message into publish message-types
    *
@@ -120,7 +312,10 @@ protected:
   }
 
   /**
-   * \brief Select specific joints for publishing
+   * \brief Select specific joints for publishing.  NOTE: This is no longer
+   * called when relaying messages, the published joints are resolved once
+   * (see select_joints).  Subclasses that customize the published joints must
+   * override select_joints instead.
    *
    * \param[in] all_joint_pos joint positions, in count/order matching robot connection
    * \param[in] all_joint_names joint names, matching all_joint_pos
@@ -132,6 +327,21 @@ protected:
   virtual bool select(const std::vector<double>& all_joint_pos, const std::vector<std::string>& all_joint_names,
                       std::vector<double>* pub_joint_pos, std::vector<std::string>* pub_joint_names);
 
+  /**
+   * \brief Select the joints to publish.  Called once, by init(), the
+   * selected joints are published for every message.  Can be overridden to
+   * publish a subset (or reordering) of the robot joints.  By default, all
+   * joints with non-blank names are published.
+   *
+   * \param[in] all_joint_names joint names, in count/order matching robot connection
+   * \param[out] pub_joint_indices index (into all_joint_names) of each joint selected for publishing
+   * \param[out] pub_joint_names joint names selected for publishing
+   *
+   * \return true on success, false otherwise
+   */
+  virtual bool select_joints(const std::vector<std::string>& all_joint_names,
+                             std::vector<int>* pub_joint_indices, std::vector<std::string>* pub_joint_names);
+
   /**
    * \brief Callback executed upon receiving a joint message
    *
@@ -33,6 +33,7 @@
 #define JOINT_TRAJECTORY_DOWNLOADER_H
 
 #include "industrial_robot_client/joint_trajectory_interface.h"
+#include "simple_message/joint_traj_pt_full.h"
 
 namespace industrial_robot_client
 {
@@ -40,19 +41,106 @@ namespace joint_trajectory_downloader
 {
 
 using industrial_robot_client::joint_trajectory_interface::JointTrajectoryInterface;
+using industrial::smpl_msg_connection::SmplMsgConnection;
 using industrial::joint_traj_pt_message::JointTrajPtMessage;
+using industrial::joint_traj_pt_full::JointTrajPtFull;
 
 /**
  * \brief Message handler that downloads joint trajectories to
  * a robot controller that supports the trajectory downloading interface
+ *
+ * By default the trajectory is downloaded point by point (JOINT_TRAJ_PT
+ * messages).  For controllers that support it, the trajectory can instead be
+ * downloaded in as few JOINT_TRAJ_FULL messages as possible (see ROS param
+ * "~full_trajectory_download").
+ *
+ * Download messages may also be batched (coalesced into as few socket writes
+ * as possible, see SmplMsgConnection::setBatching), which is enabled by ROS
+ * param "~batch_download".
  */
 class JointTrajectoryDownloader : public JointTrajectoryInterface
 {
 
 public:
 
+  // since this class defines a different init(), this helps find the base-class init()
+  using JointTrajectoryInterface::init;
+
+  /**
+   * \brief Default constructor
+   */
+  JointTrajectoryDownloader() : full_download_(false) {};
+
+  /**
+   * \brief Class initializer
+   *
+   * \param connection simple message connection that will be used to send commands to robot (ALREADY INITIALIZED)
+   * \param joint_names list of expected joint-names.
+   *   - Count and order should match data sent to robot connection.
+   *   - Use blank-name to insert a placeholder joint position (typ. 0.0).
+   *   - Joints in the incoming JointTrajectory stream that are NOT listed here will be ignored.
+   * \param velocity_limits map of maximum velocities for each joint
+   *   - leave empty to lookup from URDF
+   * \return true on success, false otherwise (an invalid message type)
+   *
+   * Whole-trajectory (JOINT_TRAJ_FULL) download is enabled by ROS param
+   * "~full_trajectory_download" (default: false)
+   *
+   * Batching of download messages is enabled by ROS param "~batch_download"
+   * (default: false)
+   */
+  virtual bool init(SmplMsgConnection* connection, const std::vector<std::string> &joint_names,
+                    const std::map<std::string, double> &velocity_limits = std::map<std::string, double>());
+
   bool send_to_robot(const std::vector<JointTrajPtMessage>& messages);
 
+  /**
+   * \brief Send trajectory points to the robot, using JOINT_TRAJ_FULL messages.
+   *   Each message holds as many points as will fit in a single message.
+   *   Messages are queued (see SmplMsgConnection::queueMsg) and flushed once
+   *   the complete trajectory has been queued.
+   *
+   * \param points trajectory points (in robot-format)
+   * \return true on success, false otherwise
+   */
+  bool send_to_robot(const std::vector<JointTrajPtFull>& points);
+
+protected:
+
+  // since this class defines a different trajectory_to_msgs(), this helps find the base-class version
+  using JointTrajectoryInterface::trajectory_to_msgs;
+
+  /**
+   * \brief Callback function registered to ROS topic-subscribe.
+   *   Downloads the complete trajectory (JOINT_TRAJ_FULL), if enabled, otherwise
+   *   the base-class (point by point) behavior is used.
+   *
+   * \param msg JointTrajectory message
+   */
+  virtual void jointTrajectoryCB(const trajectory_msgs::JointTrajectoryConstPtr &msg);
+
+  /**
+   * \brief Convert ROS trajectory message into full (time/position/velocity/acceleration)
+   *   trajectory points, for sending to the robot.
+   *
+   * \param[in] traj ROS JointTrajectory message
+   * \param[out] points list of robot trajectory points
+   * \return true on success, false otherwise
+   */
+  virtual bool trajectory_to_msgs(const trajectory_msgs::JointTrajectoryConstPtr &traj, std::vector<JointTrajPtFull>* points);
+
+  /**
+   * \brief Download trajectories with JOINT_TRAJ_FULL messages
+   */
+  bool full_download_;
+
+  /**
+   * \brief Maximum time (ms) a download message is batched (see
+   * SmplMsgConnection::setBatching).  Queued messages are flushed at the end
+   * of each download, so this only bounds the latency within long downloads.
+   */
+  static const int BATCH_DELAY = 20;
+
 };
 
 } //joint_trajectory_downloader
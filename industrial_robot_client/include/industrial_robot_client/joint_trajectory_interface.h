@@ -32,6 +32,7 @@
 #ifndef JOINT_TRAJECTORY_INTERFACE_H
 #define JOINT_TRAJECTORY_INTERFACE_H
 
+#include <list>
 #include <map>
 #include <vector>
 #include <string>
@@ -69,7 +70,8 @@ public:
  /**
   * \brief Default constructor.
   */
-    JointTrajectoryInterface() : default_joint_pos_(0.0), default_vel_ratio_(0.1), default_duration_(10.0) {};
+    JointTrajectoryInterface() : default_joint_pos_(0.0), default_vel_ratio_(0.1), default_duration_(10.0),
+    compact_joint_data_(false), conversion_threads_(1), last_point_time_(0.0), conversion_cache_size_(0) {};
 
     /**
      * \brief Initialize robot connection using default method.
@@ -79,6 +81,8 @@ public:
      * \param default_port default port to use for robot connection [OPTIONAL]
      *                    - this value will be used if ROS param "~port" cannot be read
      *
+     * Messages are byte swapped (at runtime) if ROS param "~byte_swapping" is true
+     *
      * \return true on success, false otherwise
      */
     virtual bool init(std::string default_ip = "", int default_port = StandardSocketPorts::MOTION);
@@ -104,6 +108,18 @@ public:
    * \param velocity_limits map of maximum velocities for each joint
    *   - leave empty to lookup from URDF
    * \return true on success, false otherwise (an invalid message type)
+   *
+   * By default joint data is sent with the legacy (10 joint) message layout.  If
+   * ROS param "~compact_joint_data" is true, only the listed joints are sent (this
+   * also allows robots with more than 10 joints).
+   *
+   * Large trajectories may be converted by multiple threads (see trajectory_to_msgs).
+   * ROS param "~conversion_threads" sets the number of threads (default 1, 0 for
+   * one per core).  Only enable it if select_point() and transform() are thread-safe.
+   *
+   * Converted trajectories are cached (see trajectory_to_msgs) if ROS param
+   * "~conversion_cache_size" (the maximum number of cached trajectories) is
+   * positive (default 0, disabled).
    */
   virtual bool init(SmplMsgConnection* connection, const std::vector<std::string> &joint_names,
                     const std::map<std::string, double> &velocity_limits = std::map<std::string, double>());
@@ -126,6 +142,17 @@ protected:
    * \brief Convert ROS trajectory message into stream of JointTrajPtMessages for sending to robot.
    *   Also includes various joint transforms that can be overridden for robot-specific behavior.
    *
+   *   Points are selected/transformed, and messages created, independently of each other
+   *   (in parallel, for large trajectories, see MIN_PARALLEL_POINTS).  The speed of each
+   *   point (see calc_speed) is then computed in order, in a single pass.
+   *
+   *   If the conversion cache is enabled (see init()), the messages of recently converted
+   *   trajectories are kept, and a trajectory identical to one of them (same joint names
+   *   and point data) is validated (see is_valid) but not converted again.  Only new
+   *   trajectories (that start no later than the previous point, see calc_duration) are
+   *   cached.  The cache should only be enabled if conversion depends on the trajectory
+   *   alone (i.e. select_point(), transform() and calc_speed() overrides are deterministic).
+   *
    * \param[in] traj ROS JointTrajectory message
    * \param[out] msgs list of JointTrajPtMessages for sending to robot
    *
@@ -136,6 +163,7 @@ protected:
   /**
    * \brief Transform joint positions before publishing.
    * Can be overridden to implement, e.g. robot-specific joint coupling.
+   * May be called concurrently for different points (see trajectory_to_msgs).
    *
    * \param[in] pt_in trajectory-point, in same order as expected for robot-connection.
    * \param[out] pt_out transformed trajectory-point (in same order/count as input positions)
@@ -149,7 +177,11 @@ protected:
   }
 
   /**
-   * \brief Select specific joints for sending to the robot
+   * \brief Select specific joints for sending to the robot: updates the joint map (see
+   *   update_joint_map) and selects the joints of the point (see select_point).
+   *   NOTE: Trajectories are converted (see trajectory_to_msgs) by updating the joint
+   *   map once and then calling select_point for each point, so this is not called
+   *   for trajectory points.  Robot-specific selection should override select_point.
    *
    * \param[in] ros_joint_names joint names from ROS command
    * \param[in] ros_pt target pos/vel from ROS command
@@ -161,6 +193,42 @@ protected:
   virtual bool select(const std::vector<std::string>& ros_joint_names, const trajectory_msgs::JointTrajectoryPoint& ros_pt,
                       const std::vector<std::string>& rbt_joint_names, trajectory_msgs::JointTrajectoryPoint* rbt_pt);
 
+  /**
+   * \brief Update the joint map (the index of each robot joint in the ROS command).
+   *   The map is only recomputed when the joint-name layout changes, so that
+   *   selecting joints for each trajectory point is a simple gather.
+   *
+   * \param ros_joint_names joint names from ROS command
+   * \param rbt_joint_names joint names, in order/count expected by robot connection
+   *
+   * \return true on success, false otherwise (a robot joint is missing from the ROS command)
+   */
+  bool update_joint_map(const std::vector<std::string>& ros_joint_names,
+                        const std::vector<std::string>& rbt_joint_names);
+
+  /**
+   * \brief Select specific joints of a trajectory point for sending to the robot,
+   *   using the current joint map (see update_joint_map), which must match the
+   *   point's joint names.  By default, joints are gathered using the joint map.
+   *   Can be overridden to implement robot-specific joint selection.
+   *   May be called concurrently for different points (see trajectory_to_msgs).
+   *
+   * \param[in] ros_pt target pos/vel from ROS command
+   * \param[out] rbt_pt target pos/vel, in order/count expected by robot connection
+   *
+   * \return true on success, false otherwise
+   */
+  virtual bool select_point(const trajectory_msgs::JointTrajectoryPoint& ros_pt,
+                            trajectory_msgs::JointTrajectoryPoint* rbt_pt);
+
+  /**
+   * \brief Resolve the velocity limits (joint_vel_limits_) of the robot joints
+   *   (all_joint_names_) into all_joint_vel_limits_, and clear the conversion
+   *   cache.  Called by init(), and should be called again if either is changed
+   *   afterwards.
+   */
+  void update_vel_limits();
+
   /**
    * \brief Reduce the ROS velocity commands (per-joint velocities) to a single scalar for communication to the robot.
    *   For flexibility, the robot command message contains both "velocity" and "duration" fields.  The specific robot
@@ -188,6 +256,8 @@ protected:
   /**
    * \brief Compute the expected move duration for communication to the robot.
    *   If unneeded by the robot server, set to 0 (or any value).
+   *   Called for each point, in order (the default duration is the time since the
+   *   previous point).
    *
    * \param[in] pt trajectory point data, in order/count expected by robot connection
    * \param[out] rbt_duration computed move duration for robot message (if needed by robot)
@@ -253,11 +323,87 @@ protected:
   double default_vel_ratio_;  // default velocity ratio to use for joint commands, if no velocity or max_vel specified
   double default_duration_;   // default duration to use for joint commands, if no
   std::map<std::string, double> joint_vel_limits_;  // cache of max joint velocities from URDF
+  std::vector<double> all_joint_vel_limits_;  // max velocity of each joint in all_joint_names_ (infinite if unspecified)
   sensor_msgs::JointState cur_joint_pos_;  // cache of last received joint state
+  bool compact_joint_data_;  // send only the listed joints (instead of the legacy 10 joint layout)
+  std::vector<int> joint_map_;  // ROS command index of each robot joint (-1 for "dummy joints")
+  std::vector<std::string> joint_map_ros_names_;  // ROS joint names the joint map was computed for
+  std::vector<std::string> joint_map_rbt_names_;  // robot joint names the joint map was computed for
+  int conversion_threads_;  // number of threads converting large trajectories (default 1, 0 = one per core)
+  double last_point_time_;  // time_from_start of the previous point (see calc_duration)
+  int conversion_cache_size_;  // maximum number of cached trajectories (0 = cache disabled)
+
+  /**
+   * \brief Converted trajectory, as cached by trajectory_to_msgs
+   */
+  struct ConversionCacheEntry
+  {
+    size_t hash;  // trajectory content hash
+    trajectory_msgs::JointTrajectoryConstPtr traj;
+    std::vector<JointTrajPtMessage> msgs;
+  };
+  std::list<ConversionCacheEntry> conversion_cache_;  // most recently used first
+
+  /**
+   * \brief Minimum number of trajectory points converted in parallel
+   */
+  static const size_t MIN_PARALLEL_POINTS = 1000;
 
 
 private:
-  static JointTrajPtMessage create_message(int seq, std::vector<double> joint_pos, double velocity, double duration);
+  JointTrajPtMessage create_message(int seq, std::vector<double> joint_pos, double velocity, double duration);
+
+  /**
+   * \brief Select and transform a range of trajectory points (see trajectory_to_msgs)
+   *
+   * \param[in] traj ROS JointTrajectory message
+   * \param[in] begin first point
+   * \param[in] end end of range (one past the last point)
+   * \param[out] xform_pts transformed points (already sized for the whole trajectory)
+   *
+   * \return true on success, false otherwise
+   */
+  bool transform_points(const trajectory_msgs::JointTrajectory& traj, size_t begin, size_t end,
+                        std::vector<trajectory_msgs::JointTrajectoryPoint>* xform_pts);
+
+  /**
+   * \brief Create messages for a range of trajectory points (see trajectory_to_msgs)
+   *
+   * \param[in] xform_pts transformed points
+   * \param[in] velocities robot velocity of each point
+   * \param[in] durations robot duration of each point
+   * \param[in] begin first point
+   * \param[in] end end of range (one past the last point)
+   * \param[out] msgs messages (already sized for the whole trajectory)
+   *
+   * \return true always
+   */
+  bool create_messages(const std::vector<trajectory_msgs::JointTrajectoryPoint>& xform_pts,
+                       const std::vector<double>& velocities, const std::vector<double>& durations,
+                       size_t begin, size_t end, std::vector<JointTrajPtMessage>* msgs);
+
+  /**
+   * \brief Find a trajectory in the conversion cache (see trajectory_to_msgs)
+   *
+   * \param[in] traj ROS JointTrajectory message
+   * \param[in] hash trajectory content hash
+   * \param[out] msgs cached messages (if found)
+   *
+   * \return true if found, false otherwise
+   */
+  bool find_cached_msgs(const trajectory_msgs::JointTrajectory& traj, size_t hash,
+                        std::vector<JointTrajPtMessage>* msgs);
+
+  /**
+   * \brief Add a converted trajectory to the conversion cache, evicting the least
+   *   recently used trajectory if the cache is full
+   *
+   * \param[in] traj ROS JointTrajectory message
+   * \param[in] hash trajectory content hash
+   * \param[in] msgs converted messages
+   */
+  void cache_msgs(const trajectory_msgs::JointTrajectoryConstPtr& traj, size_t hash,
+                  const std::vector<JointTrajPtMessage>& msgs);
 
   /**
    * \brief Callback function registered to ROS CmdJointTrajectory service
@@ -33,6 +33,7 @@
 #define JOINT_TRAJECTORY_STREAMER_H
 
 #include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include "industrial_robot_client/joint_trajectory_interface.h"
 
 namespace industrial_robot_client
@@ -59,6 +60,17 @@ typedef TransferStates::TransferState TransferState;
 
 //* JointTrajectoryStreamer
 /**
+ *
+ * Points are streamed using a window of (up to) N points "in flight", i.e. sent
+ * to the controller but not yet acknowledged (see ROS param "~streaming_window").
+ * The default window of 1 point sends each point and waits for its reply.  Replies
+ * are matched to points by sequence number, if the controller echoes the point,
+ * otherwise in order.  On a communications failure all un-acknowledged points
+ * are re-sent.
+ *
+ * All communication with the robot (including the stop command) is performed by
+ * the streaming thread.  New trajectories and stop requests wake the thread
+ * immediately, and the mutex is never held during socket I/O.
  *
  * THIS CLASS IS NOT THREAD-SAFE
  *
@@ -76,7 +88,7 @@ public:
    *
    * \param min_buffer_size minimum number of points as required by robot implementation
    */
-  JointTrajectoryStreamer(int min_buffer_size = 1) : min_buffer_size_(min_buffer_size) {};
+  JointTrajectoryStreamer(int min_buffer_size = 1) : min_buffer_size_(min_buffer_size), window_size_(1) {};
 
   /**
    * \brief Class initializer
@@ -89,6 +101,9 @@ public:
    * \param velocity_limits map of maximum velocities for each joint
    *   - leave empty to lookup from URDF
    * \return true on success, false otherwise (an invalid message type)
+   *
+   * The number of points streamed ahead of the controller's replies is read from
+   * ROS param "~streaming_window" (default: 1)
    */
   virtual bool init(SmplMsgConnection* connection, const std::vector<std::string> &joint_names,
                     const std::map<std::string, double> &velocity_limits = std::map<std::string, double>());
@@ -107,13 +122,47 @@ protected:
 
   void trajectoryStop();
 
+  /**
+   * \brief Sends points to the robot (called without the mutex held)
+   *
+   * \param points messages to send
+   *
+   * \return number of points sent (stops at first failure)
+   */
+  int sendPoints(std::vector<industrial::simple_message::SimpleMessage>& points);
+
+  /**
+   * \brief Acknowledges the in-flight point matching a reply (and any earlier
+   * points whose replies were skipped).  Called with the mutex held.
+   *
+   * \param reply reply received from the robot
+   */
+  void acknowledgeReply(industrial::simple_message::SimpleMessage& reply);
+
+  /**
+   * \brief Receives (and discards) replies to in-flight points, so that they
+   * aren't mistaken for the reply to a following command (called without the
+   * mutex held)
+   *
+   * \param count number of replies to receive
+   */
+  void drainReplies(int count);
+
+  static const double STOP_TIMEOUT_;  // = 5.0, max time to wait for stop command (s)
+
   boost::thread* streaming_thread_;
   boost::mutex mutex_;
-  int current_point_;
+  boost::condition_variable cond_;  // signals new trajectory/stop request (and stop sent)
+  int current_point_;  // oldest point that has not been acknowledged
+  int sent_point_;     // next point to send (sent_point_ - current_point_ are in flight)
+  int stale_replies_;  // outstanding replies to points of a replaced trajectory
+  int traj_id_;        // incremented each time a trajectory is loaded
+  bool stop_requested_;
   std::vector<JointTrajPtMessage> current_traj_;
   TransferState state_;
   ros::Time streaming_start_;
   int min_buffer_size_;
+  int window_size_;
 };
 
 } //joint_trajectory_streamer
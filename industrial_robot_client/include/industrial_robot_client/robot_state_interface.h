@@ -39,6 +39,7 @@
 #include "simple_message/message_manager.h"
 #include "simple_message/message_handler.h"
 #include "simple_message/socket/tcp_client.h"
+#include "simple_message/socket/udp_client.h"
 #include "industrial_robot_client/joint_relay_handler.h"
 #include "industrial_robot_client/robot_status_relay_handler.h"
 
@@ -51,6 +52,7 @@ using industrial::smpl_msg_connection::SmplMsgConnection;
 using industrial::message_manager::MessageManager;
 using industrial::message_handler::MessageHandler;
 using industrial::tcp_client::TcpClient;
+using industrial::udp_client::UdpClient;
 using industrial_robot_client::joint_relay_handler::JointRelayHandler;
 using industrial_robot_client::robot_status_relay_handler::RobotStatusRelayHandler;
 namespace StandardSocketPorts = industrial::simple_socket::StandardSocketPorts;
@@ -81,6 +83,13 @@ public:
    * \param default_port default port to use for robot connection [OPTIONAL]
    *                    - this value will be used if ROS param "~port" cannot be read
    *
+   * Messages are byte swapped (at runtime) if ROS param "~byte_swapping" is true
+   *
+   * If ROS param "~udp_state" is true, state data is received over UDP (with
+   * sequence numbers, only the latest message is processed), rather than TCP.
+   * The robot controller must send sequenced datagrams (see
+   * UdpSocket::setSequencing).
+   *
    * \return true on success, false otherwise
    */
   bool init(std::string default_ip = "", int default_port = StandardSocketPorts::STATE);
@@ -103,6 +112,12 @@ public:
    *   - Count and order should match data sent to robot connection.
    *   - Use blank-name to skip (not publish) a joint-position
    *
+   * Joint messages are published by a separate thread (see
+   * JointRelayHandler::setPublishQueue) if ROS param "~publish_queue_size"
+   * is greater than 0.  When the queue overflows, the oldest message is
+   * dropped, or if ROS param "~publish_latest_value" is true, all queued
+   * messages are dropped in favor of the latest.
+   *
    * \return true on success, false otherwise
    */
   bool init(SmplMsgConnection* connection, std::vector<std::string>& joint_names);
@@ -150,7 +165,13 @@ public:
   }
 
 protected:
+  /**
+   * \brief time limit (ms) for each UDP connect handshake (see "~udp_state")
+   */
+  static const int UDP_CONNECT_TIMEOUT = 1000;
+
   TcpClient default_tcp_connection_;
+  UdpClient default_udp_connection_;
   JointRelayHandler default_joint_handler_;
   RobotStatusRelayHandler default_robot_status_handler_;
 
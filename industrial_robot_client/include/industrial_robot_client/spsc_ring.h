@@ -0,0 +1,266 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2013, Southwest Research Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 	* Redistributions of source code must retain the above copyright
+ * 	notice, this list of conditions and the following disclaimer.
+ * 	* Redistributions in binary form must reproduce the above copyright
+ * 	notice, this list of conditions and the following disclaimer in the
+ * 	documentation and/or other materials provided with the distribution.
+ * 	* Neither the name of the Southwest Research Institute, nor the names
+ *	of its contributors may be used to endorse or promote products derived
+ *	from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <boost/atomic.hpp>
+#include <boost/scoped_array.hpp>
+
+namespace industrial_robot_client
+{
+namespace spsc_ring
+{
+
+/**
+ * \brief Enumeration of ring overflow policies (see SpscRing::push)
+ */
+namespace OverflowPolicies
+{
+enum OverflowPolicy
+{
+  DROP_OLDEST = 0,  // the oldest item is dropped to make room for the new item
+  LATEST_VALUE = 1  // all queued items are dropped, only the new item remains
+};
+}
+typedef OverflowPolicies::OverflowPolicy OverflowPolicy;
+
+/**
+ * \brief Bounded, lock-free, single producer/single consumer ring of items.
+ *
+ * Items are copied into (and out of) slots allocated by init, no memory is
+ * allocated afterwards.  Pushing never waits on the consumer, when the ring
+ * is full items are dropped according to the overflow policy.  Dropping
+ * reclaims slots the consumer may be reading, so each slot is guarded by a
+ * sequence number (seqlock) and a read that overlapped a write is retried.
+ * For this reason, items must be copyable without allocation (no heap owning
+ * members), a torn copy is discarded but must be harmless.
+ *
+ * Exactly one thread may push and one (other) thread may pop.  The
+ * statistics may be read from any thread.
+ */
+template<typename T>
+class SpscRing
+{
+public:
+
+  /**
+   * \brief Constructor, the ring must be initialized before use (see init)
+   */
+  SpscRing() :
+      capacity_(0), policy_(OverflowPolicies::DROP_OLDEST), head_(0), tail_(0), num_pushed_(0),
+      num_dropped_(0)
+  {
+  }
+
+  /**
+   * \brief Initializes (and empties) the ring.  Must not be called while the
+   * ring is in use.
+   *
+   * \param capacity maximum number of queued items
+   * \param policy overflow policy (see OverflowPolicy)
+   *
+   * \return true on success, false otherwise (invalid capacity)
+   */
+  bool init(unsigned int capacity, OverflowPolicy policy)
+  {
+    if (0 == capacity)
+    {
+      return false;
+    }
+    this->slots_.reset(new Slot[capacity]);
+    this->capacity_ = capacity;
+    this->policy_ = policy;
+    this->head_ = this->tail_ = 0;
+    this->num_pushed_ = this->num_dropped_ = 0;
+    return true;
+  }
+
+  /**
+   * \brief Pushes (copies) an item onto the ring (producer only).  If the
+   * ring is full, items are dropped according to the overflow policy.
+   *
+   * \param item item to push
+   */
+  void push(const T & item)
+  {
+    unsigned long head = this->head_.load(boost::memory_order_relaxed);
+    unsigned long tail = this->tail_.load(boost::memory_order_acquire);
+
+    while (head - tail >= this->capacity_)
+    {
+      unsigned long newTail = (OverflowPolicies::LATEST_VALUE == this->policy_) ? head : tail + 1;
+      // Fails (and reloads tail) if the consumer popped an item meanwhile
+      if (this->tail_.compare_exchange_weak(tail, newTail, boost::memory_order_acq_rel,
+                                            boost::memory_order_acquire))
+      {
+        this->num_dropped_.fetch_add(newTail - tail, boost::memory_order_relaxed);
+        break;
+      }
+    }
+
+    // An odd sequence marks the slot as being written
+    Slot & slot = this->slots_[head % this->capacity_];
+    unsigned int seq = slot.seq.load(boost::memory_order_relaxed);
+    slot.seq.store(seq + 1, boost::memory_order_relaxed);
+    boost::atomic_thread_fence(boost::memory_order_release);
+    slot.item = item;
+    slot.seq.store(seq + 2, boost::memory_order_release);
+
+    this->head_.store(head + 1, boost::memory_order_release);
+    this->num_pushed_.fetch_add(1, boost::memory_order_relaxed);
+  }
+
+  /**
+   * \brief Pops (copies) the oldest item from the ring (consumer only)
+   *
+   * \param item popped item
+   *
+   * \return true if an item was popped, false if the ring is empty
+   */
+  bool pop(T & item)
+  {
+    unsigned long tail = this->tail_.load(boost::memory_order_acquire);
+
+    while (tail != this->head_.load(boost::memory_order_acquire))
+    {
+      Slot & slot = this->slots_[tail % this->capacity_];
+      unsigned int seq = slot.seq.load(boost::memory_order_acquire);
+
+      if (0 == (seq & 1))
+      {
+        item = slot.item;
+        boost::atomic_thread_fence(boost::memory_order_acquire);
+        // The copy is only valid if the slot was not rewritten and the item
+        // was not dropped meanwhile (a failed exchange reloads tail)
+        if ((seq == slot.seq.load(boost::memory_order_relaxed))
+            && this->tail_.compare_exchange_strong(tail, tail + 1, boost::memory_order_acq_rel,
+                                                   boost::memory_order_acquire))
+        {
+          return true;
+        }
+      }
+      else
+      {
+        // The producer is rewriting the slot, so the item was dropped
+        tail = this->tail_.load(boost::memory_order_acquire);
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * \brief returns true if the ring is empty
+   *
+   * \return true if empty
+   */
+  bool isEmpty() const
+  {
+    return this->getSize() == 0;
+  }
+
+  /**
+   * \brief returns the number of queued items
+   *
+   * \return number of queued items
+   */
+  unsigned int getSize() const
+  {
+    unsigned long tail = this->tail_.load(boost::memory_order_acquire);
+    return (unsigned int)(this->head_.load(boost::memory_order_acquire) - tail);
+  }
+
+  /**
+   * \brief returns the maximum number of queued items (see init)
+   *
+   * \return capacity
+   */
+  unsigned int getCapacity() const
+  {
+    return this->capacity_;
+  }
+
+  /**
+   * \brief returns the number of items pushed since init
+   *
+   * \return number of pushed items
+   */
+  unsigned long getNumPushed() const
+  {
+    return this->num_pushed_.load(boost::memory_order_relaxed);
+  }
+
+  /**
+   * \brief returns the number of items dropped (on overflow) since init
+   *
+   * \return number of dropped items
+   */
+  unsigned long getNumDropped() const
+  {
+    return this->num_dropped_.load(boost::memory_order_relaxed);
+  }
+
+private:
+
+  /**
+   * \brief ring slot, the sequence is odd while the item is being written
+   */
+  struct Slot
+  {
+    Slot() : seq(0) {}
+    boost::atomic<unsigned int> seq;
+    T item;
+  };
+
+  boost::scoped_array<Slot> slots_;
+  unsigned int capacity_;
+  OverflowPolicy policy_;
+
+  /**
+   * \brief position of the next item pushed (only written by the producer)
+   */
+  boost::atomic<unsigned long> head_;
+
+  /**
+   * \brief position of the oldest item (advanced by the consumer, or by the
+   * producer when dropping items)
+   */
+  boost::atomic<unsigned long> tail_;
+
+  boost::atomic<unsigned long> num_pushed_;
+  boost::atomic<unsigned long> num_dropped_;
+};
+
+} //spsc_ring
+} //industrial_robot_client
+
+#endif /* SPSC_RING_H */
@@ -32,6 +32,7 @@
 #ifndef INDUSTRIAL_ROBOT_CLIENT_UTILS_H_
 #define INDUSTRIAL_ROBOT_CLIENT_UTILS_H_
 
+#include <cstddef>
 #include <vector>
 #include <string>
 #include <map>
@@ -116,6 +117,19 @@ bool isWithinRange(const std::vector<std::string> & lhs_keys, const std::vector<
                    const std::vector<std::string> & rhs_keys, const std::vector<double> & rhs_values,
                    double full_range);
 
+/**
+ * \brief Computes the largest velocity ratio, abs(velocities[i] / limits[i]),
+ * of a set of joints.  Vectorized (SSE2) where supported.
+ *
+ * \param velocities joint velocities
+ * \param limits joint velocity limits (positive), joints with an infinite limit
+ * (unlimited) have a ratio of 0
+ * \param size number of joints
+ *
+ * \return largest velocity ratio, or 0 if none is positive
+ */
+double maxVelocityRatio(const double* velocities, const double* limits, size_t size);
+
 } //utils
 } //industrial_robot_client
 
@@ -43,6 +43,81 @@ namespace industrial_robot_client
 namespace joint_relay_handler
 {
 
+JointRelayHandler::JointRelayHandler() :
+    publish_queued_(false), publish_thread_(NULL), publish_idle_(false), publish_stop_(false),
+    num_published_(0)
+{
+}
+
+JointRelayHandler::~JointRelayHandler()
+{
+  this->stopPublishThread();
+}
+
+bool JointRelayHandler::setPublishQueue(unsigned int size, OverflowPolicy policy)
+{
+  this->stopPublishThread();
+  this->publish_queued_ = false;
+
+  if (0 == size)
+  {
+    return true;
+  }
+
+  if (!this->publish_queue_.init(size, policy))
+  {
+    LOG_ERROR("Failed to initialize publish queue, size: %u", size);
+    return false;
+  }
+
+  this->publish_stop_ = false;
+  this->publish_thread_ = new boost::thread(boost::bind(&JointRelayHandler::publishThread, this));
+  this->publish_queued_ = true;
+  return true;
+}
+
+void JointRelayHandler::stopPublishThread()
+{
+  if (NULL == this->publish_thread_)
+  {
+    return;
+  }
+
+  {
+    boost::lock_guard<boost::mutex> lock(this->publish_mutex_);
+    this->publish_stop_ = true;
+    this->publish_cond_.notify_one();
+  }
+  this->publish_thread_->join();
+  delete this->publish_thread_;
+  this->publish_thread_ = NULL;
+}
+
+void JointRelayHandler::publishThread()
+{
+  JointSample sample;
+
+  while (!this->publish_stop_)
+  {
+    while (this->publish_queue_.pop(sample))
+    {
+      this->publish(sample.msg, sample.stamp);
+    }
+
+    // The receiving thread only takes the lock (to notify) while this thread
+    // is idle, the fences order the idle flag and the queue check against
+    // the queue push and the idle check (see internalCB)
+    boost::unique_lock<boost::mutex> lock(this->publish_mutex_);
+    this->publish_idle_ = true;
+    boost::atomic_thread_fence(boost::memory_order_seq_cst);
+    while (this->publish_queue_.isEmpty() && !this->publish_stop_)
+    {
+      this->publish_cond_.wait(lock);
+    }
+    this->publish_idle_ = false;
+  }
+}
+
 bool JointRelayHandler::init(SmplMsgConnection* connection, std::vector<std::string>& joint_names)
 {
   this->pub_joint_control_state_ =
@@ -53,6 +128,18 @@ bool JointRelayHandler::init(SmplMsgConnection* connection, std::vector<std::str
   // save "complete" joint-name list, preserving any blank entries for later use
   this->all_joint_names_ = joint_names;
 
+  // resolve the joints to publish once (see select_joints)
+  std::vector<int> pub_joint_indices;
+  std::vector<std::string> pub_joint_names;
+  if (!select_joints(all_joint_names_, &pub_joint_indices, &pub_joint_names))
+  {
+    LOG_ERROR("Failed to select joints for publishing");
+    return false;
+  }
+
+  if (!this->converter_.init(all_joint_names_.size(), pub_joint_names, pub_joint_indices))
+    return false;
+
   return init((int)StandardMsgTypes::JOINT, connection);
 }
 
@@ -71,17 +158,24 @@ bool JointRelayHandler::internalCB(SimpleMessage& in)
 
 bool JointRelayHandler::internalCB(JointMessage& in)
 {
-  control_msgs::FollowJointTrajectoryFeedback control_state;
-  sensor_msgs::JointState sensor_state;
   bool rtn = true;
 
-  if (create_messages(in, &control_state, &sensor_state))
+  if (this->publish_queued_)
   {
-    this->pub_joint_control_state_.publish(control_state);
-    this->pub_joint_sensor_state_.publish(sensor_state);
+    JointSample sample;
+    sample.msg = in;
+    sample.stamp = ros::Time::now();
+    this->publish_queue_.push(sample);
+
+    boost::atomic_thread_fence(boost::memory_order_seq_cst);
+    if (this->publish_idle_)
+    {
+      boost::lock_guard<boost::mutex> lock(this->publish_mutex_);
+      this->publish_cond_.notify_one();
+    }
   }
   else
-    rtn = false;
+    rtn = publish(in, ros::Time::now());
 
   // Reply back to the controller if the sender requested it.
   if (CommTypes::SERVICE_REQUEST == in.getMessageType())
@@ -94,53 +188,36 @@ bool JointRelayHandler::internalCB(JointMessage& in)
   return rtn;
 }
 
+bool JointRelayHandler::publish(JointMessage& in, const ros::Time& stamp)
+{
+  this->stamp_ = stamp;
+  if (!create_messages(in, &this->control_state_, &this->sensor_state_))
+    return false;
+
+  this->pub_joint_control_state_.publish(this->control_state_);
+  this->pub_joint_sensor_state_.publish(this->sensor_state_);
+  this->num_published_.fetch_add(1, boost::memory_order_relaxed);
+  return true;
+}
+
 // TODO: Add support for other message fields (velocity, effort, desired pos)
 bool JointRelayHandler::create_messages(JointMessage& msg_in,
                                         control_msgs::FollowJointTrajectoryFeedback* control_state,
                                         sensor_msgs::JointState* sensor_state)
 {
   // read joint positions from JointMessage
-  std::vector<double> all_joint_pos(all_joint_names_.size());
-  for (int i=0; i<all_joint_names_.size(); ++i)
-  {
-    shared_real value;
-    if (msg_in.getJoints().getJoint(i, value))
-      all_joint_pos[i] = value;
-    else
-      LOG_ERROR("Failed to parse #%d value from JointMessage", i);
-  }
+  if (!this->converter_.getPositions(msg_in, &this->all_joint_pos_))
+    return false;
 
   // apply transform to joint positions, if required
-  std::vector<double> xform_joint_pos;
-  if (!transform(all_joint_pos, &xform_joint_pos))
+  if (!transform(this->all_joint_pos_, &this->xform_joint_pos_))
   {
     LOG_ERROR("Failed to transform joint positions");
     return false;
   }
 
-  // select specific joints for publishing
-  std::vector<double> pub_joint_pos;
-  std::vector<std::string> pub_joint_names;
-  if (!select(xform_joint_pos, all_joint_names_, &pub_joint_pos, &pub_joint_names))
-  {
-    LOG_ERROR("Failed to select joints for publishing");
-    return false;
-  }
-
-  // assign values to messages
-  control_msgs::FollowJointTrajectoryFeedback tmp_control_state;  // always start with a "clean" message
-  tmp_control_state.header.stamp = ros::Time::now();
-  tmp_control_state.joint_names = pub_joint_names;
-  tmp_control_state.actual.positions = pub_joint_pos;
-  *control_state = tmp_control_state;
-
-  sensor_msgs::JointState tmp_sensor_state;
-  tmp_sensor_state.header.stamp = ros::Time::now();
-  tmp_sensor_state.name = pub_joint_names;
-  tmp_sensor_state.position = pub_joint_pos;
-  *sensor_state = tmp_sensor_state;
-
-  return true;
+  // assign selected joints to messages
+  return this->converter_.toMessages(this->xform_joint_pos_, this->stamp_, control_state, sensor_state);
 }
 
 bool JointRelayHandler::select(const std::vector<double>& all_joint_pos, const std::vector<std::string>& all_joint_names,
@@ -164,6 +241,99 @@ bool JointRelayHandler::select(const std::vector<double>& all_joint_pos, const s
   return true;
 }
 
+bool JointRelayHandler::select_joints(const std::vector<std::string>& all_joint_names,
+                                      std::vector<int>* pub_joint_indices, std::vector<std::string>* pub_joint_names)
+{
+  pub_joint_indices->clear();
+  pub_joint_names->clear();
+
+  // skip over "blank" joint names
+  for (int i=0; i<all_joint_names.size(); ++i)
+  {
+    if (all_joint_names[i].empty())
+      continue;
+
+    pub_joint_indices->push_back(i);
+    pub_joint_names->push_back(all_joint_names[i]);
+  }
+
+  return true;
+}
+
+bool JointMessageConverter::init(unsigned int num_joints, const std::vector<std::string>& pub_joint_names,
+                                 const std::vector<int>& pub_joint_indices)
+{
+  if (pub_joint_names.size() != pub_joint_indices.size())
+  {
+    LOG_ERROR("Joint name count (%d) does not match joint index count (%d)",
+              (int)pub_joint_names.size(), (int)pub_joint_indices.size());
+    return false;
+  }
+
+  for (int i=0; i<pub_joint_indices.size(); ++i)
+  {
+    if (pub_joint_indices[i] < 0 || pub_joint_indices[i] >= (int)num_joints)
+    {
+      LOG_ERROR("Joint index %d (%s) out of range", pub_joint_indices[i], pub_joint_names[i].c_str());
+      return false;
+    }
+  }
+
+  this->num_joints_ = num_joints;
+  this->pub_joint_names_ = pub_joint_names;
+  this->pub_joint_indices_ = pub_joint_indices;
+  return true;
+}
+
+bool JointMessageConverter::getPositions(JointMessage& msg_in, std::vector<double>* all_joint_pos)
+{
+  all_joint_pos->resize(this->num_joints_);
+  for (int i=0; i<this->num_joints_; ++i)
+  {
+    shared_real value;
+    if (msg_in.getJoints().getJoint(i, value))
+      (*all_joint_pos)[i] = value;
+    else
+      LOG_ERROR("Failed to parse #%d value from JointMessage", i);
+  }
+
+  return true;
+}
+
+bool JointMessageConverter::toMessages(const std::vector<double>& all_joint_pos, const ros::Time& stamp,
+                                       control_msgs::FollowJointTrajectoryFeedback* control_state,
+                                       sensor_msgs::JointState* sensor_state)
+{
+  if (all_joint_pos.size() != this->num_joints_)
+  {
+    LOG_ERROR("Joint position count (%d) does not match joint count (%d)",
+              (int)all_joint_pos.size(), this->num_joints_);
+    return false;
+  }
+
+  int num_pub = this->pub_joint_indices_.size();
+
+  // names are only copied when they differ (typically, the first message only)
+  control_state->header.stamp = stamp;
+  if (control_state->joint_names != this->pub_joint_names_)
+    control_state->joint_names = this->pub_joint_names_;
+  control_state->actual.positions.resize(num_pub);
+
+  sensor_state->header.stamp = stamp;
+  if (sensor_state->name != this->pub_joint_names_)
+    sensor_state->name = this->pub_joint_names_;
+  sensor_state->position.resize(num_pub);
+
+  for (int i=0; i<num_pub; ++i)
+  {
+    double pos = all_joint_pos[this->pub_joint_indices_[i]];
+    control_state->actual.positions[i] = pos;
+    sensor_state->position[i] = pos;
+  }
+
+  return true;
+}
+
 }//namespace joint_relay_handler
 }//namespace industrial_robot_client
 
@@ -30,6 +30,8 @@
  */
 
 #include "industrial_robot_client/joint_trajectory_downloader.h"
+#include "simple_message/joint_traj_full.h"
+#include "simple_message/messages/joint_traj_full_message.h"
 
 namespace industrial_robot_client
 {
@@ -37,7 +39,111 @@ namespace joint_trajectory_downloader
 {
 
 using industrial::simple_message::SimpleMessage;
+using industrial::joint_data::JointData;
+using industrial::joint_traj_full::JointTrajFull;
+using industrial::joint_traj_full_message::JointTrajFullMessage;
 namespace SpecialSeqValues = industrial::joint_traj_pt::SpecialSeqValues;
+namespace ValidFieldTypes = industrial::joint_traj_pt_full::ValidFieldTypes;
+
+bool JointTrajectoryDownloader::init(SmplMsgConnection* connection, const std::vector<std::string> &joint_names,
+                                     const std::map<std::string, double> &velocity_limits)
+{
+  bool rtn = JointTrajectoryInterface::init(connection, joint_names, velocity_limits);
+
+  ros::param::param<bool>("~full_trajectory_download", this->full_download_, false);
+  if (this->full_download_)
+    ROS_INFO("Downloading complete trajectories (JOINT_TRAJ_FULL)");
+
+  bool batch_download;
+  ros::param::param<bool>("~batch_download", batch_download, false);
+  if (rtn && batch_download)
+    rtn = this->connection_->setBatching(SmplMsgConnection::MAX_BATCH_BYTES, BATCH_DELAY);
+
+  return rtn;
+}
+
+void JointTrajectoryDownloader::jointTrajectoryCB(const trajectory_msgs::JointTrajectoryConstPtr &msg)
+{
+  // STOP commands (and point downloads) are handled by the base class
+  if (!this->full_download_ || msg->points.empty())
+  {
+    JointTrajectoryInterface::jointTrajectoryCB(msg);
+    return;
+  }
+
+  ROS_INFO("Receiving joint trajectory message");
+
+  // convert trajectory into robot-format
+  std::vector<JointTrajPtFull> points;
+  if (!trajectory_to_msgs(msg, &points))
+    return;
+
+  // send command messages to robot
+  send_to_robot(points);
+}
+
+bool JointTrajectoryDownloader::trajectory_to_msgs(const trajectory_msgs::JointTrajectoryConstPtr& traj,
+                                                   std::vector<JointTrajPtFull>* points)
+{
+  points->clear();
+
+  // check for valid trajectory
+  if (!is_valid(*traj))
+    return false;
+
+  // resolve the joint map once, for all points
+  if (!update_joint_map(traj->joint_names, this->all_joint_names_))
+    return false;
+
+  points->reserve(traj->points.size());
+  for (size_t i=0; i<traj->points.size(); ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint rbt_pt, xform_pt;
+    JointData pos, vel, acc;
+    int valid_fields = ValidFieldTypes::TIME | ValidFieldTypes::POSITION;
+
+    // select / reorder joints for sending to robot
+    if (!select_point(traj->points[i], &rbt_pt))
+      return false;
+
+    // transform point data (e.g. for joint-coupling)
+    if (!transform(rbt_pt, &xform_pt))
+      return false;
+
+    if (this->compact_joint_data_)
+    {
+      pos.setNumJoints(xform_pt.positions.size());
+      vel.setNumJoints(xform_pt.positions.size());
+      acc.setNumJoints(xform_pt.positions.size());
+    }
+    ROS_ASSERT(xform_pt.positions.size() <= (unsigned int)pos.getMaxNumJoints());
+    pos.init();
+    vel.init();
+    acc.init();
+    for (size_t j=0; j<xform_pt.positions.size(); ++j)
+      pos.setJoint(j, xform_pt.positions[j]);
+
+    if (xform_pt.velocities.size() == xform_pt.positions.size())
+    {
+      for (size_t j=0; j<xform_pt.velocities.size(); ++j)
+        vel.setJoint(j, xform_pt.velocities[j]);
+      valid_fields |= ValidFieldTypes::VELOCITY;
+    }
+
+    if (xform_pt.accelerations.size() == xform_pt.positions.size())
+    {
+      for (size_t j=0; j<xform_pt.accelerations.size(); ++j)
+        acc.setJoint(j, xform_pt.accelerations[j]);
+      valid_fields |= ValidFieldTypes::ACCELERATION;
+    }
+
+    JointTrajPtFull pt;
+    pt.init(0, i, valid_fields, xform_pt.time_from_start.toSec(), pos, vel, acc);
+    points->push_back(pt);
+  }
+
+  return true;
+}
 
 bool JointTrajectoryDownloader::send_to_robot(const std::vector<JointTrajPtMessage>& messages)
 {
@@ -66,7 +172,7 @@ bool JointTrajectoryDownloader::send_to_robot(const std::vector<JointTrajPtMessa
     ROS_DEBUG("Sending joints trajectory point[%d]", i);
 
     points[i].toTopic(msg);
-    bool ptRslt = this->connection_->sendMsg(msg);
+    bool ptRslt = this->connection_->queueMsg(msg);
     if (ptRslt)
       ROS_DEBUG("Point[%d] sent to controller", i);
     else
@@ -75,6 +181,65 @@ bool JointTrajectoryDownloader::send_to_robot(const std::vector<JointTrajPtMessa
     rslt &= ptRslt;
   }
 
+  if (!this->connection_->flush())
+  {
+    ROS_WARN("Failed to send queued joint points");
+    rslt = false;
+  }
+
+  return rslt;
+}
+
+bool JointTrajectoryDownloader::send_to_robot(const std::vector<JointTrajPtFull>& trajectory)
+{
+  bool rslt=true;
+  std::vector<JointTrajPtFull> points(trajectory);
+  JointTrajFullMessage traj_msg;
+  SimpleMessage msg;
+
+  // Trajectory download requires at least two points (START/END)
+  if (points.size() < 2)
+    points.push_back(JointTrajPtFull(points[0]));
+
+  // The first and last points are assigned special sequence values
+  points.begin()->setSequence(SpecialSeqValues::START_TRAJECTORY_DOWNLOAD);
+  points.back().setSequence(SpecialSeqValues::END_TRAJECTORY);
+
+  if (!this->connection_->isConnected())
+  {
+    ROS_WARN("Attempting robot reconnection");
+    this->connection_->makeConnect();
+  }
+
+  ROS_INFO("Sending trajectory points, size: %d", (int)points.size());
+
+  // Each message holds as many points as will fit, a trajectory of N points
+  // is sent with (N / max points) messages
+  int max_points = traj_msg.traj_.getMaxNumPoints();
+  for (int i = 0; i < (int)points.size(); i += max_points)
+  {
+    traj_msg.traj_.init();
+    for (int j = i; j < (int)points.size() && !traj_msg.traj_.isFull(); ++j)
+      traj_msg.traj_.addPoint(points[j]);
+
+    ROS_DEBUG("Sending joints trajectory points[%d-%d]", i, i + traj_msg.traj_.size() - 1);
+
+    traj_msg.toTopic(msg);
+    bool msgRslt = this->connection_->queueMsg(msg);
+    if (msgRslt)
+      ROS_DEBUG("Points[%d-%d] sent to controller", i, i + traj_msg.traj_.size() - 1);
+    else
+      ROS_WARN("Failed sent joint trajectory, skipping points");
+
+    rslt &= msgRslt;
+  }
+
+  if (!this->connection_->flush())
+  {
+    ROS_WARN("Failed to send queued joint trajectories");
+    rslt = false;
+  }
+
   return rslt;
 }
 
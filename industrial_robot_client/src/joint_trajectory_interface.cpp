@@ -30,12 +30,20 @@
  */
 
 #include <algorithm>
+#include <limits>
+#include <boost/bind/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/thread.hpp>
 #include "industrial_robot_client/joint_trajectory_interface.h"
+#include "industrial_robot_client/utils.h"
 #include "simple_message/joint_traj_pt.h"
 #include "industrial_utils/param_utils.h"
 
 using namespace industrial_utils::param;
 using industrial::simple_message::SimpleMessage;
+using boost::placeholders::_1;
+using boost::placeholders::_2;
 namespace StandardSocketPorts = industrial::simple_socket::StandardSocketPorts;
 namespace SpecialSeqValues = industrial::joint_traj_pt::SpecialSeqValues;
 typedef industrial::joint_traj_pt::JointTrajPt rbt_JointTrajPt;
@@ -48,14 +56,87 @@ namespace joint_trajectory_interface
 
 #define ROS_ERROR_RETURN(rtn,...) do {ROS_ERROR(__VA_ARGS__); return(rtn);} while(0)
 
+typedef boost::function<bool (size_t, size_t)> RangeFunction;
+
+static void run_range(const RangeFunction& func, size_t begin, size_t end, char* result)
+{
+  *result = func(begin, end);
+}
+
+// runs func over [0, size), split into (at most) num_threads contiguous ranges.  The
+// calling thread runs the first range.
+static bool parallel_for(size_t size, unsigned int num_threads, const RangeFunction& func)
+{
+  if (num_threads <= 1)
+    return func(0, size);
+
+  size_t range = (size + num_threads - 1) / num_threads;
+  std::vector<char> results(num_threads, true);
+  boost::thread_group threads;
+  for (unsigned int i=1; i<num_threads; ++i)
+  {
+    size_t begin = std::min(size, i * range);
+    size_t end = std::min(size, begin + range);
+    threads.create_thread(boost::bind(&run_range, boost::cref(func), begin, end, &results[i]));
+  }
+  results[0] = func(0, std::min(size, range));
+  threads.join_all();
+
+  return std::find(results.begin(), results.end(), false) == results.end();
+}
+
+// hashes the trajectory content (joint names and point data), see trajectory_to_msgs
+static size_t hash_trajectory(const trajectory_msgs::JointTrajectory& traj)
+{
+  size_t seed = 0;
+  boost::hash_range(seed, traj.joint_names.begin(), traj.joint_names.end());
+
+  for (size_t i=0; i<traj.points.size(); ++i)
+  {
+    const ros_JointTrajPt& pt = traj.points[i];
+    boost::hash_combine(seed, pt.positions.size());
+    boost::hash_range(seed, pt.positions.begin(), pt.positions.end());
+    boost::hash_combine(seed, pt.velocities.size());
+    boost::hash_range(seed, pt.velocities.begin(), pt.velocities.end());
+    boost::hash_combine(seed, pt.accelerations.size());
+    boost::hash_range(seed, pt.accelerations.begin(), pt.accelerations.end());
+    boost::hash_combine(seed, pt.effort.size());
+    boost::hash_range(seed, pt.effort.begin(), pt.effort.end());
+    boost::hash_combine(seed, pt.time_from_start.toSec());
+  }
+
+  return seed;
+}
+
+// compares the trajectory content (joint names and point data), see trajectory_to_msgs
+static bool is_equal(const trajectory_msgs::JointTrajectory& traj1, const trajectory_msgs::JointTrajectory& traj2)
+{
+  if ((traj1.joint_names != traj2.joint_names) || (traj1.points.size() != traj2.points.size()))
+    return false;
+
+  for (size_t i=0; i<traj1.points.size(); ++i)
+  {
+    const ros_JointTrajPt& pt1 = traj1.points[i];
+    const ros_JointTrajPt& pt2 = traj2.points[i];
+    if ((pt1.positions != pt2.positions) || (pt1.velocities != pt2.velocities) ||
+        (pt1.accelerations != pt2.accelerations) || (pt1.effort != pt2.effort) ||
+        (pt1.time_from_start != pt2.time_from_start))
+      return false;
+  }
+
+  return true;
+}
+
 bool JointTrajectoryInterface::init(std::string default_ip, int default_port)
 {
   std::string ip;
   int port;
+  bool byte_swapping;
 
   // override IP/port with ROS params, if available
   ros::param::param<std::string>("robot_ip_address", ip, default_ip);
   ros::param::param<int>("~port", port, default_port);
+  ros::param::param<bool>("~byte_swapping", byte_swapping, false);
 
   // check for valid parameter values
   if (ip.empty())
@@ -74,6 +155,12 @@ bool JointTrajectoryInterface::init(std::string default_ip, int default_port)
   default_tcp_connection_.init(ip_addr, port);
   free(ip_addr);
 
+  if (byte_swapping && !default_tcp_connection_.setByteSwapping(true))
+  {
+    ROS_ERROR("Byte swapping not supported by this build.  Please clear ROS '~byte_swapping' param");
+    return false;
+  }
+
   return init(&default_tcp_connection_);
 }
 
@@ -97,9 +184,20 @@ bool JointTrajectoryInterface::init(SmplMsgConnection* connection, const std::ve
   this->joint_vel_limits_ = velocity_limits;
   connection_->makeConnect();
 
+  ros::param::param<bool>("~compact_joint_data", this->compact_joint_data_, false);
+  ros::param::param<int>("~conversion_threads", this->conversion_threads_, 1);
+  ros::param::param<int>("~conversion_cache_size", this->conversion_cache_size_, 0);
+  if (this->compact_joint_data_ && (int)joint_names.size() > industrial::joint_data::JointData::getJointCapacity())
+  {
+    ROS_ERROR("Number of joints: %d, is greater than max: %d", (int)joint_names.size(),
+              industrial::joint_data::JointData::getJointCapacity());
+    return false;
+  }
+
   // try to read velocity limits from URDF, if none specified
   if (joint_vel_limits_.empty() && !industrial_utils::param::getJointVelocityLimits("robot_description", joint_vel_limits_))
     ROS_WARN("Unable to read velocity limits from 'robot_description' param.  Velocity validation disabled.");
+  update_vel_limits();
 
   this->srv_stop_motion_ = this->node_.advertiseService("stop_motion", &JointTrajectoryInterface::stopMotionCB, this);
   this->srv_joint_trajectory_ = this->node_.advertiseService("joint_path_command", &JointTrajectoryInterface::jointTrajectoryCB, this);
@@ -157,70 +255,212 @@ bool JointTrajectoryInterface::trajectory_to_msgs(const trajectory_msgs::JointTr
   if (!is_valid(*traj))
     return false;
 
-  for (size_t i=0; i<traj->points.size(); ++i)
+  // reuse the messages of an identical (previously converted) trajectory.  Only new
+  // trajectories are cached, the first point duration of a continued trajectory
+  // depends on the previous trajectory (see calc_duration).
+  size_t hash = 0;
+  bool cached = (this->conversion_cache_size_ > 0) && !traj->points.empty() &&
+                (traj->points[0].time_from_start.toSec() <= last_point_time_);
+  if (cached)
   {
-    ros_JointTrajPt rbt_pt, xform_pt;
-    double vel, duration;
+    hash = hash_trajectory(*traj);
+    if (find_cached_msgs(*traj, hash, msgs))
+    {
+      last_point_time_ = traj->points.back().time_from_start.toSec();  // as calc_duration would
+      ROS_DEBUG("Using cached conversion of %d point trajectory", (int)msgs->size());
+      return true;
+    }
+  }
 
-    // select / reorder joints for sending to robot
-    if (!select(traj->joint_names, traj->points[i], this->all_joint_names_, &rbt_pt))
-      return false;
+  // resolve the joint map up front, so that it is only read while converting points
+  if (!update_joint_map(traj->joint_names, this->all_joint_names_))
+    return false;
 
-    // transform point data (e.g. for joint-coupling)
-    if (!transform(rbt_pt, &xform_pt))
+  size_t num_points = traj->points.size();
+  unsigned int num_threads = 1;
+  if (num_points >= MIN_PARALLEL_POINTS)
+    num_threads = (this->conversion_threads_ > 0) ? this->conversion_threads_ : boost::thread::hardware_concurrency();
+
+  // select / reorder joints for sending to robot, and transform point data (e.g. for joint-coupling)
+  std::vector<ros_JointTrajPt> xform_pts(num_points);
+  if (!parallel_for(num_points, num_threads,
+                    boost::bind(&JointTrajectoryInterface::transform_points, this, boost::cref(*traj), _1, _2, &xform_pts)))
+    return false;
+
+  // reduce velocity to a single scalar, for robot command (in order, durations are relative
+  // to the previous point)
+  std::vector<double> velocities(num_points), durations(num_points);
+  for (size_t i=0; i<num_points; ++i)
+  {
+    if (!calc_speed(xform_pts[i], &velocities[i], &durations[i]))
       return false;
+  }
 
-    // reduce velocity to a single scalar, for robot command
-    if (!calc_speed(xform_pt, &vel, &duration))
+  msgs->resize(num_points);
+  if (!parallel_for(num_points, num_threads,
+                    boost::bind(&JointTrajectoryInterface::create_messages, this, boost::cref(xform_pts),
+                                boost::cref(velocities), boost::cref(durations), _1, _2, msgs)))
+    return false;
+
+  if (cached)
+    cache_msgs(traj, hash, *msgs);
+
+  return true;
+}
+
+bool JointTrajectoryInterface::find_cached_msgs(const trajectory_msgs::JointTrajectory& traj, size_t hash,
+                                                std::vector<JointTrajPtMessage>* msgs)
+{
+  for (std::list<ConversionCacheEntry>::iterator it = conversion_cache_.begin(); it != conversion_cache_.end(); ++it)
+  {
+    if ((it->hash != hash) || !is_equal(*it->traj, traj))
+      continue;
+
+    conversion_cache_.splice(conversion_cache_.begin(), conversion_cache_, it);  // most recently used
+    *msgs = it->msgs;
+    return true;
+  }
+
+  return false;
+}
+
+void JointTrajectoryInterface::cache_msgs(const trajectory_msgs::JointTrajectoryConstPtr& traj, size_t hash,
+                                          const std::vector<JointTrajPtMessage>& msgs)
+{
+  while (!conversion_cache_.empty() && (conversion_cache_.size() >= (size_t)conversion_cache_size_))
+    conversion_cache_.pop_back();  // least recently used
+
+  conversion_cache_.push_front(ConversionCacheEntry());
+  ConversionCacheEntry& entry = conversion_cache_.front();
+  entry.hash = hash;
+  entry.traj = traj;
+  entry.msgs = msgs;
+}
+
+bool JointTrajectoryInterface::transform_points(const trajectory_msgs::JointTrajectory& traj, size_t begin, size_t end,
+                                                std::vector<ros_JointTrajPt>* xform_pts)
+{
+  ros_JointTrajPt rbt_pt;
+
+  for (size_t i=begin; i<end; ++i)
+  {
+    // the joint map was resolved by trajectory_to_msgs
+    if (!select_point(traj.points[i], &rbt_pt))
       return false;
 
-    JointTrajPtMessage msg = create_message(i, xform_pt.positions, vel, duration);
-    msgs->push_back(msg);
+    if (!transform(rbt_pt, &(*xform_pts)[i]))
+      return false;
   }
 
   return true;
 }
 
+bool JointTrajectoryInterface::create_messages(const std::vector<ros_JointTrajPt>& xform_pts,
+                                               const std::vector<double>& velocities, const std::vector<double>& durations,
+                                               size_t begin, size_t end, std::vector<JointTrajPtMessage>* msgs)
+{
+  for (size_t i=begin; i<end; ++i)
+    (*msgs)[i] = create_message(i, xform_pts[i].positions, velocities[i], durations[i]);
+
+  return true;
+}
+
+// gathers ROS point data (one value per ROS joint) into robot joint order.  Data
+// left unspecified in the ROS command (empty) remains unspecified.
+static void gather(const std::vector<double>& ros_data, const std::vector<int>& joint_map,
+                   double default_value, std::vector<double>* rbt_data)
+{
+  if (ros_data.empty())
+  {
+    rbt_data->clear();
+    return;
+  }
+
+  rbt_data->resize(joint_map.size());
+  for (size_t rbt_idx=0; rbt_idx < joint_map.size(); ++rbt_idx)
+  {
+    int ros_idx = joint_map[rbt_idx];
+    (*rbt_data)[rbt_idx] = (ros_idx < 0) ? default_value : ros_data[ros_idx];
+  }
+}
+
 bool JointTrajectoryInterface::select(const std::vector<std::string>& ros_joint_names, const ros_JointTrajPt& ros_pt,
                       const std::vector<std::string>& rbt_joint_names, ros_JointTrajPt* rbt_pt)
 {
   ROS_ASSERT(ros_joint_names.size() == ros_pt.positions.size());
 
-  // initialize rbt_pt
-  *rbt_pt = ros_pt;
-  rbt_pt->positions.clear(); rbt_pt->velocities.clear(); rbt_pt->accelerations.clear();
+  if (!update_joint_map(ros_joint_names, rbt_joint_names))
+    return false;
+
+  return select_point(ros_pt, rbt_pt);
+}
+
+bool JointTrajectoryInterface::select_point(const ros_JointTrajPt& ros_pt, ros_JointTrajPt* rbt_pt)
+{
+  ROS_ASSERT(joint_map_ros_names_.size() == ros_pt.positions.size());
+
+  rbt_pt->time_from_start = ros_pt.time_from_start;
+  rbt_pt->effort = ros_pt.effort;
+  gather(ros_pt.positions, joint_map_, default_joint_pos_, &rbt_pt->positions);
+  gather(ros_pt.velocities, joint_map_, -1, &rbt_pt->velocities);
+  gather(ros_pt.accelerations, joint_map_, -1, &rbt_pt->accelerations);
+
+  return true;
+}
+
+bool JointTrajectoryInterface::update_joint_map(const std::vector<std::string>& ros_joint_names,
+                                                const std::vector<std::string>& rbt_joint_names)
+{
+  // joint-name layout unchanged => joint map still valid
+  if ((joint_map_.size() == rbt_joint_names.size()) &&
+      (joint_map_ros_names_ == ros_joint_names) && (joint_map_rbt_names_ == rbt_joint_names))
+    return true;
 
+  joint_map_.clear();
+  joint_map_ros_names_.clear();
+  joint_map_rbt_names_.clear();
+
+  std::vector<int> joint_map(rbt_joint_names.size(), -1);
   for (size_t rbt_idx=0; rbt_idx < rbt_joint_names.size(); ++rbt_idx)
   {
-    bool is_empty = rbt_joint_names[rbt_idx].empty();
+    if (rbt_joint_names[rbt_idx].empty())  // "dummy joint", use default values
+      continue;
 
     // find matching ROS element
     size_t ros_idx = std::find(ros_joint_names.begin(), ros_joint_names.end(), rbt_joint_names[rbt_idx]) - ros_joint_names.begin();
-    bool is_found = ros_idx < ros_joint_names.size();
 
     // error-chk: required robot joint not found in ROS joint-list
-    if (!is_empty && !is_found)
+    if (ros_idx >= ros_joint_names.size())
     {
       ROS_ERROR("Expected joint (%s) not found in JointTrajectory.  Aborting command.", rbt_joint_names[rbt_idx].c_str());
       return false;
     }
 
-    if (is_empty)
-    {
-      if (!ros_pt.positions.empty()) rbt_pt->positions.push_back(default_joint_pos_);
-      if (!ros_pt.velocities.empty()) rbt_pt->velocities.push_back(-1);
-      if (!ros_pt.accelerations.empty()) rbt_pt->accelerations.push_back(-1);
-    }
-    else
-    {
-      if (!ros_pt.positions.empty()) rbt_pt->positions.push_back(ros_pt.positions[ros_idx]);
-      if (!ros_pt.velocities.empty()) rbt_pt->velocities.push_back(ros_pt.velocities[ros_idx]);
-      if (!ros_pt.accelerations.empty()) rbt_pt->accelerations.push_back(ros_pt.accelerations[ros_idx]);
-    }
+    joint_map[rbt_idx] = ros_idx;
   }
+
+  joint_map_.swap(joint_map);
+  joint_map_ros_names_ = ros_joint_names;
+  joint_map_rbt_names_ = rbt_joint_names;
   return true;
 }
 
+void JointTrajectoryInterface::update_vel_limits()
+{
+  conversion_cache_.clear();  // cached conversions may depend on the limits
+  all_joint_vel_limits_.assign(all_joint_names_.size(), std::numeric_limits<double>::infinity());
+
+  for (size_t i=0; i<all_joint_names_.size(); ++i)
+  {
+    const std::string &jnt_name = all_joint_names_[i];
+    std::map<std::string, double>::const_iterator max_vel = joint_vel_limits_.find(jnt_name);
+
+    // "dummy joints", and joints without a velocity limit, are left unlimited
+    if (!jnt_name.empty() && (max_vel != joint_vel_limits_.end()))
+      all_joint_vel_limits_[i] = max_vel->second;
+  }
+}
+
 bool JointTrajectoryInterface::calc_speed(const trajectory_msgs::JointTrajectoryPoint& pt, double* rbt_velocity, double* rbt_duration)
 {
 	return calc_velocity(pt, rbt_velocity) && calc_duration(pt, rbt_duration);
@@ -234,8 +474,6 @@ bool JointTrajectoryInterface::calc_speed(const trajectory_msgs::JointTrajectory
 // Behavior should be verified on a physical robot if movement velocity is critical.
 bool JointTrajectoryInterface::calc_velocity(const trajectory_msgs::JointTrajectoryPoint& pt, double* rbt_velocity)
 {
-  std::vector<double> vel_ratios;
-
   ROS_ASSERT(all_joint_names_.size() == pt.positions.size());
 
   // check for empty velocities in ROS topic
@@ -246,24 +484,19 @@ bool JointTrajectoryInterface::calc_velocity(const trajectory_msgs::JointTraject
     return true;
   }
 
-  for (size_t i=0; i<all_joint_names_.size(); ++i)
-  {
-    const std::string &jnt_name = all_joint_names_[i];
+  if (all_joint_vel_limits_.size() != all_joint_names_.size())
+    update_vel_limits();
+  ROS_ASSERT(all_joint_vel_limits_.size() <= pt.velocities.size());
 
-    // update vel_ratios
-    if (jnt_name.empty())                             // ignore "dummy joints" in velocity calcs
-      vel_ratios.push_back(-1);
-    else if (joint_vel_limits_.count(jnt_name) == 0)  // no velocity limit specified for this joint
-      vel_ratios.push_back(-1);
-    else
-      vel_ratios.push_back( fabs(pt.velocities[i] / joint_vel_limits_[jnt_name]) );  // calculate expected duration for this joint
-  }
+  // find largest velocity-ratio (closest to max joint-speed).  "dummy joints", and
+  // joints without a velocity limit, are ignored (unlimited).
+  double max_ratio = 0;
+  if (!all_joint_vel_limits_.empty())
+    max_ratio = industrial_robot_client::utils::maxVelocityRatio(&pt.velocities[0], &all_joint_vel_limits_[0],
+                                                                 all_joint_vel_limits_.size());
 
-  // find largest velocity-ratio (closest to max joint-speed)
-  int max_idx = std::max_element(vel_ratios.begin(), vel_ratios.end()) - vel_ratios.begin();
-  
-  if (vel_ratios[max_idx] > 0)
-    *rbt_velocity = vel_ratios[max_idx];
+  if (max_ratio > 0)
+    *rbt_velocity = max_ratio;
   else
   {
     ROS_WARN_ONCE("Joint velocity-limits unspecified.  Using default velocity-ratio.");
@@ -281,16 +514,14 @@ bool JointTrajectoryInterface::calc_velocity(const trajectory_msgs::JointTraject
 
 bool JointTrajectoryInterface::calc_duration(const trajectory_msgs::JointTrajectoryPoint& pt, double* rbt_duration)
 {
-  std::vector<double> durations;
   double this_time = pt.time_from_start.toSec();
-  static double last_time = 0;
 
-  if (this_time <= last_time)  // earlier time => new trajectory.  Move slowly to first point.
+  if (this_time <= last_point_time_)  // earlier time => new trajectory.  Move slowly to first point.
     *rbt_duration = default_duration_;
   else
-    *rbt_duration = this_time - last_time;
+    *rbt_duration = this_time - last_point_time_;
 
-  last_time = this_time;
+  last_point_time_ = this_time;
 
   return true;
 }
@@ -298,6 +529,8 @@ bool JointTrajectoryInterface::calc_duration(const trajectory_msgs::JointTraject
 JointTrajPtMessage JointTrajectoryInterface::create_message(int seq, std::vector<double> joint_pos, double velocity, double duration)
 {
   industrial::joint_data::JointData pos;
+  if (this->compact_joint_data_)
+    pos.setNumJoints(joint_pos.size());
   ROS_ASSERT(joint_pos.size() <= (unsigned int)pos.getMaxNumJoints());
 
   for (size_t i=0; i<joint_pos.size(); ++i)
@@ -318,6 +551,8 @@ void JointTrajectoryInterface::trajectoryStop()
   SimpleMessage msg, reply;
 
   ROS_INFO("Joint trajectory handler: entering stopping state");
+  if (this->compact_joint_data_)
+    jMsg.point_.setNumJoints(this->all_joint_names_.size());
   jMsg.setSequence(SpecialSeqValues::STOP_TRAJECTORY);
   jMsg.toRequest(msg);
   ROS_DEBUG("Sending stop command");
@@ -337,6 +572,20 @@ bool JointTrajectoryInterface::stopMotionCB(industrial_msgs::StopMotion::Request
 
 bool JointTrajectoryInterface::is_valid(const trajectory_msgs::JointTrajectory &traj)
 {
+  if (all_joint_vel_limits_.size() != all_joint_names_.size())
+    update_vel_limits();
+
+  // velocity limits, in ROS joint order (joints not sent to the robot are not checked)
+  if (!update_joint_map(traj.joint_names, all_joint_names_))
+    return false;
+
+  std::vector<double> vel_limits(traj.joint_names.size(), std::numeric_limits<double>::infinity());
+  for (size_t rbt_idx=0; rbt_idx<joint_map_.size(); ++rbt_idx)
+  {
+    if (joint_map_[rbt_idx] >= 0)
+      vel_limits[joint_map_[rbt_idx]] = all_joint_vel_limits_[rbt_idx];
+  }
+
   for (int i=0; i<traj.points.size(); ++i)
   {
     const trajectory_msgs::JointTrajectoryPoint &pt = traj.points[i];
@@ -346,12 +595,9 @@ bool JointTrajectoryInterface::is_valid(const trajectory_msgs::JointTrajectory &
       ROS_ERROR_RETURN(false, "Validation failed: Missing position data for trajectory pt %d", i);
 
     // check for joint velocity limits
-    for (int j=0; j<pt.velocities.size(); ++j)
+    for (int j=0; j<pt.velocities.size() && j<vel_limits.size(); ++j)
     {
-      std::map<std::string, double>::iterator max_vel = joint_vel_limits_.find(traj.joint_names[j]);
-      if (max_vel == joint_vel_limits_.end()) continue;  // no velocity-checking if limit not defined
-
-      if (std::abs(pt.velocities[j]) > max_vel->second)
+      if (std::abs(pt.velocities[j]) > vel_limits[j])  // no velocity-checking if limit not defined (infinite)
         ROS_ERROR_RETURN(false, "Validation failed: Max velocity exceeded for trajectory pt %d, joint '%s'", i, traj.joint_names[j].c_str());
     }
 
@@ -32,12 +32,16 @@
 #include "industrial_robot_client/joint_trajectory_streamer.h"
 
 using industrial::simple_message::SimpleMessage;
+namespace StandardMsgTypes = industrial::simple_message::StandardMsgTypes;
+namespace ReplyTypes = industrial::simple_message::ReplyTypes;
 
 namespace industrial_robot_client
 {
 namespace joint_trajectory_streamer
 {
 
+const double JointTrajectoryStreamer::STOP_TIMEOUT_ = 5.0;
+
 bool JointTrajectoryStreamer::init(SmplMsgConnection* connection, const std::vector<std::string> &joint_names,
                                    const std::map<std::string, double> &velocity_limits)
 {
@@ -47,8 +51,20 @@ bool JointTrajectoryStreamer::init(SmplMsgConnection* connection, const std::vec
 
   rtn &= JointTrajectoryInterface::init(connection, joint_names, velocity_limits);
 
+  ros::param::param<int>("~streaming_window", this->window_size_, 1);
+  if (this->window_size_ < 1)
+  {
+    ROS_WARN("Invalid streaming window: %d, using 1", this->window_size_);
+    this->window_size_ = 1;
+  }
+  ROS_INFO("Streaming window: %d point(s)", this->window_size_);
+
   this->mutex_.lock();
   this->current_point_ = 0;
+  this->sent_point_ = 0;
+  this->stale_replies_ = 0;
+  this->traj_id_ = 0;
+  this->stop_requested_ = false;
   this->state_ = TransferStates::IDLE;
   this->streaming_thread_ =
       new boost::thread(boost::bind(&JointTrajectoryStreamer::streamingThread, this));
@@ -78,9 +94,7 @@ void JointTrajectoryStreamer::jointTrajectoryCB(const trajectory_msgs::JointTraj
     else
       ROS_ERROR("Trajectory splicing not yet implemented, stopping current motion.");
 
-	this->mutex_.lock();
     trajectoryStop();
-	this->mutex_.unlock();
     return;
   }
 
@@ -107,9 +121,12 @@ bool JointTrajectoryStreamer::send_to_robot(const std::vector<JointTrajPtMessage
     ROS_INFO("Executing trajectory of size: %d", (int)messages.size());
     this->current_traj_ = messages;
     this->current_point_ = 0;
+    this->sent_point_ = 0;
+    this->traj_id_++;
     this->state_ = TransferStates::STREAMING;
     this->streaming_start_ = ros::Time::now();
   }
+  this->cond_.notify_all();
   this->mutex_.unlock();
 
   return true;
@@ -135,20 +152,35 @@ bool JointTrajectoryStreamer::trajectory_to_msgs(const trajectory_msgs::JointTra
 
 void JointTrajectoryStreamer::streamingThread()
 {
-  JointTrajPtMessage jtpMsg;
   int connectRetryCount = 1;
+  bool commsError = false;
+  std::vector<SimpleMessage> points;
+  SimpleMessage reply;
 
   ROS_INFO("Starting joint trajectory streamer thread");
+
+  // The mutex is held while the streaming state is read/modified.  It is
+  // released during socket I/O (and any waits), so that new trajectories and
+  // stop requests are never blocked by the controller.
+  boost::unique_lock<boost::mutex> lock(this->mutex_);
   while (ros::ok())
   {
-    ros::Duration(0.005).sleep();
+    // throttle retries after a communications error
+    if (commsError)
+    {
+      lock.unlock();
+      ros::Duration(0.005).sleep();
+      lock.lock();
+      commsError = false;
+    }
 
     // automatically re-establish connection, if required
     if (connectRetryCount-- > 0)
     {
+      lock.unlock();
       ROS_INFO("Connecting to robot motion server");
-      this->connection_->makeConnect();
-      ros::Duration(0.250).sleep();  // wait for connection
+      this->connection_->pollConnect(250);  // wait (at most 250 ms) for connection
+      lock.lock();
 
       if (this->connection_->isConnected())
         connectRetryCount = 0;
@@ -160,14 +192,31 @@ void JointTrajectoryStreamer::streamingThread()
       continue;
     }
 
-    this->mutex_.lock();
+    // stop requests are handled in any state (the stop command is sent by this
+    // thread, which is the only user of the connection while streaming)
+    if (this->stop_requested_)
+    {
+      int replies = this->sent_point_ - this->current_point_ + this->stale_replies_;
+      this->state_ = TransferStates::IDLE;
+      this->sent_point_ = this->current_point_;
+      this->stale_replies_ = 0;
+
+      lock.unlock();
+      this->drainReplies(replies);
+      JointTrajectoryInterface::trajectoryStop();
+      lock.lock();
+
+      ROS_DEBUG("Stop command sent, entering idle mode");
+      this->stop_requested_ = false;
+      this->cond_.notify_all();
+      continue;
+    }
 
-    SimpleMessage msg, reply;
-        
     switch (this->state_)
     {
       case TransferStates::IDLE:
-        ros::Duration(0.250).sleep();  //  slower loop while waiting for new trajectory
+        // wait for a new trajectory or stop request (the timeout allows ros::ok() to be checked)
+        this->cond_.timed_wait(lock, boost::posix_time::milliseconds(250));
         break;
 
       case TransferStates::STREAMING:
@@ -181,42 +230,148 @@ void JointTrajectoryStreamer::streamingThread()
         if (!this->connection_->isConnected())
         {
           ROS_DEBUG("Robot disconnected.  Attempting reconnect...");
+          this->sent_point_ = this->current_point_;  // in-flight points are lost
+          this->stale_replies_ = 0;
           connectRetryCount = 5;
           break;
         }
 
-        jtpMsg = this->current_traj_[this->current_point_];
-        jtpMsg.toRequest(msg);
-            
-        ROS_DEBUG("Sending joint trajectory point");
-        if (this->connection_->sendAndReceiveMsg(msg, reply, false))
+        if (this->stale_replies_ > 0)
         {
-          ROS_INFO("Point[%d of %d] sent to controller",
-                   this->current_point_, (int)this->current_traj_.size());
-          this->current_point_++;
+          int replies = this->stale_replies_;
+          this->stale_replies_ = 0;
+          lock.unlock();
+          this->drainReplies(replies);
+          lock.lock();
+          break;
         }
-        else
-          ROS_WARN("Failed sent joint point, will try again");
 
+        {
+          // copy the points to send (up to the window size) and release the lock
+          int trajId = this->traj_id_;
+          int inFlight = this->sent_point_ - this->current_point_;
+          int sent = 0;
+          bool received = false;
+
+          points.clear();
+          for (int i = this->sent_point_;
+               (i < (int)this->current_traj_.size()) && (i - this->current_point_ < this->window_size_); ++i)
+          {
+            points.push_back(SimpleMessage());
+            this->current_traj_[i].toRequest(points.back());
+          }
+
+          lock.unlock();
+          sent = this->sendPoints(points);
+          if ((sent == (int)points.size()) && (inFlight + sent > 0))
+            received = this->connection_->receiveMsg(reply);
+          lock.lock();
+
+          if (trajId != this->traj_id_)
+          {
+            // trajectory replaced during I/O, replies to its points are discarded
+            this->stale_replies_ += inFlight + sent - (received ? 1 : 0);
+            break;
+          }
+
+          this->sent_point_ += sent;
+          if (received)
+            this->acknowledgeReply(reply);
+          else
+          {
+            // go back to the oldest un-acknowledged point on any failure
+            ROS_WARN("Failed sent joint point(s), will try again from point %d", this->current_point_);
+            this->sent_point_ = this->current_point_;
+            commsError = true;
+          }
+        }
         break;
+
       default:
         ROS_ERROR("Joint trajectory streamer: unknown state");
         this->state_ = TransferStates::IDLE;
         break;
     }
-
-    this->mutex_.unlock();
   }
 
   ROS_WARN("Exiting trajectory streamer thread");
 }
 
+int JointTrajectoryStreamer::sendPoints(std::vector<SimpleMessage>& points)
+{
+  int sent = 0;
+
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    if (!this->connection_->sendMsg(points[i]))
+      break;
+    sent++;
+  }
+
+  return sent;
+}
+
+void JointTrajectoryStreamer::acknowledgeReply(SimpleMessage& reply)
+{
+  JointTrajPtMessage replyPt;
+  int acked = this->current_point_;
+
+  // Replies that echo the point are matched by sequence (acknowledging any earlier
+  // points whose replies were skipped).  Other replies acknowledge the oldest point.
+  if ((StandardMsgTypes::JOINT_TRAJ_PT == reply.getMessageType()) &&
+      (reply.getDataLength() >= replyPt.byteLength()) && replyPt.init(reply))
+  {
+    int seq = replyPt.point_.getSequence();
+    while ((acked < this->sent_point_) && (this->current_traj_[acked].point_.getSequence() != seq))
+      acked++;
+
+    if (acked >= this->sent_point_)
+    {
+      ROS_WARN("Discarding reply for sequence %d, not in flight", seq);
+      return;
+    }
+    if (acked > this->current_point_)
+      ROS_WARN("Missing replies for points[%d-%d]", this->current_point_, acked - 1);
+  }
+
+  if (ReplyTypes::SUCCESS != reply.getReplyCode())
+    ROS_WARN("Point[%d] reply code: %d", acked, reply.getReplyCode());
+
+  ROS_INFO("Point[%d of %d] sent to controller", acked, (int)this->current_traj_.size());
+  this->current_point_ = acked + 1;
+}
+
+void JointTrajectoryStreamer::drainReplies(int count)
+{
+  SimpleMessage reply;
+
+  if (count > 0)
+    ROS_DEBUG("Receiving replies for %d in-flight points", count);
+
+  for (int i = 0; (i < count) && this->connection_->isConnected(); ++i)
+  {
+    if (!this->connection_->receiveMsg(reply))
+      break;
+  }
+}
+
 void JointTrajectoryStreamer::trajectoryStop()
 {
-  JointTrajectoryInterface::trajectoryStop();
+  boost::unique_lock<boost::mutex> lock(this->mutex_);
+  ros::Time timeout = ros::Time::now() + ros::Duration(STOP_TIMEOUT_);
 
-  ROS_DEBUG("Stop command sent, entering idle mode");
-  this->state_ = TransferStates::IDLE;
+  // the stop command is sent by the streaming thread (wait until it has been sent)
+  this->stop_requested_ = true;
+  this->cond_.notify_all();
+  while (this->stop_requested_ && ros::ok())
+  {
+    if (ros::Time::now() >= timeout)
+    {
+      ROS_ERROR("Timeout waiting for stop command to be sent");
+      break;
+    }
+    this->cond_.timed_wait(lock, boost::posix_time::milliseconds(100));
+  }
 }
 
 } //joint_trajectory_streamer
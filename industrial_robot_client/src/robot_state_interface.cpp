@@ -35,6 +35,7 @@
 using industrial::smpl_msg_connection::SmplMsgConnection;
 using industrial_utils::param::getJointNames;
 namespace StandardSocketPorts = industrial::simple_socket::StandardSocketPorts;
+namespace OverflowPolicies = industrial_robot_client::spsc_ring::OverflowPolicies;
 
 namespace industrial_robot_client
 {
@@ -52,10 +53,15 @@ bool RobotStateInterface::init(std::string default_ip, int default_port)
 {
   std::string ip;
   int port;
+  bool byte_swapping;
+  bool udp_state;
+  SmplMsgConnection* connection;
 
   // override IP/port with ROS params, if available
   ros::param::param<std::string>("robot_ip_address", ip, default_ip);
   ros::param::param<int>("~port", port, default_port);
+  ros::param::param<bool>("~byte_swapping", byte_swapping, false);
+  ros::param::param<bool>("~udp_state", udp_state, false);
 
   // check for valid parameter values
   if (ip.empty())
@@ -70,11 +76,31 @@ bool RobotStateInterface::init(std::string default_ip, int default_port)
   }
 
   char* ip_addr = strdup(ip.c_str());  // connection.init() requires "char*", not "const char*"
-  ROS_INFO("Robot state connecting to IP address: '%s:%d'", ip_addr, port);
-  default_tcp_connection_.init(ip_addr, port);
+  if (udp_state)
+  {
+    ROS_INFO("Robot state connecting (UDP) to IP address: '%s:%d'", ip_addr, port);
+    default_udp_connection_.init(ip_addr, port);
+    default_udp_connection_.setSequencing(true);
+    default_udp_connection_.setLatestOnly(true);
+    // A bounded handshake lets the message manager retry the connection
+    default_udp_connection_.setConnectTimeout(UDP_CONNECT_TIMEOUT);
+    connection = &default_udp_connection_;
+  }
+  else
+  {
+    ROS_INFO("Robot state connecting to IP address: '%s:%d'", ip_addr, port);
+    default_tcp_connection_.init(ip_addr, port);
+    connection = &default_tcp_connection_;
+  }
   free(ip_addr);
 
-  return init(&default_tcp_connection_);
+  if (byte_swapping && !connection->setByteSwapping(true))
+  {
+    ROS_ERROR("Byte swapping not supported by this build.  Please clear ROS '~byte_swapping' param");
+    return false;
+  }
+
+  return init(connection);
 }
 
 bool RobotStateInterface::init(SmplMsgConnection* connection)
@@ -91,6 +117,12 @@ bool RobotStateInterface::init(SmplMsgConnection* connection)
 
 bool RobotStateInterface::init(SmplMsgConnection* connection, std::vector<std::string>& joint_names)
 {
+  int publish_queue_size;
+  bool publish_latest_value;
+
+  ros::param::param<int>("~publish_queue_size", publish_queue_size, 0);
+  ros::param::param<bool>("~publish_latest_value", publish_latest_value, false);
+
   this->joint_names_ = joint_names;
   this->connection_ = connection;
   connection_->makeConnect();
@@ -102,6 +134,14 @@ bool RobotStateInterface::init(SmplMsgConnection* connection, std::vector<std::s
   // initialize default handlers
   if (!default_joint_handler_.init(connection_, joint_names_))
     return false;
+  if (publish_queue_size < 0
+      || !default_joint_handler_.setPublishQueue(publish_queue_size,
+                                                 publish_latest_value ? OverflowPolicies::LATEST_VALUE
+                                                                      : OverflowPolicies::DROP_OLDEST))
+  {
+    ROS_ERROR("Failed to initialize joint publish queue.  Please check ROS '~publish_queue_size' param");
+    return false;
+  }
   this->add_handler(&default_joint_handler_);
 
   if (!default_robot_status_handler_.init(connection_))
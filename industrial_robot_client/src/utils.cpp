@@ -34,8 +34,12 @@
 #include "industrial_utils/utils.h"
 #include "industrial_robot_client/utils.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace industrial_robot_client
 {
@@ -180,5 +184,30 @@ bool isWithinRange(const std::vector<std::string> & lhs_keys, const std::vector<
   return rtn;
 }
 
+double maxVelocityRatio(const double* velocities, const double* limits, size_t size)
+{
+  double max_ratio = 0;
+  size_t i = 0;
+
+#ifdef __SSE2__
+  const __m128d sign_mask = _mm_set1_pd(-0.0);
+  __m128d max_ratios = _mm_setzero_pd();
+  for (; i + 2 <= size; i += 2)
+  {
+    __m128d ratios = _mm_div_pd(_mm_loadu_pd(velocities + i), _mm_loadu_pd(limits + i));
+    max_ratios = _mm_max_pd(max_ratios, _mm_andnot_pd(sign_mask, ratios));  // abs, max
+  }
+
+  double ratios[2];
+  _mm_storeu_pd(ratios, max_ratios);
+  max_ratio = std::max(ratios[0], ratios[1]);
+#endif
+
+  for (; i < size; ++i)
+    max_ratio = std::max(max_ratio, std::fabs(velocities[i] / limits[i]));
+
+  return max_ratio;
+}
+
 } //utils
 } //industrial_robot_client
@@ -0,0 +1,130 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2013, Southwest Research Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 	* Redistributions of source code must retain the above copyright
+ * 	notice, this list of conditions and the following disclaimer.
+ * 	* Redistributions in binary form must reproduce the above copyright
+ * 	notice, this list of conditions and the following disclaimer in the
+ * 	documentation and/or other materials provided with the distribution.
+ * 	* Neither the name of the Southwest Research Institute, nor the names
+ *	of its contributors may be used to endorse or promote products derived
+ *	from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sstream>
+#include "industrial_robot_client/joint_trajectory_interface.h"
+
+using industrial_robot_client::joint_trajectory_interface::JointTrajectoryInterface;
+using industrial_robot_client::joint_trajectory_interface::JointTrajPtMessage;
+
+/**
+ * \brief Benchmarks the conversion of (large) joint trajectories into robot
+ * messages (see JointTrajectoryInterface::trajectory_to_msgs).  No robot
+ * connection is made, but (as for any node) a ROS master is required.
+ *
+ * ROS params:
+ *   - "~num_points" trajectory points (default 10000)
+ *   - "~iterations" number of conversions timed (default 20)
+ *   - "~conversion_threads" conversion threads (default 0, one per core)
+ *   - "~conversion_cache_size" cached trajectories (default 0, disabled).  If
+ *     enabled, only the first conversion is not cached.
+ */
+class TrajectoryBenchmark : public JointTrajectoryInterface
+{
+public:
+
+  TrajectoryBenchmark(const std::vector<std::string>& joint_names, int conversion_threads, int conversion_cache_size)
+  {
+    this->conversion_threads_ = conversion_threads;
+    this->conversion_cache_size_ = conversion_cache_size;
+    this->connection_ = &this->default_tcp_connection_;  // never connected
+    this->all_joint_names_ = joint_names;
+    for (size_t i=0; i<joint_names.size(); ++i)
+      if (!joint_names[i].empty())
+        this->joint_vel_limits_[joint_names[i]] = 2.0;
+  }
+
+  bool convert(const trajectory_msgs::JointTrajectoryConstPtr& traj, std::vector<JointTrajPtMessage>* msgs)
+  {
+    return trajectory_to_msgs(traj, msgs);
+  }
+
+protected:
+
+  bool send_to_robot(const std::vector<JointTrajPtMessage>& messages)
+  {
+    return true;
+  }
+};
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "trajectory_benchmark");
+
+  int num_points, iterations, conversion_threads, conversion_cache_size;
+  ros::param::param<int>("~num_points", num_points, 10000);
+  ros::param::param<int>("~iterations", iterations, 20);
+  ros::param::param<int>("~conversion_threads", conversion_threads, 0);
+  ros::param::param<int>("~conversion_cache_size", conversion_cache_size, 0);
+
+  // robot joints (including a "dummy joint"), commanded in reverse order
+  std::vector<std::string> rbt_joint_names;
+  for (int i=1; i<=6; ++i)
+  {
+    std::ostringstream name;
+    name << "joint_" << i;
+    rbt_joint_names.push_back(name.str());
+  }
+  rbt_joint_names.push_back("");
+
+  trajectory_msgs::JointTrajectoryPtr traj(new trajectory_msgs::JointTrajectory);
+  traj->joint_names.assign(rbt_joint_names.rbegin() + 1, rbt_joint_names.rend());
+  traj->points.resize(num_points);
+  for (int i=0; i<num_points; ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint& pt = traj->points[i];
+    for (size_t j=0; j<traj->joint_names.size(); ++j)
+    {
+      pt.positions.push_back(0.001 * i + j);
+      pt.velocities.push_back(0.1 * j);
+    }
+    pt.time_from_start = ros::Duration(0.004 * i);
+  }
+
+  TrajectoryBenchmark benchmark(rbt_joint_names, conversion_threads, conversion_cache_size);
+  std::vector<JointTrajPtMessage> msgs;
+
+  ros::WallTime start = ros::WallTime::now();
+  for (int i=0; i<iterations; ++i)
+  {
+    if (!benchmark.convert(traj, &msgs) || (int)msgs.size() != num_points)
+    {
+      ROS_ERROR("Failed to convert trajectory");
+      return 1;
+    }
+  }
+  double elapsed = (ros::WallTime::now() - start).toSec();
+
+  ROS_INFO("Converted %d point trajectory %d times: %.3f ms per trajectory, %.0f points/s",
+           num_points, iterations, 1000 * elapsed / iterations, num_points * iterations / elapsed);
+
+  return 0;
+}
@@ -30,10 +30,49 @@
  */
 
 #include "industrial_robot_client/utils.h"
+#include "industrial_robot_client/spsc_ring.h"
+#include "industrial_robot_client/joint_relay_handler.h"
+#include "simple_message/joint_data.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <new>
 #include <gtest/gtest.h>
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
 
 using namespace industrial_robot_client::utils;
+using namespace industrial_robot_client::spsc_ring;
+using industrial_robot_client::joint_relay_handler::JointMessageConverter;
+using industrial::joint_data::JointData;
+using industrial::joint_message::JointMessage;
+
+// Counts (global) heap allocations, see JointRelaySuite (atomic, as other
+// tests allocate from several threads)
+static boost::atomic<unsigned long> num_allocations(0);
+
+void* operator new(std::size_t size)
+{
+  num_allocations.fetch_add(1, boost::memory_order_relaxed);
+  void* ptr = std::malloc(size ? size : 1);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) throw()
+{
+  std::free(ptr);
+}
+
+#if __cplusplus >= 201402L
+void operator delete(void* ptr, std::size_t size) throw()
+{
+  std::free(ptr);
+}
+#endif
 
 
 TEST(IndustrialUtilsSuite, vector_within_range)
@@ -136,6 +175,221 @@ TEST(IndustrialUtilsSuite, map_within_range)
 
 }
 
+// Scalar reference for maxVelocityRatio
+double refMaxVelocityRatio(const std::vector<double> & velocities, const std::vector<double> & limits,
+                           size_t size)
+{
+  double max_ratio = 0;
+  for (size_t i = 0; i < size; ++i)
+    max_ratio = std::max(max_ratio, std::fabs(velocities[i] / limits[i]));
+  return max_ratio;
+}
+
+TEST(IndustrialUtilsSuite, max_velocity_ratio)
+{
+  const size_t MAX_JOINTS = 9;
+  const double inf = std::numeric_limits<double>::infinity();
+  std::vector<double> velocities(MAX_JOINTS), limits(MAX_JOINTS);
+
+  EXPECT_EQ(0.0, maxVelocityRatio(NULL, NULL, 0));
+
+  // Odd and even joint counts (the last joint of an odd count is not vectorized)
+  for (size_t size = 1; size <= MAX_JOINTS; ++size)
+  {
+    // Mixed signs, ratios increase with the joint index
+    for (size_t i = 0; i < size; ++i)
+    {
+      velocities[i] = (i % 2 ? -0.1 : 0.1) * (i + 1);
+      limits[i] = 1.0 + 0.5 * i;
+    }
+    EXPECT_DOUBLE_EQ(refMaxVelocityRatio(velocities, limits, size),
+                     maxVelocityRatio(&velocities[0], &limits[0], size)) << "size: " << size;
+
+    // Largest ratio on the first joint
+    velocities[0] = -2.0 * limits[0];
+    EXPECT_DOUBLE_EQ(2.0, maxVelocityRatio(&velocities[0], &limits[0], size)) << "size: " << size;
+
+    // Largest ratio on the last joint
+    velocities[size - 1] = 3.0 * limits[size - 1];
+    EXPECT_DOUBLE_EQ(3.0, maxVelocityRatio(&velocities[0], &limits[0], size)) << "size: " << size;
+
+    // Unlimited joints are ignored
+    limits[size - 1] = inf;
+    EXPECT_DOUBLE_EQ(refMaxVelocityRatio(velocities, limits, size),
+                     maxVelocityRatio(&velocities[0], &limits[0], size)) << "size: " << size;
+    std::fill(limits.begin(), limits.begin() + size, inf);
+    EXPECT_EQ(0.0, maxVelocityRatio(&velocities[0], &limits[0], size)) << "size: " << size;
+  }
+}
+
+TEST(SpscRingSuite, overflow)
+{
+  SpscRing<int> ring;
+  int item;
+
+  EXPECT_FALSE(ring.init(0, OverflowPolicies::DROP_OLDEST));
+  ASSERT_TRUE(ring.init(4, OverflowPolicies::DROP_OLDEST));
+  EXPECT_TRUE(ring.isEmpty());
+  EXPECT_FALSE(ring.pop(item));
+
+  // Items are popped in order
+  for (int i = 0; i < 3; i++)
+  {
+    ring.push(i);
+  }
+  EXPECT_EQ(3u, ring.getSize());
+  for (int i = 0; i < 3; i++)
+  {
+    ASSERT_TRUE(ring.pop(item));
+    EXPECT_EQ(i, item);
+  }
+  EXPECT_FALSE(ring.pop(item));
+
+  // The oldest items are dropped to make room
+  for (int i = 0; i < 6; i++)
+  {
+    ring.push(i);
+  }
+  EXPECT_EQ(4u, ring.getSize());
+  EXPECT_EQ(2u, ring.getNumDropped());
+  for (int i = 2; i < 6; i++)
+  {
+    ASSERT_TRUE(ring.pop(item));
+    EXPECT_EQ(i, item);
+  }
+
+  // Only the latest item remains
+  ASSERT_TRUE(ring.init(4, OverflowPolicies::LATEST_VALUE));
+  for (int i = 0; i < 6; i++)
+  {
+    ring.push(i);
+  }
+  EXPECT_EQ(2u, ring.getSize());
+  EXPECT_EQ(4u, ring.getNumDropped());
+  EXPECT_EQ(6u, ring.getNumPushed());
+  ASSERT_TRUE(ring.pop(item));
+  EXPECT_EQ(4, item);
+  ASSERT_TRUE(ring.pop(item));
+  EXPECT_EQ(5, item);
+  EXPECT_FALSE(ring.pop(item));
+}
+
+// Ring item that detects torn copies (all values equal)
+struct RingSample
+{
+  unsigned long values[16];
+};
+
+void ringProducer(SpscRing<RingSample>* ring, unsigned long num_items)
+{
+  RingSample sample;
+  for (unsigned long i = 1; i <= num_items; i++)
+  {
+    std::fill(sample.values, sample.values + 16, i);
+    ring->push(sample);
+  }
+}
+
+TEST(SpscRingSuite, concurrent)
+{
+  const unsigned long NUM_ITEMS = 1000000;
+
+  for (int policy = OverflowPolicies::DROP_OLDEST; policy <= OverflowPolicies::LATEST_VALUE; policy++)
+  {
+    SpscRing<RingSample> ring;
+    RingSample sample;
+    unsigned long last = 0;
+    unsigned long popped = 0;
+    bool valid = true;
+
+    ASSERT_TRUE(ring.init(8, (OverflowPolicy)policy));
+    boost::thread producer(ringProducer, &ring, NUM_ITEMS);
+    while (valid && last < NUM_ITEMS)
+    {
+      if (ring.pop(sample))
+      {
+        // Items are whole and in order (some may be dropped)
+        valid = (sample.values[0] > last)
+            && (std::count(sample.values, sample.values + 16, sample.values[0]) == 16);
+        last = sample.values[0];
+        popped++;
+      }
+    }
+    producer.join();
+
+    EXPECT_TRUE(valid);
+    EXPECT_EQ(NUM_ITEMS, last);
+    EXPECT_EQ(NUM_ITEMS, ring.getNumPushed());
+    EXPECT_EQ(NUM_ITEMS, popped + ring.getNumDropped());
+  }
+}
+
+TEST(JointRelaySuite, zero_allocation)
+{
+  const int NUM_JOINTS = 7;
+  const int NUM_MESSAGES = 1000;
+
+  // Names are long enough to be allocated (not stored in place)
+  std::vector<std::string> pub_joint_names;
+  std::vector<int> pub_joint_indices;
+  for (int i = 0; i < NUM_JOINTS; i++)
+  {
+    if (i == 3)
+      continue;  // a "blank" joint, not published
+    pub_joint_names.push_back(std::string("robot_joint_name_") + (char)('a' + i));
+    pub_joint_indices.push_back(i);
+  }
+
+  JointMessageConverter converter;
+  EXPECT_FALSE(converter.init(NUM_JOINTS - 4, pub_joint_names, pub_joint_indices));
+  ASSERT_TRUE(converter.init(NUM_JOINTS, pub_joint_names, pub_joint_indices));
+
+  JointData joints;
+  JointMessage msg;
+  std::vector<double> all_joint_pos;
+  std::vector<double> xform_joint_pos;
+  control_msgs::FollowJointTrajectoryFeedback control_state;
+  sensor_msgs::JointState sensor_state;
+
+  // The first message fills the (reused) positions and messages
+  msg.init(0, joints);
+  ASSERT_TRUE(converter.getPositions(msg, &all_joint_pos));
+  xform_joint_pos = all_joint_pos;
+  ASSERT_TRUE(converter.toMessages(xform_joint_pos, ros::Time(1.0), &control_state, &sensor_state));
+  EXPECT_EQ(pub_joint_names, control_state.joint_names);
+  EXPECT_EQ(pub_joint_names, sensor_state.name);
+
+  bool rtn = true;
+  unsigned long start = num_allocations;
+  for (int n = 1; n <= NUM_MESSAGES; n++)
+  {
+    for (int i = 0; i < NUM_JOINTS; i++)
+    {
+      joints.setJoint(i, n + i * 0.1);
+    }
+    msg.init(n, joints);
+    rtn &= converter.getPositions(msg, &all_joint_pos);
+    xform_joint_pos = all_joint_pos;  // as the default transform
+    rtn &= converter.toMessages(xform_joint_pos, ros::Time(n), &control_state, &sensor_state);
+  }
+  unsigned long allocations = num_allocations - start;
+
+  EXPECT_TRUE(rtn);
+  EXPECT_EQ(0u, allocations);
+  EXPECT_EQ(pub_joint_names, sensor_state.name);
+  ASSERT_EQ(pub_joint_indices.size(), sensor_state.position.size());
+  for (int i = 0; i < pub_joint_indices.size(); i++)
+  {
+    EXPECT_FLOAT_EQ(NUM_MESSAGES + pub_joint_indices[i] * 0.1, sensor_state.position[i]);
+    EXPECT_FLOAT_EQ(NUM_MESSAGES + pub_joint_indices[i] * 0.1, control_state.actual.positions[i]);
+  }
+  EXPECT_EQ(ros::Time(NUM_MESSAGES), sensor_state.header.stamp);
+
+  // Joint positions that do not match the joint count are rejected
+  xform_joint_pos.pop_back();
+  EXPECT_FALSE(converter.toMessages(xform_joint_pos, ros::Time(1.0), &control_state, &sensor_state));
+}
+
 // Run all the tests that were declared with TEST()
   int main(int argc, char **argv)
   {
@@ -0,0 +1,192 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2013, Southwest Research Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 	* Redistributions of source code must retain the above copyright
+ * 	notice, this list of conditions and the following disclaimer.
+ * 	* Redistributions in binary form must reproduce the above copyright
+ * 	notice, this list of conditions and the following disclaimer in the
+ * 	documentation and/or other materials provided with the distribution.
+ * 	* Neither the name of the Southwest Research Institute, nor the names
+ *	of its contributors may be used to endorse or promote products derived
+ *	from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "industrial_robot_client/joint_relay_handler.h"
+#include "simple_message/socket/tcp_client.h"
+#include <cstdlib>
+#include <new>
+#include <gtest/gtest.h>
+
+using industrial_robot_client::joint_relay_handler::JointRelayHandler;
+using industrial::joint_data::JointData;
+using industrial::joint_message::JointMessage;
+using industrial::simple_message::SimpleMessage;
+using industrial::tcp_client::TcpClient;
+
+// These tests create a node handle (see JointRelayHandler), so they require a
+// ROS master and are run with rostest.
+
+// Counts (global) heap allocations made by the test thread while counting is
+// enabled (other threads, i.e. ROS, are not counted)
+static __thread bool count_allocations = false;
+static unsigned long num_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+  if (count_allocations)
+    num_allocations++;
+  void* ptr = std::malloc(size ? size : 1);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) throw()
+{
+  std::free(ptr);
+}
+
+#if __cplusplus >= 201402L
+void operator delete(void* ptr, std::size_t size) throw()
+{
+  std::free(ptr);
+}
+#endif
+
+// Publishes the (non-blank) joints in reverse order, with scaled positions
+class TestRelayHandler : public JointRelayHandler
+{
+public:
+
+  bool select_joints(const std::vector<std::string>& all_joint_names,
+                     std::vector<int>* pub_joint_indices, std::vector<std::string>* pub_joint_names)
+  {
+    pub_joint_indices->clear();
+    pub_joint_names->clear();
+    for (int i=all_joint_names.size()-1; i>=0; --i)
+    {
+      if (all_joint_names[i].empty())
+        continue;
+      pub_joint_indices->push_back(i);
+      pub_joint_names->push_back(all_joint_names[i]);
+    }
+    return true;
+  }
+
+  bool transform(const std::vector<double>& pos_in, std::vector<double>* pos_out)
+  {
+    *pos_out = pos_in;
+    for (int i=0; i<pos_out->size(); ++i)
+      (*pos_out)[i] *= 2.0;
+    return true;
+  }
+
+  const sensor_msgs::JointState& getSensorState()
+  {
+    return this->sensor_state_;
+  }
+
+  const control_msgs::FollowJointTrajectoryFeedback& getControlState()
+  {
+    return this->control_state_;
+  }
+};
+
+TEST(JointRelaySuite, handler_zero_allocation)
+{
+  const int NUM_JOINTS = 7;
+  const int NUM_MESSAGES = 1000;
+
+  TcpClient connection;  // never connected, topic messages are not replied to
+  TestRelayHandler handler;
+  JointData joints;
+  JointMessage jMsg;
+  SimpleMessage msg;
+
+  // Names are long enough to be allocated (not stored in place)
+  std::vector<std::string> joint_names;
+  std::vector<std::string> pub_joint_names;
+  for (int i = 0; i < NUM_JOINTS; i++)
+  {
+    joint_names.push_back(std::string("robot_joint_name_") + (char)('a' + i));
+  }
+  joint_names[3] = "";  // a "blank" joint, not published
+  for (int i = NUM_JOINTS - 1; i >= 0; i--)
+  {
+    if (!joint_names[i].empty())
+      pub_joint_names.push_back(joint_names[i]);
+  }
+
+  ASSERT_TRUE(handler.init(&connection, joint_names));
+
+  // The first message fills the (reused) positions and messages
+  jMsg.init(0, joints);
+  ASSERT_TRUE(jMsg.toTopic(msg));
+  handler.callback(msg);
+  ASSERT_EQ(1u, handler.getNumPublished());
+  EXPECT_EQ(pub_joint_names, handler.getSensorState().name);
+  EXPECT_EQ(pub_joint_names, handler.getControlState().joint_names);
+
+  // Messages are relayed (received, converted and published) by the
+  // receiving thread without allocating
+  unsigned long allocations = 0;
+  for (int n = 1; n <= NUM_MESSAGES; n++)
+  {
+    for (int i = 0; i < NUM_JOINTS; i++)
+    {
+      joints.setJoint(i, n + i * 0.1);
+    }
+    jMsg.init(n, joints);
+    ASSERT_TRUE(jMsg.toTopic(msg));
+
+    unsigned long start = num_allocations;
+    count_allocations = true;
+    handler.callback(msg);
+    count_allocations = false;
+    allocations += num_allocations - start;
+  }
+
+  EXPECT_EQ(0u, allocations);
+  EXPECT_EQ(NUM_MESSAGES + 1u, handler.getNumPublished());
+
+  // The selected joints are published in their selected order, with their
+  // transformed positions
+  const sensor_msgs::JointState& sensor_state = handler.getSensorState();
+  const control_msgs::FollowJointTrajectoryFeedback& control_state = handler.getControlState();
+  EXPECT_EQ(pub_joint_names, sensor_state.name);
+  ASSERT_EQ(pub_joint_names.size(), sensor_state.position.size());
+  ASSERT_EQ(pub_joint_names.size(), control_state.actual.positions.size());
+  for (int i = 0, j = NUM_JOINTS - 1; i < pub_joint_names.size(); i++, j--)
+  {
+    if (j == 3)
+      j--;
+    EXPECT_FLOAT_EQ(2.0 * (NUM_MESSAGES + j * 0.1), sensor_state.position[i]);
+    EXPECT_FLOAT_EQ(2.0 * (NUM_MESSAGES + j * 0.1), control_state.actual.positions[i]);
+  }
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "utest_joint_relay_handler");
+  return RUN_ALL_TESTS();
+}
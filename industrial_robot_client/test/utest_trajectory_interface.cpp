@@ -0,0 +1,305 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2013, Southwest Research Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 	* Redistributions of source code must retain the above copyright
+ * 	notice, this list of conditions and the following disclaimer.
+ * 	* Redistributions in binary form must reproduce the above copyright
+ * 	notice, this list of conditions and the following disclaimer in the
+ * 	documentation and/or other materials provided with the distribution.
+ * 	* Neither the name of the Southwest Research Institute, nor the names
+ *	of its contributors may be used to endorse or promote products derived
+ *	from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sstream>
+#include "industrial_robot_client/joint_trajectory_interface.h"
+#include <gtest/gtest.h>
+
+using industrial_robot_client::joint_trajectory_interface::JointTrajectoryInterface;
+using industrial_robot_client::joint_trajectory_interface::JointTrajPtMessage;
+
+// These tests create a node handle (see JointTrajectoryInterface), so they
+// require a ROS master and are run with rostest.
+
+const double VEL_LIMIT = 2.0;
+
+// Converts trajectories without a robot connection
+class TestTrajectoryInterface : public JointTrajectoryInterface
+{
+public:
+
+  TestTrajectoryInterface(const std::vector<std::string>& joint_names) : num_validations_(0), num_speeds_(0)
+  {
+    this->connection_ = &this->default_tcp_connection_;  // never connected
+    this->all_joint_names_ = joint_names;
+    for (size_t i=0; i<joint_names.size(); ++i)
+      if (!joint_names[i].empty())
+        this->joint_vel_limits_[joint_names[i]] = VEL_LIMIT;
+    this->update_vel_limits();
+  }
+
+  bool convert(const trajectory_msgs::JointTrajectoryConstPtr& traj, std::vector<JointTrajPtMessage>* msgs)
+  {
+    return trajectory_to_msgs(traj, msgs);
+  }
+
+  bool validate(const trajectory_msgs::JointTrajectory &traj)
+  {
+    return is_valid(traj);
+  }
+
+  void setConversionThreads(int conversion_threads)
+  {
+    this->conversion_threads_ = conversion_threads;
+  }
+
+  void setConversionCacheSize(int conversion_cache_size)
+  {
+    this->conversion_cache_size_ = conversion_cache_size;
+  }
+
+  int num_validations_;  // is_valid calls
+  int num_speeds_;  // calc_speed calls (points converted)
+
+protected:
+
+  bool calc_speed(const trajectory_msgs::JointTrajectoryPoint& pt, double* rbt_velocity, double* rbt_duration)
+  {
+    this->num_speeds_++;
+    return JointTrajectoryInterface::calc_speed(pt, rbt_velocity, rbt_duration);
+  }
+
+  bool is_valid(const trajectory_msgs::JointTrajectory &traj)
+  {
+    this->num_validations_++;
+    return JointTrajectoryInterface::is_valid(traj);
+  }
+
+  bool send_to_robot(const std::vector<JointTrajPtMessage>& messages)
+  {
+    return true;
+  }
+};
+
+// robot joints, including a "dummy joint"
+std::vector<std::string> robotJointNames(int num_joints)
+{
+  std::vector<std::string> joint_names;
+  for (int i=1; i<=num_joints; ++i)
+  {
+    std::ostringstream name;
+    name << "joint_" << i;
+    joint_names.push_back(name.str());
+  }
+  joint_names.push_back("");
+
+  return joint_names;
+}
+
+// trajectory of all (but the dummy) robot joints, in reverse order.  Points
+// are 1 s apart, starting at start_time.
+trajectory_msgs::JointTrajectoryPtr makeTrajectory(const std::vector<std::string>& rbt_joint_names,
+                                                   int num_points, double start_time)
+{
+  trajectory_msgs::JointTrajectoryPtr traj(new trajectory_msgs::JointTrajectory);
+  traj->joint_names.assign(rbt_joint_names.rbegin() + 1, rbt_joint_names.rend());
+  traj->points.resize(num_points);
+  for (int i=0; i<num_points; ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint& pt = traj->points[i];
+    for (size_t j=0; j<traj->joint_names.size(); ++j)
+    {
+      pt.positions.push_back(0.001 * i + j);
+      pt.velocities.push_back(0.1 * j);
+    }
+    pt.time_from_start = ros::Duration(start_time + i);
+  }
+
+  return traj;
+}
+
+TEST(JointTrajectoryInterfaceSuite, is_valid)
+{
+  std::vector<std::string> joint_names = robotJointNames(6);
+  TestTrajectoryInterface interface(joint_names);
+  trajectory_msgs::JointTrajectoryPtr traj = makeTrajectory(joint_names, 3, 0.0);
+  std::vector<JointTrajPtMessage> msgs;
+
+  EXPECT_TRUE(interface.validate(*traj));
+
+  // Joints not sent to the robot are not checked
+  traj->joint_names.push_back("not_a_robot_joint");
+  for (size_t i=0; i<traj->points.size(); ++i)
+  {
+    traj->points[i].positions.push_back(0.0);
+    traj->points[i].velocities.push_back(10 * VEL_LIMIT);
+  }
+  EXPECT_TRUE(interface.validate(*traj));
+
+  // A robot joint over its velocity limit
+  traj = makeTrajectory(joint_names, 3, 0.0);
+  traj->points[2].velocities[1] = -1.5 * VEL_LIMIT;
+  EXPECT_FALSE(interface.validate(*traj));
+  EXPECT_FALSE(interface.convert(traj, &msgs));
+
+  // A missing robot joint (the trajectory can't be sent to the robot)
+  traj = makeTrajectory(joint_names, 3, 0.0);
+  traj->joint_names.erase(traj->joint_names.begin() + 2);
+  for (size_t i=0; i<traj->points.size(); ++i)
+  {
+    traj->points[i].positions.erase(traj->points[i].positions.begin() + 2);
+    traj->points[i].velocities.erase(traj->points[i].velocities.begin() + 2);
+  }
+  EXPECT_FALSE(interface.validate(*traj));
+  EXPECT_FALSE(interface.convert(traj, &msgs));
+}
+
+TEST(JointTrajectoryInterfaceSuite, durations)
+{
+  std::vector<std::string> joint_names = robotJointNames(6);
+  TestTrajectoryInterface interface1(joint_names), interface2(joint_names);
+  trajectory_msgs::JointTrajectoryPtr traj = makeTrajectory(joint_names, 3, 1.0);
+  std::vector<JointTrajPtMessage> msgs;
+
+  // Durations are relative to the previous point
+  ASSERT_TRUE(interface1.convert(traj, &msgs));
+  ASSERT_EQ(3u, msgs.size());
+  for (size_t i=0; i<msgs.size(); ++i)
+    EXPECT_FLOAT_EQ(1.0, msgs[i].point_.getDuration());
+
+  // A trajectory that starts earlier is a new trajectory (default duration
+  // to the first point)
+  ASSERT_TRUE(interface1.convert(traj, &msgs));
+  EXPECT_FLOAT_EQ(10.0, msgs[0].point_.getDuration());
+  EXPECT_FLOAT_EQ(1.0, msgs[1].point_.getDuration());
+
+  // The previous point is tracked per instance
+  ASSERT_TRUE(interface2.convert(traj, &msgs));
+  EXPECT_FLOAT_EQ(1.0, msgs[0].point_.getDuration());
+}
+
+TEST(JointTrajectoryInterfaceSuite, parallel_conversion)
+{
+  const int NUM_POINTS = 2500;
+  std::vector<std::string> joint_names = robotJointNames(6);
+  TestTrajectoryInterface serial(joint_names), parallel(joint_names);
+  trajectory_msgs::JointTrajectoryPtr traj = makeTrajectory(joint_names, NUM_POINTS, 0.0);
+  std::vector<JointTrajPtMessage> serial_msgs, parallel_msgs;
+
+  parallel.setConversionThreads(4);
+  ASSERT_TRUE(serial.convert(traj, &serial_msgs));
+  ASSERT_TRUE(parallel.convert(traj, &parallel_msgs));
+  ASSERT_EQ(NUM_POINTS, (int)serial_msgs.size());
+  ASSERT_EQ(NUM_POINTS, (int)parallel_msgs.size());
+  for (int i=0; i<NUM_POINTS; ++i)
+  {
+    EXPECT_EQ(i, parallel_msgs[i].point_.getSequence());
+    EXPECT_TRUE(serial_msgs[i].point_ == parallel_msgs[i].point_);
+  }
+}
+
+TEST(JointTrajectoryInterfaceSuite, conversion_cache)
+{
+  const int NUM_POINTS = 3;
+  std::vector<std::string> joint_names = robotJointNames(6);
+  TestTrajectoryInterface interface(joint_names);
+  std::vector<JointTrajPtMessage> msgs, first_msgs;
+  trajectory_msgs::JointTrajectoryPtr traj_a = makeTrajectory(joint_names, NUM_POINTS, 0.0);
+  trajectory_msgs::JointTrajectoryPtr traj_b = makeTrajectory(joint_names, NUM_POINTS, 0.0);
+  trajectory_msgs::JointTrajectoryPtr traj_c = makeTrajectory(joint_names, NUM_POINTS, 0.0);
+  traj_b->points[1].positions[0] += 0.1;
+  traj_c->points[2].velocities[0] += 0.1;
+
+  // Disabled by default
+  ASSERT_TRUE(interface.convert(traj_a, &msgs));
+  ASSERT_TRUE(interface.convert(traj_a, &msgs));
+  EXPECT_EQ(2 * NUM_POINTS, interface.num_speeds_);
+
+  // Miss, then hit (an identical trajectory, validated but not converted)
+  interface.setConversionCacheSize(2);
+  interface.num_speeds_ = interface.num_validations_ = 0;
+  ASSERT_TRUE(interface.convert(traj_a, &first_msgs));
+  EXPECT_EQ(NUM_POINTS, interface.num_speeds_);
+  ASSERT_TRUE(interface.convert(makeTrajectory(joint_names, NUM_POINTS, 0.0), &msgs));
+  EXPECT_EQ(NUM_POINTS, interface.num_speeds_);
+  EXPECT_EQ(2, interface.num_validations_);
+  ASSERT_EQ(first_msgs.size(), msgs.size());
+  for (size_t i=0; i<msgs.size(); ++i)
+    EXPECT_TRUE(first_msgs[i].point_ == msgs[i].point_);
+
+  // Different point data misses
+  ASSERT_TRUE(interface.convert(traj_b, &msgs));
+  EXPECT_EQ(2 * NUM_POINTS, interface.num_speeds_);
+  EXPECT_FALSE(first_msgs[1].point_ == msgs[1].point_);
+
+  // The least recently used trajectory is evicted (cache: b, a => a, b => c, a)
+  ASSERT_TRUE(interface.convert(traj_a, &msgs));
+  EXPECT_EQ(2 * NUM_POINTS, interface.num_speeds_);
+  ASSERT_TRUE(interface.convert(traj_c, &msgs));
+  EXPECT_EQ(3 * NUM_POINTS, interface.num_speeds_);
+  ASSERT_TRUE(interface.convert(traj_a, &msgs));
+  EXPECT_EQ(3 * NUM_POINTS, interface.num_speeds_);
+  ASSERT_TRUE(interface.convert(traj_b, &msgs));
+  EXPECT_EQ(4 * NUM_POINTS, interface.num_speeds_);
+}
+
+TEST(JointTrajectoryInterfaceSuite, conversion_cache_durations)
+{
+  std::vector<std::string> joint_names = robotJointNames(6);
+  TestTrajectoryInterface interface(joint_names);
+  trajectory_msgs::JointTrajectoryPtr traj = makeTrajectory(joint_names, 3, 0.0);  // 0-2 s
+  trajectory_msgs::JointTrajectoryPtr short_traj = makeTrajectory(joint_names, 2, 0.0);  // 0-1 s
+  trajectory_msgs::JointTrajectoryPtr next_traj = makeTrajectory(joint_names, 3, 3.0);  // 3-5 s
+  std::vector<JointTrajPtMessage> msgs;
+
+  interface.setConversionCacheSize(4);
+
+  // A new trajectory (default duration to the first point), a hit is the same
+  for (int i=0; i<2; ++i)
+  {
+    ASSERT_TRUE(interface.convert(traj, &msgs));
+    EXPECT_FLOAT_EQ(10.0, msgs[0].point_.getDuration());
+    EXPECT_FLOAT_EQ(1.0, msgs[1].point_.getDuration());
+  }
+  EXPECT_EQ(3, interface.num_speeds_);
+
+  // A continued trajectory depends on the previous trajectory (not cached)
+  ASSERT_TRUE(interface.convert(next_traj, &msgs));
+  EXPECT_FLOAT_EQ(1.0, msgs[0].point_.getDuration());
+  ASSERT_TRUE(interface.convert(short_traj, &msgs));
+  ASSERT_TRUE(interface.convert(next_traj, &msgs));
+  EXPECT_FLOAT_EQ(2.0, msgs[0].point_.getDuration());
+  EXPECT_EQ(11, interface.num_speeds_);
+
+  // A hit continues (the previous point is the end of the cached trajectory)
+  ASSERT_TRUE(interface.convert(traj, &msgs));
+  EXPECT_EQ(11, interface.num_speeds_);
+  ASSERT_TRUE(interface.convert(next_traj, &msgs));
+  EXPECT_FLOAT_EQ(1.0, msgs[0].point_.getDuration());
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "utest_trajectory_interface");
+  return RUN_ALL_TESTS();
+}
@@ -54,6 +54,9 @@ namespace industrial
 namespace byte_array
 {
 
+// Class declaration required for function prototypes below
+class ByteArrayReader;
+
 /**
  * \brief The byte array wraps a traditional, fixed size, array of bytes (i.e. char*).
  *
@@ -66,9 +69,12 @@ namespace byte_array
  * of the array.  As long as the standard load/unload methods are uses, this is
  * transparent to the user.
  *
- * A fixed size array is used for simplicity (i.e. avoiding re-implementing
- * the STL vector class for those systems that don't have access to the STL,
- * i.e. Motoman robotics Motoplus compiler.
+ * A small, fixed size, array is embedded in the class and is used for most
+ * messages.  Larger data (up to the max size) is stored in a dynamically
+ * allocated buffer, so that the cost of the byte array (construction, copies)
+ * scales with the data it holds.  For systems that don't support dynamic memory
+ * allocation (i.e. Motoman robotics Motoplus compiler), FIXED_SIZE_BUFFERS is
+ * defined and a single, max size, array is embedded instead.
  *
  * THIS CLASS IS NOT THREAD-SAFE
  *
@@ -81,6 +87,9 @@ public:
   // Provides SimpleSerialize access to byte array internals
   friend class SimpleSerialize;
 
+  // Provides ByteArrayReader access to byte swapping
+  friend class ByteArrayReader;
+
   /**
    * \brief Default constructor
    *
@@ -89,16 +98,37 @@ public:
    */
   ByteArray(void);
 
+  /**
+   * \brief Copy constructor
+   *
+   * This method creates a byte array containing a deep copy of the passed
+   * in byte array (only the data is copied, not the unused buffer).
+   *
+   * \param buffer buffer to copy
+   *
+   */
+  ByteArray(const ByteArray & buffer);
+
   /**
    * \brief Destructor
    *
    */
   ~ByteArray(void);
 
+  /**
+   * \brief Assignment operator (deep copy, see copy constructor)
+   *
+   * \param rhs buffer to copy
+   *
+   * \return reference to this byte array
+   */
+  ByteArray & operator=(const ByteArray & rhs);
+
   /**
    * \brief Initializes or Reinitializes an empty buffer.
    *
-   * This method sets all values to 0 and resets the buffer size.
+   * This method resets the buffer size (the contents of the buffer are
+   * not cleared).
    *
    */
   void init();
@@ -243,6 +273,22 @@ public:
    */
   bool unload(ByteArray &value, const industrial::shared_types::shared_int byte_size);
 
+  /**
+   * \brief unloads a partial byte array from the byte array and initializes
+   * the passed in reader with it.  As for all unload methods, the data is
+   * removed from the end of this array.  No data is copied, the reader refers
+   * to the unloaded portion of this byte array and is only valid as long as
+   * this byte array is not modified.  This allows data at the end of the array
+   * to be read in the forward direction (see ByteArrayReader).  Use
+   * ByteArrayReader::init(ByteArray&) to read an array without modifying it.
+   *
+   * \param value reader to initialize
+   * \param byte_size number of bytes to unload
+   *
+   * \return true on success, false otherwise (array is empty)
+   */
+  bool unload(ByteArrayReader &value, const industrial::shared_types::shared_int byte_size);
+
   /**
    * \brief unloads a void* (treated as char*) from the byte array.
    * WARNING: Byte swapping is not performed in this function.
@@ -305,6 +351,42 @@ public:
    */
   char* getRawDataPtr();
 
+  /**
+   * \brief gets a pointer to the end of the current data (i.e. the location
+   * of the next load).  This allows data to be written directly into the
+   * array (i.e. by a socket read) without an intermediate copy.  Bytes written
+   * to this location are not part of the array until extendBufferSize() is
+   * called.  The buffer is grown (if required) to hold num_bytes, which may
+   * invalidate pointers previously returned by this method.
+   *
+   * \param num_bytes number of bytes that will be written
+   *
+   * \return pointer to load location (NULL if num_bytes would exceed the max
+   * array size)
+   */
+  char* getLoadPtr(const industrial::shared_types::shared_int num_bytes);
+
+  /**
+   * \brief extends current buffer size.  Used to add bytes written directly
+   * to the load location (see getLoadPtr(num_bytes)) to the array.
+   *
+   * \param number of bytes to extend
+   *
+   * \return true on success, false otherwise (new size is too large)
+   */
+  bool extendBufferSize(const industrial::shared_types::shared_int size);
+
+  /**
+   * \brief truncates the array to size bytes, data after the first size
+   * bytes is discarded
+   *
+   * \param size new size
+   *
+   * \return true on success, false otherwise (size is negative or larger than
+   * the current size)
+   */
+  bool truncate(const industrial::shared_types::shared_int size);
+
   /**
    * \brief gets current buffer size
    *
@@ -328,6 +410,22 @@ public:
      */
   static bool isByteSwapEnabled();
 
+  /**
+   * \brief Swaps the byte order of an array of equally sized values (in
+   * place).  This is independent of the BYTE_SWAPPING compiler flag and is
+   * used to swap complete messages at runtime (see
+   * SmplMsgConnection::setByteSwapping).
+   *
+   * \param values pointer to values to swap
+   * \param byte_size size of values (in bytes), must be a multiple of
+   * value_size
+   * \param value_size size of a single value (in bytes)
+   *
+   * \return true on success, false otherwise (invalid sizes)
+   */
+  static bool swapArray(void *values, industrial::shared_types::shared_int byte_size,
+                        industrial::shared_types::shared_int value_size);
+
 private:
   /**
    * \brief maximum array size (WARNING: THIS VALUE SHOULD NOT EXCEED THE MAX
@@ -339,17 +437,40 @@ private:
    */
   static const industrial::shared_types::shared_int MAX_SIZE = 16384;
 
+#ifdef FIXED_SIZE_BUFFERS
   /**
    * \brief internal data buffer
    */
   char buffer_[MAX_SIZE];
+#else
+  /**
+   * \brief size of the embedded data buffer.  This is large enough to hold
+   * any of the standard single point/state messages.
+   */
+  static const industrial::shared_types::shared_int INLINE_SIZE = 1024;
+
+  /**
+   * \brief embedded data buffer (used until the data exceeds INLINE_SIZE)
+   */
+  char inline_buffer_[INLINE_SIZE];
+
+  /**
+   * \brief internal data buffer (either the embedded buffer or a dynamically
+   * allocated buffer)
+   */
+  char* buffer_;
+
+  /**
+   * \brief current capacity of the internal data buffer
+   */
+  industrial::shared_types::shared_int buffer_capacity_;
+#endif
 
   /**
    * \brief current buffer size
    */
   industrial::shared_types::shared_int buffer_size_;
 
-#ifdef BYTE_SWAPPING
   /**
    * \brief Swaps byte of value (in place)
    *
@@ -357,26 +478,26 @@ private:
    * \param byteSize (in bytes)
    *
    */
-  void swap(void *value, industrial::shared_types::shared_int byteSize);
-#endif
+  static void swap(void *value, industrial::shared_types::shared_int byteSize);
 
   /**
-   * \brief sets current buffer size
+   * \brief ensures the internal data buffer can hold size bytes (the
+   * buffer is grown if required, existing data is retained)
    *
-   * \param size new size
+   * \param size required size
    *
-   * \return true on success, false otherwise (new size is too large)
+   * \return true on success, false otherwise (size is too large)
    */
-  bool setBufferSize(const industrial::shared_types::shared_int size);
+  bool reserve(const industrial::shared_types::shared_int size);
 
   /**
-   * \brief extends current buffer size
+   * \brief sets current buffer size
    *
-   * \param number of bytes to extend
+   * \param size new size
    *
    * \return true on success, false otherwise (new size is too large)
    */
-  bool extendBufferSize(const industrial::shared_types::shared_int size);
+  bool setBufferSize(const industrial::shared_types::shared_int size);
 
   /**
    * \brief shortens current buffer size
@@ -408,6 +529,149 @@ private:
 
 };
 
+/**
+ * \brief The byte array reader unloads data from a byte array in the forward
+ * direction (i.e. in the same order it was loaded).
+ *
+ * Unlike the byte array unload methods, the underlying data is never modified
+ * or moved (the buffer is not shortened), a read position is simply advanced.
+ * This allows a message to be decoded in place, in a single linear pass.  The
+ * reader does not own the data.  The data must remain valid (and unmodified)
+ * while the reader is in use.
+ *
+ * THIS CLASS IS NOT THREAD-SAFE
+ *
+ */
+class ByteArrayReader
+{
+public:
+
+  /**
+   * \brief Default constructor
+   *
+   * This method creates an empty reader.
+   *
+   */
+  ByteArrayReader(void);
+
+  /**
+   * \brief Constructor
+   *
+   * This method creates a reader for the entire byte array
+   *
+   * \param buffer byte array to read
+   *
+   */
+  ByteArrayReader(ByteArray & buffer);
+
+  /**
+   * \brief Destructor
+   *
+   */
+  ~ByteArrayReader(void);
+
+  /**
+   * \brief initializes the reader for the entire byte array
+   *
+   * \param buffer byte array to read
+   */
+  void init(ByteArray & buffer);
+
+  /**
+   * \brief initializes the reader for a char* buffer
+   *
+   * \param buffer pointer to byte buffer
+   * \param byte_size size of buffer
+   */
+  void init(const char* buffer, const industrial::shared_types::shared_int byte_size);
+
+  /**
+   * \brief unloads a boolean value from the reader
+   *
+   * \param value value to unload
+   *
+   * \return true on success, false otherwise (not enough data remains)
+   */
+  bool unload(industrial::shared_types::shared_bool &value);
+
+  /**
+   * \brief unloads a double value from the reader. If byte swapping is
+   * enabled, then the bytes are swapped.
+   *
+   * \param value value to unload
+   *
+   * \return true on success, false otherwise (not enough data remains)
+   */
+  bool unload(industrial::shared_types::shared_real &value);
+
+  /**
+   * \brief unloads an integer value from the reader.  If byte swapping is
+   * enabled, then the bytes are swapped.
+   *
+   * \param value value to unload
+   *
+   * \return true on success, false otherwise (not enough data remains)
+   */
+  bool unload(industrial::shared_types::shared_int &value);
+
+  /**
+   * \brief unloads a complex SimpleSerialize value from the reader
+   *
+   * \param value value to unload
+   *
+   * \return true on success, false otherwise (not enough data remains)
+   */
+  bool unload(industrial::simple_serialize::SimpleSerialize &value);
+
+  /**
+   * \brief unloads (copies) data from the reader into the passed in byte array
+   * (this is done using the byte array load method so any data in the passed
+   * in byte array remains intact)
+   *
+   * \param value value to unload
+   * \param byte_size number of bytes to unload
+   *
+   * \return true on success, false otherwise (not enough data remains)
+   */
+  bool unload(ByteArray &value, const industrial::shared_types::shared_int byte_size);
+
+  /**
+   * \brief unloads a void* (treated as char*) from the reader.
+   * WARNING: Byte swapping is not performed in this function.
+   *
+   * \param value to unload
+   * \param byte_size number of bytes to unload
+   *
+   * \return true on success, false otherwise (not enough data remains)
+   */
+  bool unload(void* value, const industrial::shared_types::shared_int byte_size);
+
+  /**
+   * \brief gets the number of bytes remaining to be read
+   *
+   * \return remaining size
+   */
+  unsigned int getRemainSize();
+
+private:
+
+  /**
+   * \brief data being read (not owned by the reader)
+   */
+  const char* buffer_;
+
+  /**
+   * \brief size of data being read
+   */
+  industrial::shared_types::shared_int buffer_size_;
+
+  /**
+   * \brief current read position (offset from beginning of buffer)
+   */
+  industrial::shared_types::shared_int read_pos_;
+
+};
+
 } // namespace industrial
 } // namespace byte_array
 
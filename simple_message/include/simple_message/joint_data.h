@@ -52,13 +52,19 @@ namespace joint_data
  * torque, and/or effort).
  *
  * For simplicity and cross platform compliance, this is implemented as a
- * fixed size array.
+ * fixed size array.  Only the active joints (see setNumJoints()) are
+ * serialized.  By default the number of joints is 10, which matches the
+ * legacy (fixed 10 joint) message layout.  Robots with fewer joints can
+ * reduce the number of joints for a compact message layout, robots with more
+ * joints (up to the array size) can increase it.  The number of joints is not
+ * part of the byte representation; the typed messages determine it from the
+ * message data length.
  *
  * The byte representation of a joint data is as follows. The standard sizes
  * are given, but can change based on type sizes:
  *
  *   member:             type                                      size
- *   joints              (industrial::shared_types::shared_real)   4 * MAX_NUM_JOINTS
+ *   joints              (industrial::shared_types::shared_real)   4 * number of joints
  *
  *
  * THIS CLASS IS NOT THREAD-SAFE
@@ -82,11 +88,21 @@ public:
   ~JointData(void);
 
   /**
-   * \brief Initializes a empty joint data
+   * \brief Initializes a empty joint data (all joint values are zero, the
+   * number of joints is unchanged)
    *
    */
   void init();
 
+  /**
+   * \brief Sets the number of (active) joints.  Joint values are retained.
+   *
+   * \param number of joints
+   *
+   * \return true if number set, otherwise false (number greater than max)
+   */
+  bool setNumJoints(industrial::shared_types::shared_int num_joints);
+
   /**
    * \brief Sets a joint value within the buffer
    *
@@ -125,11 +141,36 @@ public:
   void copyFrom(JointData &src);
 
   /**
-   * \brief returns the maximum number of joints the message holds
+   * \brief returns the maximum number of joints the message holds (i.e. the
+   * number of joints, see setNumJoints())
    *
    * \return max number of joints
    */
   int getMaxNumJoints() const
+  {
+    return this->num_joints_;
+  }
+
+  /**
+   * \brief Determines the number of joints from the byte length of a
+   * structure that holds joint data (i.e. a message data portion).
+   *
+   * \param byte_length byte length of the structure
+   * \param fixed_length byte length of the structure members that are not joint data
+   * \param num_data number of joint data members (i.e. positions, velocities...)
+   * \param num_joints number of joints (passed by reference)
+   *
+   * \return true if the length matches a valid number of joints, otherwise false
+   */
+  static bool numJointsFromLength(unsigned int byte_length, unsigned int fixed_length,
+                                  unsigned int num_data, industrial::shared_types::shared_int & num_joints);
+
+  /**
+   * \brief returns the number of joints that can be set (see setNumJoints())
+   *
+   * \return joint capacity
+   */
+  static int getJointCapacity()
   {
     return MAX_NUM_JOINTS;
   }
@@ -144,9 +185,10 @@ public:
   // Overrides - SimpleSerialize
   bool load(industrial::byte_array::ByteArray *buffer);
   bool unload(industrial::byte_array::ByteArray *buffer);
+  bool unload(industrial::byte_array::ByteArrayReader *buffer);
   unsigned int byteLength()
   {
-    return MAX_NUM_JOINTS * sizeof(industrial::shared_types::shared_real);
+    return this->num_joints_ * sizeof(industrial::shared_types::shared_real);
   }
 
 private:
@@ -154,11 +196,19 @@ private:
   /**
    * \brief maximum number of joints positions that can be held in the message.
    */
-  static const industrial::shared_types::shared_int MAX_NUM_JOINTS = 10;
+  static const industrial::shared_types::shared_int MAX_NUM_JOINTS = 16;
+  /**
+   * \brief default number of joints (legacy message layout).
+   */
+  static const industrial::shared_types::shared_int DEFAULT_NUM_JOINTS = 10;
   /**
    * \brief internal data buffer
    */
   industrial::shared_types::shared_real joints_[MAX_NUM_JOINTS];
+  /**
+   * \brief number of (active) joints
+   */
+  industrial::shared_types::shared_int num_joints_;
 
 };
 
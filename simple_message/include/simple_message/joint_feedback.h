@@ -264,6 +264,28 @@ public:
   }
 
 
+  /**
+   * \brief Sets the number of joints of the position, velocity and
+   * acceleration data (see JointData::setNumJoints()).  All joint data is
+   * serialized with the number of joints of the positions.
+   *
+   * \param number of joints
+   *
+   * \return true if number set, otherwise false (number greater than max)
+   */
+  bool setNumJoints(industrial::shared_types::shared_int num_joints);
+
+  /**
+   * \brief Sets the number of joints from the byte length of the feedback (see
+   * JointData::numJointsFromLength()).  This is used to unload feedback of any
+   * number of joints.
+   *
+   * \param byte_length byte length of the (serialized) point
+   *
+   * \return true if number set, otherwise false (length does not match a number of joints)
+   */
+  bool setNumJointsFromLength(unsigned int byte_length);
+
   /**
    * \brief Copies the passed in value
    *
@@ -291,6 +313,7 @@ public:
   // Overrides - SimpleSerialize
   bool load(industrial::byte_array::ByteArray *buffer);
   bool unload(industrial::byte_array::ByteArray *buffer);
+  bool unload(industrial::byte_array::ByteArrayReader *buffer);
   unsigned int byteLength()
   {
     return 2*sizeof(industrial::shared_types::shared_int) + sizeof(industrial::shared_types::shared_real)
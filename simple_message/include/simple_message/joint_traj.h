@@ -56,9 +56,12 @@ namespace joint_traj
  * an array of JointTrajPt data types.  The intention for this class is to
  * be loaded into a single message for communication over a simple connection.
  *
- * For simplicity and cross platform compliance, this is implemented as a
- * fixed size array.  The size of the trajectory cannot exceed the max size
- * of the array.
+ * The points are held in contiguous storage that grows with the trajectory,
+ * so that an empty (or short) trajectory is cheap to construct and copy.  The
+ * size of the trajectory cannot exceed the number of points that fit in a
+ * single message (see getMaxNumPoints()).  For systems that don't support
+ * dynamic memory allocation, FIXED_SIZE_BUFFERS is defined and a fixed size
+ * array is used instead.
  */
 //* JointTraj
 /**
@@ -77,6 +80,12 @@ public:
 	 *
 	 */
 	JointTraj(void);
+	/**
+	 * \brief Copy constructor (deep copy, only the trajectory points are copied)
+	 *
+	 * \param src trajectory to copy
+	 */
+	JointTraj(const JointTraj &src);
 	/**
 	 * \brief Destructor
 	 *
@@ -84,7 +93,17 @@ public:
 	~JointTraj(void);
 
 	/**
-	 * \brief Initializes a empty joint data
+	 * \brief Assignment operator (deep copy, see copy constructor)
+	 *
+	 * \param rhs trajectory to copy
+	 *
+	 * \return reference to this trajectory
+	 */
+	JointTraj & operator=(const JointTraj &rhs);
+
+	/**
+	 * \brief Initializes a empty joint data.  Any allocated storage is kept
+	 * (for reuse).
 	 *
 	 */
 	void init();
@@ -129,13 +148,35 @@ public:
 	}
 
 	/**
-	 * \brief returns the maximum number of points the message holds
+	 * \brief returns the maximum number of points the message holds.  This is
+	 * limited by the max message size (which depends on the shared type sizes)
+	 * and, for FIXED_SIZE_BUFFERS, the internal array.
 	 *
 	 * \return max number of points
 	 */
-	int getMaxNumPoints() const
+	int getMaxNumPoints() const;
+
+	/**
+	 * \brief Sets the number of joints of the trajectory points (see
+	 * JointData::setNumJoints()).  All points of a trajectory have the same
+	 * number of joints.  The number of joints is set by the first point added,
+	 * it must be set before unloading trajectories that don't have the default
+	 * number of joints.
+	 *
+	 * \param number of joints
+	 *
+	 * \return true if number set, otherwise false (number greater than max)
+	 */
+	bool setNumJoints(industrial::shared_types::shared_int num_joints);
+
+	/**
+	 * \brief Returns the number of joints of the trajectory points
+	 *
+	 * \return number of joints
+	 */
+	industrial::shared_types::shared_int getNumJoints() const
 	{
-		return MAX_NUM_POINTS;
+		return this->num_joints_;
 	}
 
 	/**
@@ -155,14 +196,17 @@ public:
 	// Overrides - SimpleSerialize
 	bool load(industrial::byte_array::ByteArray *buffer);
 	bool unload(industrial::byte_array::ByteArray *buffer);
+	bool unload(industrial::byte_array::ByteArrayReader *buffer);
 	unsigned int byteLength()
 	{
 		industrial::joint_traj_pt::JointTrajPt pt;
-		return this->size() * pt.byteLength();
+		pt.setNumJoints(this->num_joints_);
+		return this->size() * pt.byteLength() + sizeof(industrial::shared_types::shared_int);
 	}
 
 private:
 
+#ifdef FIXED_SIZE_BUFFERS
 	/**
 	 * \brief maximum number of joints positions that can be held in the message.
 	 */
@@ -171,10 +215,45 @@ private:
 	 * \brief internal data buffer
 	 */
 	industrial::joint_traj_pt::JointTrajPt points_[MAX_NUM_POINTS];
+#else
+	/**
+	 * \brief internal data buffer (dynamically allocated, NULL if empty)
+	 */
+	industrial::joint_traj_pt::JointTrajPt* points_;
+	/**
+	 * \brief current capacity (in points) of the internal data buffer
+	 */
+	industrial::shared_types::shared_int capacity_;
+#endif
 	/**
 	 * \brief size of trajectory
 	 */
 	industrial::shared_types::shared_int size_;
+	/**
+	 * \brief number of joints of the trajectory points
+	 */
+	industrial::shared_types::shared_int num_joints_;
+
+	/**
+	 * \brief Ensures the internal data buffer can hold the requested number of
+	 * points (existing points are preserved).
+	 *
+	 * \param size number of points
+	 *
+	 * \return true on success, false otherwise (larger than max or allocation failed)
+	 */
+	bool reserve(industrial::shared_types::shared_int size);
+
+	/**
+	 * \brief Unloads points (in order) from the reader directly into the
+	 * internal data buffer.
+	 *
+	 * \param buffer reader to unload from
+	 * \param size number of points to unload
+	 *
+	 * \return true on success, false otherwise (not enough data or too many points)
+	 */
+	bool unloadPoints(industrial::byte_array::ByteArrayReader *buffer, industrial::shared_types::shared_int size);
 
 };
 
@@ -0,0 +1,228 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2013, Southwest Research Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 	* Redistributions of source code must retain the above copyright
+ * 	notice, this list of conditions and the following disclaimer.
+ * 	* Redistributions in binary form must reproduce the above copyright
+ * 	notice, this list of conditions and the following disclaimer in the
+ * 	documentation and/or other materials provided with the distribution.
+ * 	* Neither the name of the Southwest Research Institute, nor the names
+ *	of its contributors may be used to endorse or promote products derived
+ *	from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JOINT_TRAJ_FULL_H
+#define JOINT_TRAJ_FULL_H
+
+#ifndef FLATHEADERS
+#include "simple_message/simple_message.h"
+#include "simple_message/simple_serialize.h"
+#include "simple_message/shared_types.h"
+#include "simple_message/joint_traj_pt_full.h"
+#else
+#include "simple_message.h"
+#include "simple_serialize.h"
+#include "shared_types.h"
+#include "joint_traj_pt_full.h"
+#endif
+
+
+namespace industrial
+{
+namespace joint_traj_full
+{
+
+/**
+ * \brief Class encapsulated joint trajectory.  A joint trajectory includes
+ * an array of JointTrajPtFull data types.  The intention for this class is to
+ * be loaded into a single message for communication over a simple connection,
+ * so that a complete trajectory (or large portions of a trajectory) can be
+ * downloaded with a few messages.  The size of the trajectory cannot exceed
+ * the max number of points (see getMaxNumPoints()), larger trajectories must be
+ * sent in portions.
+ *
+ * The message data-packet byte representation is as follows (ordered lowest index
+ * to highest), this matches JointTraj:
+ *
+ *   member:             type                                      size
+ *   points              (industrial::joint_traj_pt_full)          size * JointTrajPtFull
+ *   size                (industrial::shared_types::shared_int)    4  bytes
+ *
+ *
+ * THIS CLASS IS NOT THREAD-SAFE
+ *
+ */
+
+class JointTrajFull : public industrial::simple_serialize::SimpleSerialize
+{
+public:
+  /**
+   * \brief Default constructor
+   *
+   * This method creates empty data.
+   *
+   */
+  JointTrajFull(void);
+  /**
+   * \brief Destructor
+   *
+   */
+  ~JointTrajFull(void);
+
+  /**
+   * \brief Initializes a empty joint trajectory
+   *
+   */
+  void init();
+
+  /**
+   * \brief Adds a point value to the end of the buffer
+   *
+   * \param point value
+   *
+   * \return true if value set, otherwise false (buffer is full)
+   */
+  bool addPoint(industrial::joint_traj_pt_full::JointTrajPtFull & point);
+
+  /**
+   * \brief Gets a point value within the buffer
+   *
+   * \param point index
+   * \param point value
+   *
+   * \return true if value set, otherwise false (index greater than size)
+   */
+  bool getPoint(industrial::shared_types::shared_int index,
+                industrial::joint_traj_pt_full::JointTrajPtFull & point);
+
+  /**
+   * \brief Gets a size of trajectory
+   *
+   * \return trajectory size
+   */
+  industrial::shared_types::shared_int size()
+  {
+    return this->size_;
+  }
+
+  /**
+   * \brief returns True if buffer is full
+   *
+   * \return true if buffer is full
+   */
+  bool isFull()
+  {
+    return this->size_ >= this->getMaxNumPoints();
+  }
+
+  /**
+   * \brief returns the maximum number of points the message holds.  This is
+   * limited by the internal buffer and the max message size (which depends on
+   * the shared type sizes).
+   *
+   * \return max number of points
+   */
+  industrial::shared_types::shared_int getMaxNumPoints();
+
+  /**
+   * \brief Sets the number of joints of the trajectory points (see
+   * JointData::setNumJoints()).  All points of a trajectory have the same
+   * number of joints.  The number of joints is set by the first point added,
+   * it must be set before unloading trajectories that don't have the default
+   * number of joints.
+   *
+   * \param number of joints
+   *
+   * \return true if number set, otherwise false (number greater than max)
+   */
+  bool setNumJoints(industrial::shared_types::shared_int num_joints);
+
+  /**
+   * \brief Returns the number of joints of the trajectory points
+   *
+   * \return number of joints
+   */
+  industrial::shared_types::shared_int getNumJoints() const
+  {
+    return this->num_joints_;
+  }
+
+  /**
+   * \brief Copies the passed in value
+   *
+   * \param src (value to copy)
+   */
+  void copyFrom(JointTrajFull &src);
+
+  /**
+   * \brief == operator implementation
+   *
+   * \return true if equal
+   */
+  bool operator==(JointTrajFull &rhs);
+
+  // Overrides - SimpleSerialize
+  bool load(industrial::byte_array::ByteArray *buffer);
+  bool unload(industrial::byte_array::ByteArray *buffer);
+  bool unload(industrial::byte_array::ByteArrayReader *buffer);
+  unsigned int byteLength()
+  {
+    industrial::joint_traj_pt_full::JointTrajPtFull pt;
+    pt.setNumJoints(this->num_joints_);
+    return this->size() * pt.byteLength() + sizeof(industrial::shared_types::shared_int);
+  }
+
+private:
+
+  /**
+   * \brief maximum number of points that can be held in the internal buffer.
+   */
+  static const industrial::shared_types::shared_int MAX_NUM_POINTS = 100;
+  /**
+   * \brief internal data buffer
+   */
+  industrial::joint_traj_pt_full::JointTrajPtFull points_[MAX_NUM_POINTS];
+  /**
+   * \brief size of trajectory
+   */
+  industrial::shared_types::shared_int size_;
+  /**
+   * \brief number of joints of the trajectory points
+   */
+  industrial::shared_types::shared_int num_joints_;
+
+  /**
+   * \brief Unloads points (in order) from the reader directly into the
+   * internal data buffer.
+   *
+   * \param buffer reader to unload from
+   * \param size number of points to unload
+   *
+   * \return true on success, false otherwise (not enough data or too many points)
+   */
+  bool unloadPoints(industrial::byte_array::ByteArrayReader *buffer, industrial::shared_types::shared_int size);
+
+};
+
+}
+}
+
+#endif /* JOINT_TRAJ_FULL_H */
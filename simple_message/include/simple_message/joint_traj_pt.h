@@ -194,6 +194,36 @@ public:
       return this->duration_;
     }
 
+  /**
+   * \brief Sets the number of joints (see JointData::setNumJoints())
+   *
+   * \param number of joints
+   *
+   * \return true if number set, otherwise false (number greater than max)
+   */
+  bool setNumJoints(industrial::shared_types::shared_int num_joints);
+
+  /**
+   * \brief Returns the number of joints
+   *
+   * \return number of joints
+   */
+  industrial::shared_types::shared_int getNumJoints() const
+  {
+    return this->joint_position_.getMaxNumJoints();
+  }
+
+  /**
+   * \brief Sets the number of joints from the byte length of the point (see
+   * JointData::numJointsFromLength()).  This is used to unload points of any
+   * number of joints.
+   *
+   * \param byte_length byte length of the (serialized) point
+   *
+   * \return true if number set, otherwise false (length does not match a number of joints)
+   */
+  bool setNumJointsFromLength(unsigned int byte_length);
+
   /**
    * \brief Copies the passed in value
    *
@@ -211,9 +241,10 @@ public:
   // Overrides - SimpleSerialize
   bool load(industrial::byte_array::ByteArray *buffer);
   bool unload(industrial::byte_array::ByteArray *buffer);
+  bool unload(industrial::byte_array::ByteArrayReader *buffer);
   unsigned int byteLength()
   {
-    return sizeof(industrial::shared_types::shared_real) + sizeof(industrial::shared_types::shared_int)
+    return 2*sizeof(industrial::shared_types::shared_real) + sizeof(industrial::shared_types::shared_int)
         + this->joint_position_.byteLength();
   }
 
@@ -67,6 +67,13 @@ namespace message_manager
  * the server application must make certain to execute the spinOnce() function at a
  * minimum rate so as not to loose connection data.
  *
+ * Handlers are held in a hash table (open addressing, keyed by message type), so
+ * that the cost of finding the handler for a received message does not depend on
+ * the number of handlers or the message type values (i.e. vendor specific message
+ * types).  The table grows as handlers are added.  For systems that don't support
+ * dynamic memory allocation, FIXED_SIZE_BUFFERS is defined and a fixed size table
+ * (and max number of handlers) is used instead.
+ *
  * THIS CLASS IS NOT THREAD-SAFE
  *
  */
@@ -129,7 +136,8 @@ public:
    * \param handler handler to add
    * \param replace existing handler (of same msg-type), if exists
    *
-   * \return true if successful, otherwise false (max # of handlers reached)
+   * \return true if successful, otherwise false (max # of handlers reached or
+   * handler exists and replace is not allowed)
    */
   bool add(industrial::message_handler::MessageHandler* handler, bool allow_replace = false);
 
@@ -154,6 +162,16 @@ public:
   }
 
 
+  /**
+   * \brief Gets connection for manager
+   *
+   * \return connection reference
+   */
+  industrial::smpl_msg_connection::SmplMsgConnection* getConnection()
+  {
+    return this->connection_;
+  }
+
   /**
    * \brief Gets communications fault handler
    *
@@ -177,6 +195,12 @@ public:
 
 private:
 
+  /**
+   * \brief Time (ms) spin() waits for a re-connection, before receiving again
+   */
+  static const int CONNECT_WAIT = 1000;
+
+#ifdef FIXED_SIZE_BUFFERS
   /**
    * \brief Maximum number of handlers
    *
@@ -186,9 +210,37 @@ private:
   static const unsigned int MAX_NUM_HANDLERS = 64;
 
   /**
-   * \brief buffer of handlers
+   * \brief Size of the handler table (a power of 2, at least twice the max
+   * number of handlers to keep lookups short)
+   */
+  static const unsigned int TABLE_SIZE = 2 * MAX_NUM_HANDLERS;
+
+  /**
+   * \brief handler table (indexed by message type hash, unused entries are NULL)
+   */
+  industrial::message_handler::MessageHandler* handlers_[TABLE_SIZE];
+#else
+  /**
+   * \brief Maximum number of handlers (limited by the message type range only)
+   */
+  static const unsigned int MAX_NUM_HANDLERS = 0x10000;
+
+  /**
+   * \brief Initial size of the handler table (a power of 2)
    */
-  industrial::message_handler::MessageHandler* handlers_[MAX_NUM_HANDLERS];
+  static const unsigned int TABLE_SIZE = 16;
+
+  /**
+   * \brief handler table (indexed by message type hash, unused entries are NULL)
+   */
+  industrial::message_handler::MessageHandler** handlers_;
+
+  /**
+   * \brief current size of the handler table (a power of 2, kept at least
+   * twice the number of handlers)
+   */
+  unsigned int table_size_;
+#endif
 
   /**
    * \brief Reference to reply connection (called if incoming message requires a reply)
@@ -234,6 +286,41 @@ private:
    */
   int getHandlerIdx(int msg_type);
 
+  /**
+   * \brief Gets the handler table index for a message type, this is either
+   * the index of the matching handler or the (empty) index where a handler for
+   * the message type should be added.
+   *
+   * \param msg_type message type
+   *
+   * \return table index
+   */
+  unsigned int getTableIdx(int msg_type);
+
+  /**
+   * \brief Gets the size of the handler table
+   *
+   * \return table size
+   */
+  unsigned int getTableSize()
+  {
+#ifdef FIXED_SIZE_BUFFERS
+    return this->TABLE_SIZE;
+#else
+    return this->table_size_;
+#endif
+  }
+
+  /**
+   * \brief Ensures the handler table can hold the requested number of
+   * handlers (the table is rebuilt when it grows).
+   *
+   * \param num_handlers number of handlers
+   *
+   * \return true on success, false otherwise (larger than max or allocation failed)
+   */
+  bool reserve(unsigned int num_handlers);
+
   /**
    * \brief Gets default communications fault handler
    *
@@ -265,17 +352,6 @@ private:
   }
   ;
 
-  /**
-   * \brief Gets connection for manager
-   *
-   * \return connection reference
-   */
-  industrial::smpl_msg_connection::SmplMsgConnection* getConnection()
-  {
-    return this->connection_;
-  }
-  ;
-
   /**
    * \brief Sets message type that callback expects
    *
@@ -0,0 +1,289 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2013, Southwest Research Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 	* Redistributions of source code must retain the above copyright
+ * 	notice, this list of conditions and the following disclaimer.
+ * 	* Redistributions in binary form must reproduce the above copyright
+ * 	notice, this list of conditions and the following disclaimer in the
+ * 	documentation and/or other materials provided with the distribution.
+ * 	* Neither the name of the Southwest Research Institute, nor the names
+ *	of its contributors may be used to endorse or promote products derived
+ *	from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MESSAGE_REACTOR_H
+#define MESSAGE_REACTOR_H
+
+#ifndef FLATHEADERS
+#include "simple_message/message_manager.h"
+#include "simple_message/socket/simple_socket.h"
+#else
+#include "message_manager.h"
+#include "simple_socket.h"
+#endif
+
+#ifdef LINUXSOCKETS
+
+namespace industrial
+{
+namespace message_server
+{
+class MessageServer;
+}
+
+namespace message_reactor
+{
+
+/**
+ * \brief The message reactor services many message managers (and their
+ * connections) from a single thread.
+ */
+//* MessageReactor
+/**
+ * The message reactor waits (epoll) for any of its managed connections to
+ * become ready, receives the available data (see
+ * SimpleSocket::receiveAvailable) and then executes spinOnce() of the
+ * matching message manager, once for each complete message received (see
+ * SimpleSocket::isMsgBuffered), so that message handlers are executed as for
+ * a manager that runs its own spin() loop.  Partial messages are kept until
+ * the rest arrives, a peer that stops sending mid-message doesn't block the
+ * other connections.  Connections are put in non-blocking mode when they are
+ * registered (see SimpleSocket::setNonBlocking).
+ *
+ * Communication faults are handled per connection, by the fault handler of
+ * each manager (see MessageManager::getCommsFaultHandler()).  A disconnected
+ * connection is removed from the wait set and its connection fail callback is
+ * executed (at most once per reconnect period) until it reconnects.  The
+ * default fault handler (SimpleCommsFaultHandler) reconnects with
+ * SmplMsgConnection::pollConnect.  A non-blocking connect in progress (see
+ * TcpClient) is waited for in the wait set, so that it completes without
+ * delaying other connections.  NOTE: Connections that don't support
+ * non-blocking connects reconnect with a blocking call, other connections are
+ * not serviced while it blocks.
+ *
+ * Multi-client servers (see MessageServer) may also be added, clients are
+ * accepted by the reactor as they connect and each client session is managed
+ * like any other connection.
+ *
+ * Managed connections must be sockets (see SimpleSocket).  The reactor is only
+ * available on Linux (LINUXSOCKETS).  Additional threads may each run their own
+ * reactor (with a disjoint set of managers).
+ *
+ * THIS CLASS IS NOT THREAD-SAFE
+ *
+ */
+class MessageReactor
+{
+
+public:
+
+  /**
+   * \brief Constructor
+   */
+  MessageReactor();
+
+  /**
+   * \brief Destructor
+   */
+  ~MessageReactor();
+
+  /**
+   * \brief Class initializer
+   *
+   * \return true on success, false otherwise
+   */
+  bool init();
+
+  /**
+   * \brief Adds a message manager to the reactor.  The manager must be
+   * initialized (see MessageManager::init()) with a socket connection.
+   *
+   * \param manager manager to add
+   *
+   * \return true if successful, otherwise false (max # of managers reached,
+   * manager already added or connection is not a socket)
+   */
+  bool add(industrial::message_manager::MessageManager* manager);
+
+  /**
+   * \brief Removes a message manager from the reactor
+   *
+   * \param manager manager to remove
+   *
+   * \return true if successful, otherwise false (manager not found)
+   */
+  bool remove(industrial::message_manager::MessageManager* manager);
+
+  /**
+   * \brief Adds a multi-client server to the reactor (see MessageServer::init)
+   *
+   * \param server server to add
+   *
+   * \return true if successful, otherwise false (max # of servers reached or
+   * server already added)
+   */
+  bool addServer(industrial::message_server::MessageServer* server);
+
+  /**
+   * \brief Removes a multi-client server from the reactor.  The server's
+   * sessions are not removed (see MessageServer::closeSession).
+   *
+   * \param server server to remove
+   *
+   * \return true if successful, otherwise false (server not found)
+   */
+  bool removeServer(industrial::message_server::MessageServer* server);
+
+  /**
+   * \brief Perform a single execution of the reactor: reconnects disconnected
+   * connections (if required), waits for connections to become ready and
+   * executes a spinOnce() of each ready manager (for each complete message
+   * received).
+   *
+   * \param timeout (ms) to wait for a ready connection, negative values
+   * result in blocking
+   *
+   * \return number of manager spinOnce() calls executed, -1 on error
+   */
+  int spinOnce(int timeout);
+
+  /**
+   * \brief Perform a indefinite execution of the reactor
+   */
+  void spin();
+
+  /**
+   * \brief Gets number of managers
+   *
+   * \return number of managers
+   */
+  unsigned int getNumManagers()
+  {
+    return this->num_managers_;
+  }
+
+  /**
+   * \brief Gets maximum number of managers
+   *
+   * \return max number of managers
+   */
+  unsigned int getMaxNumManagers()
+  {
+    return this->MAX_NUM_MANAGERS;
+  }
+
+  /**
+   * \brief Sets the minimum period between reconnect attempts (i.e. calls to
+   * connectionFailCB) of a disconnected connection.
+   *
+   * \param period reconnect period (ms)
+   */
+  void setReconnectPeriod(int period)
+  {
+    this->reconnect_period_ = period;
+  }
+
+private:
+
+  /**
+   * \brief A managed connection (a slot is unused if the manager is NULL)
+   */
+  struct Managed
+  {
+    industrial::message_manager::MessageManager* manager;
+    industrial::simple_socket::SimpleSocket* connection;
+    int sock_handle;          // registered socket handle, -1 if not registered
+    unsigned int events;      // registered events (EPOLLIN, or EPOLLOUT while connecting)
+    unsigned int last_connect;  // time (ms) of last reconnect attempt (see SimpleSocket::getTimeMs)
+  };
+
+  /**
+   * \brief Maximum number of managers
+   */
+  static const unsigned int MAX_NUM_MANAGERS = 64;
+
+  /**
+   * \brief Maximum number of servers
+   */
+  static const unsigned int MAX_NUM_SERVERS = 8;
+
+  /**
+   * \brief Default reconnect period (ms)
+   */
+  static const int DEFAULT_RECONNECT_PERIOD = 100;
+
+  /**
+   * \brief spin() wait timeout (ms)
+   */
+  static const int SPIN_TIMEOUT = 1000;
+
+  /**
+   * \brief Managed connections
+   */
+  Managed managed_[MAX_NUM_MANAGERS];
+
+  /**
+   * \brief Number of managers
+   */
+  unsigned int num_managers_;
+
+  /**
+   * \brief Servers (waited for with index MAX_NUM_MANAGERS + server index,
+   * unused entries are NULL)
+   */
+  industrial::message_server::MessageServer* servers_[MAX_NUM_SERVERS];
+
+  /**
+   * \brief epoll handle, -1 if not initialized
+   */
+  int epoll_handle_;
+
+  /**
+   * \brief Reconnect period (ms)
+   */
+  int reconnect_period_;
+
+  /**
+   * \brief Registers (or re-registers, if the socket handle or events have
+   * changed) a connected (or connecting) socket
+   *
+   * \param idx managed connection index
+   * \param events events to wait for
+   *
+   * \return true on success, false otherwise
+   */
+  bool registerSocket(unsigned int idx, unsigned int events);
+
+  /**
+   * \brief Removes a socket from the wait set (if registered)
+   *
+   * \param idx managed connection index
+   */
+  void unregisterSocket(unsigned int idx);
+
+};
+
+} // namespace message_reactor
+} // namespace industrial
+
+#endif //LINUXSOCKETS
+
+#endif //MESSAGE_REACTOR_H
@@ -0,0 +1,265 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2013, Southwest Research Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 	* Redistributions of source code must retain the above copyright
+ * 	notice, this list of conditions and the following disclaimer.
+ * 	* Redistributions in binary form must reproduce the above copyright
+ * 	notice, this list of conditions and the following disclaimer in the
+ * 	documentation and/or other materials provided with the distribution.
+ * 	* Neither the name of the Southwest Research Institute, nor the names
+ *	of its contributors may be used to endorse or promote products derived
+ *	from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MESSAGE_SERVER_H
+#define MESSAGE_SERVER_H
+
+#ifndef FLATHEADERS
+#include "simple_message/message_manager.h"
+#include "simple_message/comms_fault_handler.h"
+#include "simple_message/socket/tcp_server.h"
+#else
+#include "message_manager.h"
+#include "comms_fault_handler.h"
+#include "tcp_server.h"
+#endif
+
+#ifdef LINUXSOCKETS
+
+namespace industrial
+{
+namespace message_reactor
+{
+class MessageReactor;
+}
+
+namespace message_server
+{
+
+class MessageServer;
+
+/**
+ * \brief Communications fault handler of a message server session.  A lost
+ * connection closes the session (clients are expected to reconnect).
+ */
+class SessionFaultHandler : public industrial::comms_fault_handler::CommsFaultHandler
+{
+public:
+
+  /**
+   * \brief Constructor
+   */
+  SessionFaultHandler();
+
+  /**
+   * \brief Class initializer
+   *
+   * \param server server that owns the session
+   * \param idx session index
+   */
+  void init(MessageServer* server, unsigned int idx);
+
+  void sendFailCB();
+  void receiveFailCB();
+  void connectionFailCB();
+
+private:
+
+  MessageServer* server_;
+  unsigned int idx_;
+};
+
+/**
+ * \brief The message server serves many concurrent clients on a single port.
+ */
+//* MessageServer
+/**
+ * Each accepted client is served by a session: a connection (see
+ * TcpServer::acceptClient) with its own receive buffer and message manager.
+ * Sessions are driven by a message reactor, which also waits for (and
+ * accepts) new clients, so that a single thread serves all clients (along
+ * with any other connections of the reactor).  Session handlers are only
+ * executed for complete messages (see MessageReactor), a client that stops
+ * sending mid-message holds its own session but doesn't delay the others.
+ *
+ * The number of sessions is fixed (clients are rejected when all sessions
+ * are in use), in order to avoid dynamic memory allocation.  Message handlers
+ * are added to the manager of each session (see getManager) and must send
+ * replies on the session connection (see MessageManager::getConnection), i.e.
+ * each session has its own handler instances.  Handlers are kept when a
+ * session closes and are reused by the next client of the session.
+ *
+ * Example:
+ *
+ *   MessageReactor reactor;
+ *   MessageServer server;
+ *   MyHandler handlers[MessageServer::MAX_NUM_SESSIONS];
+ *
+ *   reactor.init();
+ *   server.init(port, &reactor);
+ *   for (unsigned int i = 0; i < server.getMaxNumSessions(); i++)
+ *   {
+ *     handlers[i].init(MY_MSG_TYPE, server.getManager(i)->getConnection());
+ *     server.getManager(i)->add(&handlers[i]);
+ *   }
+ *   reactor.spin();
+ *
+ * The server is only available on Linux (LINUXSOCKETS).
+ *
+ * THIS CLASS IS NOT THREAD-SAFE
+ *
+ */
+class MessageServer
+{
+
+public:
+
+  /**
+   * \brief Maximum number of sessions (concurrent clients)
+   */
+  static const unsigned int MAX_NUM_SESSIONS = 16;
+
+  /**
+   * \brief Constructor
+   */
+  MessageServer();
+
+  /**
+   * \brief Destructor
+   */
+  ~MessageServer();
+
+  /**
+   * \brief Class initializer.  Listens for clients and adds the server to
+   * the reactor (see MessageReactor::addServer).
+   *
+   * \param port_num port number
+   * \param reactor reactor that drives the server (ALREADY INITIALIZED)
+   *
+   * \return true on success, false otherwise
+   */
+  bool init(int port_num, industrial::message_reactor::MessageReactor* reactor);
+
+  /**
+   * \brief Gets the message manager of a session
+   *
+   * \param idx session index
+   *
+   * \return message manager, NULL if the index is invalid
+   */
+  industrial::message_manager::MessageManager* getManager(unsigned int idx);
+
+  /**
+   * \brief returns true if a client is connected to the session
+   *
+   * \param idx session index
+   *
+   * \return true if session is active
+   */
+  bool isSessionActive(unsigned int idx);
+
+  /**
+   * \brief Gets number of active sessions (connected clients)
+   *
+   * \return number of sessions
+   */
+  unsigned int getNumSessions()
+  {
+    return this->num_sessions_;
+  }
+
+  /**
+   * \brief Gets maximum number of sessions
+   *
+   * \return max number of sessions
+   */
+  unsigned int getMaxNumSessions()
+  {
+    return this->MAX_NUM_SESSIONS;
+  }
+
+  /**
+   * \brief returns the listening socket handle (see MessageReactor)
+   *
+   * \return socket handle
+   */
+  int getListenHandle()
+  {
+    return this->listener_.getSrvrHandle();
+  }
+
+  /**
+   * \brief Accepts all pending clients.  Executed by the reactor when the
+   * listening socket is ready.
+   *
+   * \return number of clients accepted
+   */
+  int acceptClients();
+
+  /**
+   * \brief Closes a session (disconnecting its client, if connected).
+   * Executed when a session connection is lost (see SessionFaultHandler).
+   *
+   * \param idx session index
+   */
+  void closeSession(unsigned int idx);
+
+private:
+
+  /**
+   * \brief A client session (a session is unused if it is not active)
+   */
+  struct Session
+  {
+    industrial::tcp_server::TcpServer connection;
+    industrial::message_manager::MessageManager manager;
+    SessionFaultHandler fault;
+    bool active;
+  };
+
+  /**
+   * \brief Listening socket
+   */
+  industrial::tcp_server::TcpServer listener_;
+
+  /**
+   * \brief Sessions
+   */
+  Session sessions_[MAX_NUM_SESSIONS];
+
+  /**
+   * \brief Number of active sessions
+   */
+  unsigned int num_sessions_;
+
+  /**
+   * \brief Reactor that drives the server, NULL if not initialized
+   */
+  industrial::message_reactor::MessageReactor* reactor_;
+
+};
+
+} // namespace message_server
+} // namespace industrial
+
+#endif //LINUXSOCKETS
+
+#endif //MESSAGE_SERVER_H
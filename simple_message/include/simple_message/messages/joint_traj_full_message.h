@@ -0,0 +1,136 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2013, Southwest Research Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 	* Redistributions of source code must retain the above copyright
+ * 	notice, this list of conditions and the following disclaimer.
+ * 	* Redistributions in binary form must reproduce the above copyright
+ * 	notice, this list of conditions and the following disclaimer in the
+ * 	documentation and/or other materials provided with the distribution.
+ * 	* Neither the name of the Southwest Research Institute, nor the names
+ *	of its contributors may be used to endorse or promote products derived
+ *	from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef JOINT_TRAJ_FULL_MESSAGE_H
+#define JOINT_TRAJ_FULL_MESSAGE_H
+
+#ifndef FLATHEADERS
+#include "simple_message/typed_message.h"
+#include "simple_message/simple_message.h"
+#include "simple_message/shared_types.h"
+#include "simple_message/joint_traj_full.h"
+#else
+#include "typed_message.h"
+#include "simple_message.h"
+#include "shared_types.h"
+#include "joint_traj_full.h"
+#endif
+
+namespace industrial
+{
+namespace joint_traj_full_message
+{
+
+
+/**
+ * \brief Class encapsulated joint trajectory message generation methods
+ * (either to or from a industrial::simple_message::SimpleMessage type.
+ *
+ * This message simply wraps the industrial::joint_traj_full::JointTrajFull data type.
+ * The data portion of this typed message matches JointTrajFull.  It is used to
+ * download a complete trajectory (or large portions of a trajectory) with a
+ * single message.  The trajectory points use the same special sequence values
+ * as point-by-point downloads (i.e. START_TRAJECTORY_DOWNLOAD for the first
+ * point and END_TRAJECTORY for the last point of the trajectory).
+ *
+ *
+ * THIS CLASS IS NOT THREAD-SAFE
+ *
+ */
+
+class JointTrajFullMessage : public industrial::typed_message::TypedMessage
+
+{
+public:
+  /**
+   * \brief Default constructor
+   *
+   * This method creates an empty message.
+   *
+   */
+  JointTrajFullMessage(void);
+  /**
+   * \brief Destructor
+   *
+   */
+  ~JointTrajFullMessage(void);
+  /**
+   * \brief Initializes message from a simple message
+   *
+   * \param simple message to construct from
+   *
+   * \return true if message successfully initialized, otherwise false
+   */
+  bool init(industrial::simple_message::SimpleMessage & msg);
+
+  /**
+   * \brief Initializes message from a joint trajectory structure
+   *
+   * \param joint trajectory data structure
+   *
+   */
+  void init(industrial::joint_traj_full::JointTrajFull & traj);
+
+  /**
+   * \brief Initializes a new message
+   *
+   */
+  void init();
+
+  // Overrides - SimpleSerialize
+  bool load(industrial::byte_array::ByteArray *buffer);
+  bool unload(industrial::byte_array::ByteArray *buffer);
+
+  unsigned int byteLength()
+  {
+    return this->traj_.byteLength();
+  }
+
+  industrial::joint_traj_full::JointTrajFull traj_;
+
+private:
+
+  /**
+   * \brief Sets the number of joints of the trajectory from the message data
+   * length and trajectory size.
+   *
+   * \param msg message to be unloaded
+   *
+   * \return true on success, false otherwise (invalid data length)
+   */
+  bool setNumJointsFromMsg(industrial::simple_message::SimpleMessage & msg);
+
+};
+
+}
+}
+
+#endif /* JOINT_TRAJ_FULL_MESSAGE_H */
@@ -229,6 +229,7 @@ bool operator==(RobotStatus &rhs);
 // Overrides - SimpleSerialize
 bool load(industrial::byte_array::ByteArray *buffer);
 bool unload(industrial::byte_array::ByteArray *buffer);
+bool unload(industrial::byte_array::ByteArrayReader *buffer);
 unsigned int byteLength()
 {
   return 7 * sizeof(industrial::shared_types::shared_int);
@@ -32,6 +32,16 @@
 #ifndef SHARED_TYPES_H_
 #define SHARED_TYPES_H_
 
+/**
+ * \brief Robot controllers (i.e. the Motoman MotoPlus controller) may not
+ * support dynamic memory allocation.  For these platforms FIXED_SIZE_BUFFERS
+ * is defined, which selects fixed (maximum) size data buffers.  It may also
+ * be defined by the build for any other platform.
+ */
+#if defined(MOTOPLUS) && !defined(FIXED_SIZE_BUFFERS)
+#define FIXED_SIZE_BUFFERS
+#endif
+
 namespace industrial
 {
 
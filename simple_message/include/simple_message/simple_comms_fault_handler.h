@@ -94,7 +94,9 @@ public:
 
      /**
       * \brief Connection failure callback method: On a connection failure
-      * a blocking reconnection is attempted.
+      * a reconnection is attempted (see SmplMsgConnection::pollConnect),
+      * which only blocks for connections that don't support non-blocking
+      * connects.
       *
       */
      void connectionFailCB();
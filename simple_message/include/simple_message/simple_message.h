@@ -197,10 +197,25 @@ public:
    * \return true if valid message created
    */
   bool init(int msgType, int commType, int replyCode);
+
+  /**
+   * \brief Initializes the message header only.  The data payload held in
+   * the internal data member (see getData()) is left untouched.  This allows
+   * the payload to be received (or loaded) directly into the message without
+   * an intermediate copy.
+   *
+   * \param message type. Globally unique message ID (see StandardMsgType)
+   * \param communications types (see CommType)
+   * \param reply code(see ReplyType), only valide if comms type is a reply
+   *
+   * \return true if valid message created
+   */
+  bool initHeader(int msgType, int commType, int replyCode);
   
   /**
    * \brief Initializes a simple message from a generic byte array.  The byte
-   * array is assumed to hold a valid message with a HEADER and data payload
+   * array is assumed to hold a valid message with a HEADER and data payload.
+   * The byte array is read in place (it is not modified).
    *
    * \param valid message (as bytes)
    *
@@ -76,6 +76,25 @@ public:
    */
   virtual bool unload(industrial::byte_array::ByteArray *buffer)=0;
 
+  /**
+   * \brief Virtual method for unloading an object from a ByteArrayReader
+   *
+   * This method should unload all the required data to reconstruct the
+   * class object in the same order that it was loaded (i.e. a forward read).
+   * The default implementation copies byteLength() bytes into a temporary
+   * ByteArray and calls unload(ByteArray*).  Classes should override this
+   * method in order to avoid the copy.
+   *
+   * \param buffer pointer to ByteArrayReader
+   *
+   * \return true on success, false otherwise (buffer not large enough)
+   */
+  virtual bool unload(industrial::byte_array::ByteArrayReader *buffer)
+  {
+    industrial::byte_array::ByteArray temp;
+    return buffer->unload(temp, this->byteLength()) && this->unload(&temp);
+  }
+
   /**
    * \brief Virtual method returns the object size when packed into a
    * ByteArray
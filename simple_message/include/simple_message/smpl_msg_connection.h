@@ -57,12 +57,87 @@ namespace smpl_msg_connection
  * 2. The data connection has an explicit connect that establishes the connection (and an 
  *    associated disconnect method).  NOTE: For data connections that are connectionless,
  *    such as UDP, the connection method can be a NULL operation.
+ *
+ * Messages may optionally be byte swapped at runtime (see setByteSwapping),
+ * which allows a single binary to communicate with controllers of either
+ * endianness.
  */
 class SmplMsgConnection
 
 {
 public:
 
+  /**
+   * \brief Constructor (byte swapping disabled)
+   */
+  SmplMsgConnection();
+
+  /**
+   * \brief Enables/disables runtime byte swapping of all messages sent and
+   * received by this connection.  Messages are swapped as a whole, as an
+   * array of shared_int/shared_real values, so swapping is only supported
+   * when these types are the same size (i.e. not in FLOAT64 builds).  Runtime
+   * swapping is applied in addition to the BYTE_SWAPPING compiler flag (i.e.
+   * enabling both results in no swapping).
+   *
+   * \param enable true to swap messages
+   *
+   * \return true on success, false otherwise (swapping not supported)
+   */
+  bool setByteSwapping(bool enable);
+
+  /**
+   * \brief returns runtime byte swapping status (see setByteSwapping)
+   *
+   * \return true if messages are byte swapped
+   */
+  bool isByteSwapping() {return this->byte_swapping_;};
+
+  /**
+   * \brief Enables/disables batching of queued messages (see queueMsg).
+   * Queued messages are appended to a batch buffer, which is sent as a
+   * single write when it reaches max_bytes, when the oldest queued message
+   * is older than max_delay, or when flush is called.  The delay is checked
+   * when a message is queued and by flushIfDue, which is called on each
+   * spin of a message manager or reactor (MessageReactor also wakes up when
+   * queued messages are due).  Batching is intended for bulk transfers (i.e.
+   * trajectory downloads).  Messages sent with sendMsg bypass the batch
+   * (after first flushing it, so message order is preserved).  Disabling
+   * batching flushes any queued messages.
+   *
+   * Stream connections (i.e. TCP) send a flushed batch as a single write.
+   * Datagram connections (i.e. UDP) still send one message per datagram, but
+   * send several datagrams per socket call (see UdpSocket::sendBytes).
+   *
+   * \param max_bytes batch size (bytes) that triggers a flush, 0 disables
+   * batching (default), limited to MAX_BATCH_BYTES
+   * \param max_delay maximum time (ms) a message is queued before a flush
+   *
+   * \return true on success, false otherwise (invalid bounds)
+   */
+  virtual bool setBatching(industrial::shared_types::shared_int max_bytes, int max_delay);
+
+  /**
+   * \brief returns batching status (see setBatching)
+   *
+   * \return true if queued messages are batched
+   */
+  bool isBatching() {return this->batch_max_bytes_ > 0;};
+
+  /**
+   * \brief Gets the current (monotonic) time, for computing timeouts
+   *
+   * \return time (ms), wraps around (always 0 if not supported)
+   */
+  static unsigned int getTimeMs();
+
+  /**
+   * \brief Sleeps (blocks the calling thread)
+   *
+   * \param ms time to sleep (ms)
+   */
+  static void sleepMs(int ms);
+
   // Message
   
   /**
@@ -73,6 +148,50 @@ public:
    * \return true if successful
    */
   virtual bool sendMsg(industrial::simple_message::SimpleMessage & message);
+
+  /**
+   * \brief Queues a message for sending as part of a batch (see
+   * setBatching).  The message is serialized into the batch buffer, so it
+   * may be reused as soon as this method returns.  If batching is disabled
+   * the message is sent immediately (see sendMsg).
+   *
+   * \param message to queue
+   *
+   * \return true if successful (if a flush was triggered, the batch was
+   * sent successfully)
+   */
+  bool queueMsg(industrial::simple_message::SimpleMessage & message);
+
+  /**
+   * \brief Sends all queued messages (see queueMsg).  Queued messages are
+   * discarded if the send fails.
+   *
+   * \return true if successful (or nothing queued)
+   */
+  bool flush();
+
+  /**
+   * \brief Sends all queued messages if the oldest of them is older than the
+   * batching delay (see setBatching), for callers that don't queue messages
+   * regularly (i.e. event loops).
+   *
+   * \return true if successful (or nothing due)
+   */
+  bool flushIfDue();
+
+  /**
+   * \brief Gets the time left before queued messages are due (see
+   * flushIfDue), in order to limit a wait timeout
+   *
+   * \return time (ms), 0 if due, -1 if nothing queued
+   */
+  int getFlushTimeout();
+
+  /**
+   * \brief Maximum batch size (bytes), kept well below the maximum socket
+   * send size.
+   */
+  static const industrial::shared_types::shared_int MAX_BATCH_BYTES = 8192;
   
   /**
    * \brief Receives a message using the data connection
@@ -111,8 +230,88 @@ public:
    */
   virtual bool makeConnect()=0;
 
+  /**
+   * \brief Establishes the connection, waiting at most timeout for it.
+   * Connections that support non-blocking connects (see TcpClient) start a
+   * new connect attempt when required (subject to their retry backoff) and
+   * wait for it to complete, so calling this method with a zero timeout
+   * advances the connect without blocking (i.e. from an event loop).  The
+   * default implementation makes a single (blocking) connect attempt (see
+   * makeConnect) and waits out the rest of the timeout if it fails, in order
+   * to throttle retries.
+   *
+   * \param timeout (ms) time to wait for the connection, negative values
+   * wait until connected (non-blocking connects only)
+   *
+   * \return true if connected
+   */
+  virtual bool pollConnect(int timeout);
+
+  /**
+   * \brief returns true if a (non-blocking) connect is in progress (see
+   * pollConnect)
+   *
+   * \return true if connecting
+   */
+  virtual bool isConnecting() {return false;};
+
+protected:
+
+  /**
+   * \brief Swaps the byte order of a complete message (or portion of a
+   * message), if runtime byte swapping is enabled.
+   *
+   * \param data pointer to data to swap
+   * \param byte_size size of data (in bytes)
+   *
+   * \return true on success (or swapping disabled), false otherwise (data is
+   * not a whole number of message values)
+   */
+  bool swapMsgBytes(char* data, industrial::shared_types::shared_int byte_size);
+
+  /**
+   * \brief Method used by send message interface method.  Sends the message
+   * prefix (length and header) and data as a single message, without first
+   * joining them into one buffer.  The data is not modified.  The default
+   * implementation copies both parts into a single buffer (byte swapped, if
+   * enabled) and sends it with sendBytes.  Connections that support vectored
+   * sends (i.e. sockets) should override this method.
+   *
+   * \param prefix message length and header
+   * \param data message data (may be empty)
+   *
+   * \return true if successful
+   */
+  virtual bool sendGatherBytes(industrial::byte_array::ByteArray & prefix,
+                               industrial::byte_array::ByteArray & data);
+
 private:
 
+  /**
+   * \brief runtime byte swapping flag (see setByteSwapping)
+   */
+  bool byte_swapping_;
+
+  /**
+   * \brief queued (serialized and byte swapped) messages (see queueMsg)
+   */
+  industrial::byte_array::ByteArray batch_;
+
+  /**
+   * \brief batch size (bytes) that triggers a flush (0 = batching disabled)
+   */
+  industrial::shared_types::shared_int batch_max_bytes_;
+
+  /**
+   * \brief maximum time (ms) a message is queued before a flush
+   */
+  int batch_max_delay_;
+
+  /**
+   * \brief time (ms) the oldest queued message was queued (see getTimeMs)
+   */
+  unsigned int batch_start_;
+
   // Overrides
   /**
    * \brief Method used by send message interface method.  This should be overridden 
@@ -50,6 +50,11 @@
 #include "unistd.h"
 #include "netinet/tcp.h"
 #include "errno.h"
+#include "fcntl.h"
+#include "poll.h"
+#include "sys/epoll.h"
+#include "sys/uio.h"
+#include "time.h"
 
 #define SOCKET(domain, type, protocol) socket(domain, type, protocol)
 #define BIND(sockfd, addr, addrlen) bind(sockfd, addr, addrlen)
@@ -132,6 +137,22 @@ enum StandardSocketPort
 }
 typedef StandardSocketPorts::StandardSocketPort StandardSocketPort;
 
+/**
+ * \brief Enumeration of socket readiness (polling) methods.  SELECT is
+ * supported by all platforms, but is limited to socket handles smaller
+ * than FD_SETSIZE.  POLL and EPOLL require LINUXSOCKETS.  EPOLL keeps a
+ * wait set per socket, which avoids passing the socket to the kernel on
+ * every poll (suited for long-lived connections).
+ */
+namespace PollMethods
+{
+enum PollMethod
+{
+  SELECT = 1, POLL = 2, EPOLL = 3
+};
+}
+typedef PollMethods::PollMethod PollMethod;
+
 /**
  * \brief Defines socket functions required for a simple connection type.
  */
@@ -142,22 +163,34 @@ public:
   /**
      * \brief Constructor
      */
-  SimpleSocket(){}
+  SimpleSocket();
 
   /**
      * \brief Destructor
      */
-  virtual ~SimpleSocket(){}
+  virtual ~SimpleSocket();
 
   bool isConnected()
   {
     return connected_;
   }
+
+  /**
+   * \brief Receives a message (see SmplMsgConnection::receiveMsg) within a
+   * single receive deadline (see setReceiveTimeout).  The socket is
+   * disconnected if the receive fails after any part of the message was
+   * received, since the message stream can no longer be parsed.
+   *
+   * \param message populated with received message
+   *
+   * \return true if successful
+   */
+  bool receiveMsg(industrial::simple_message::SimpleMessage & message);
   
   /**
    * \brief returns true if socket data is ready to receive
    *
-   * \param timeout (ms) negative or zero values result in blocking
+   * \param timeout (ms) negative values result in blocking
    *
    * \return true if data is ready to recieve
    */
@@ -167,6 +200,116 @@ public:
     return poll(timeout, r, e);
   }
 
+  /**
+   * \brief returns the socket handle (i.e. for registering the socket with an
+   * event loop, see MessageReactor).  The handle may change when the socket
+   * (re)connects.
+   *
+   * \return socket handle
+   */
+  int  getSockHandle() const
+  {
+    return sock_handle_;
+  }
+
+  /**
+   * \brief Enables/disables non-blocking socket I/O.  Sends and receives on a
+   * non-blocking socket wait (poll) for the socket to become ready, so that
+   * message level send/receive behavior is unchanged.  The mode applies to the
+   * current socket handle only (see getSockHandle).
+   *
+   * \param enable true for non-blocking I/O
+   *
+   * \return true on success, false otherwise (not supported by the platform)
+   */
+  bool setNonBlocking(bool enable);
+
+  /**
+   * \brief Sets the method used to poll the socket for readiness (see
+   * PollMethod).  The default is POLL (LINUXSOCKETS) or SELECT.
+   *
+   * \param method poll method
+   *
+   * \return true on success, false otherwise (not supported by the platform)
+   */
+  bool setPollMethod(PollMethod method);
+
+  /**
+   * \brief returns the poll method (see setPollMethod)
+   *
+   * \return poll method
+   */
+  PollMethod getPollMethod()
+  {
+    return this->poll_method_;
+  }
+
+  /**
+   * \brief Sets the receive timeout.  A receive (of the requested number of
+   * bytes or a datagram) fails if it does not complete within the timeout.
+   * The timeout applies to a whole message (see receiveMsg), not to each of
+   * its parts.  A receive that times out before any data arrives leaves the
+   * socket connected.  A partial receive disconnects the socket, since the
+   * message stream can no longer be parsed.  Timeouts are only supported by
+   * LINUXSOCKETS (other platforms wait indefinitely).
+   *
+   * \param timeout (ms) negative values wait indefinitely (default)
+   */
+  void setReceiveTimeout(int timeout)
+  {
+    this->receive_timeout_ = timeout;
+  }
+
+  /**
+   * \brief returns the receive timeout (see setReceiveTimeout)
+   *
+   * \return receive timeout (ms)
+   */
+  int getReceiveTimeout()
+  {
+    return this->receive_timeout_;
+  }
+
+  /**
+   * \brief Enables/disables stream readahead (enabled by default).  With
+   * readahead, each socket read receives as many bytes as are available (up
+   * to the socket buffer size) and following receives are served from the
+   * buffered data, so that several small messages can be received with a
+   * single read.  Without readahead, exactly the requested bytes are read
+   * (directly into the destination).  Buffered data is discarded when the
+   * socket (re)connects.  Readahead is not used by datagram sockets.
+   *
+   * \param enable true to enable readahead
+   */
+  void setReadahead(bool enable)
+  {
+    this->readahead_ = enable;
+  }
+
+  /**
+   * \brief returns true if a complete message (length prefix, header and data)
+   * has been received into the readahead buffer, i.e. a receiveMsg call will
+   * not wait on the socket.  Buffered messages are not reported by polling the
+   * socket handle (i.e. by an event loop, see MessageReactor).
+   *
+   * \return true if a complete message is buffered
+   */
+  virtual bool isMsgBuffered();
+
+  /**
+   * \brief Receives the data available on the (ready) socket into the
+   * readahead buffer, without waiting for more.  Partially received messages
+   * are accumulated across calls, so that an event loop only receives
+   * complete messages (see isMsgBuffered and MessageReactor) and a peer that
+   * stops sending mid-message doesn't block it.  The data is buffered
+   * whether or not readahead is enabled (see setReadahead).  The connection
+   * is closed if it fails, or if the buffer is full without a complete
+   * message.
+   *
+   * \return false if the connection failed (or was closed), true otherwise
+   */
+  virtual bool receiveAvailable();
+
 protected:
 
   /**
@@ -201,25 +344,100 @@ protected:
   static const int SOCKET_POLL_TO = 1000;
 
   /**
-   * \brief internal data buffer for receiving
+   * \brief internal data buffer for receiving datagrams, or the readahead
+   * buffer for stream data (see setReadahead)
    */
   char buffer_[MAX_BUFFER_SIZE + 1];
 
-  int  getSockHandle() const
-  {
-    return sock_handle_;
-  }
+  /**
+   * \brief readahead flag (see setReadahead)
+   */
+  bool readahead_;
+
+  /**
+   * \brief readahead buffer read position (next byte to be received)
+   */
+  int read_pos_;
+
+  /**
+   * \brief readahead buffer end position (buffered bytes end here)
+   */
+  int read_end_;
+
+  /**
+   * \brief non-blocking flag (see setNonBlocking)
+   */
+  bool non_blocking_;
+
+  /**
+   * \brief poll method (see PollMethod)
+   */
+  PollMethod poll_method_;
+
+  /**
+   * \brief receive timeout (ms), negative values wait indefinitely
+   */
+  int receive_timeout_;
+
+  /**
+   * \brief true while a message is being received (see receiveMsg), in
+   * which case receives are timed from msg_start_
+   */
+  bool msg_receiving_;
+
+  /**
+   * \brief time (ms) the message being received started (see getTimeMs)
+   */
+  unsigned int msg_start_;
+
+  /**
+   * \brief bytes of the message being received that were received so far
+   */
+  int msg_received_;
+
+  /**
+   * \brief epoll handle (EPOLL poll method only), -1 if not created
+   */
+  int epoll_handle_;
+
+  /**
+   * \brief events for which the socket is registered with the epoll handle,
+   * 0 if the socket is not registered
+   */
+  unsigned int epoll_events_;
 
   void setSockHandle(int sock_handle_)
   {
     this->sock_handle_ = sock_handle_;
+    // A new socket must be registered (again) with the epoll handle and
+    // has no buffered data.
+    this->epoll_events_ = 0;
+    this->non_blocking_ = false;
+    this->read_pos_ = this->read_end_ = 0;
   }
   
   virtual void setConnected(bool connected)
   {
+    if (connected && !this->connected_)
+    {
+      // Discard readahead data from a previous connection
+      this->read_pos_ = this->read_end_ = 0;
+    }
     this->connected_ = connected;
   }
 
+  /**
+   * \brief returns true if received data is buffered (i.e. readahead data),
+   * in which case polling for receive returns ready without waiting on the
+   * socket (see pollReady)
+   *
+   * \return true if data is buffered
+   */
+  virtual bool isDataBuffered()
+  {
+    return this->read_end_ > this->read_pos_;
+  }
+
   void logSocketError(const char* msg, int rc)
   {
     int errno_ = errno;
@@ -229,24 +447,98 @@ protected:
   /**
    * \brief polls socket for data or error
    *
-   * \param timeout (ms) negative or zero values result in blocking
+   * \param timeout (ms) negative values result in blocking
    * \param ready true if ready
    * \param except true if exception
    *
    * \return true if function DID NOT timeout (must check flags)
    */
-  bool poll(int timeout, bool & ready, bool & error);
+  bool poll(int timeout, bool & ready, bool & error)
+  {
+    return this->pollReady(timeout, false, ready, error);
+  }
+
+  /**
+   * \brief polls socket until data can be sent
+   *
+   * \param timeout (ms) negative values result in blocking
+   *
+   * \return true if socket is ready to send, false on timeout or error
+   */
+  bool pollSend(int timeout)
+  {
+    bool ready, error;
+    return this->pollReady(timeout, true, ready, error) && ready;
+  }
+
+  /**
+   * \brief polls socket for readiness (receive or send) or error, using the
+   * poll method (see setPollMethod)
+   *
+   * \param timeout (ms) negative values result in blocking
+   * \param send true to poll for send, false to poll for receive
+   * \param ready true if ready
+   * \param error true if exception
+   *
+   * \return true if function DID NOT timeout (must check flags)
+   */
+  bool pollReady(int timeout, bool send, bool & ready, bool & error);
+
+  /**
+   * \brief Gets the time left before a receive deadline (see setReceiveTimeout)
+   * in order to limit a (single) poll timeout
+   *
+   * \param start time (ms) the receive started (see getTimeMs)
+   * \param timeout (ms) poll timeout
+   *
+   * \return poll timeout (ms), 0 if the deadline has passed
+   */
+  int getReceivePollTimeout(unsigned int start, int timeout);
+
+  /**
+   * \brief returns true if a receive deadline has passed (see setReceiveTimeout)
+   *
+   * \param start time (ms) the receive started (see getTimeMs)
+   *
+   * \return true if timed out
+   */
+  bool isReceiveTimedOut(unsigned int start);
+
+  /**
+   * \brief returns true if a raw send/receive failed only because the
+   * (non-blocking) socket was not ready
+   *
+   * \param rc return code of raw send/receive
+   *
+   * \return true if the operation should be retried once the socket is ready
+   */
+  bool isWouldBlock(int rc);
   
   // Send/Receive functions (inherited classes should override raw methods
   // Virtual
   bool sendBytes(industrial::byte_array::ByteArray & buffer);
   bool receiveBytes(industrial::byte_array::ByteArray & buffer,
       industrial::shared_types::shared_int num_bytes);
+#ifdef LINUXSOCKETS
+  bool sendGatherBytes(industrial::byte_array::ByteArray & prefix,
+      industrial::byte_array::ByteArray & data);
+#endif
   // Virtual
   virtual int rawSendBytes(char *buffer,
       industrial::shared_types::shared_int num_bytes)=0;
   virtual int rawReceiveBytes(char *buffer,
       industrial::shared_types::shared_int num_bytes)=0;
+#ifdef LINUXSOCKETS
+  /**
+   * \brief Sends (gathers) multiple buffers with a single socket call
+   *
+   * \param iov buffers to send
+   * \param iov_count number of buffers
+   *
+   * \return number of bytes sent or SOCKET_FAIL
+   */
+  virtual int rawSendVector(iovec *iov, int iov_count)=0;
+#endif
 
 };
 
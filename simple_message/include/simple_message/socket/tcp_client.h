@@ -47,6 +47,14 @@ namespace tcp_client
 
 /**
  * \brief Defines TCP client functions.
+ *
+ * Each connect attempt uses a new socket.  On LINUXSOCKETS connects are
+ * non-blocking: an attempt is started (and its completion checked) by
+ * pollConnect, so that a connection can be (re)established by the same event
+ * loop that receives from it (see MessageReactor).  Failed attempts are
+ * retried after an exponentially increasing delay (see setConnectBackoff) and
+ * an attempt that does not complete within the connect timeout fails (see
+ * setConnectTimeout).
  */
 class TcpClient : public industrial::tcp_socket::TcpSocket
 {
@@ -73,8 +81,113 @@ public:
      */
     bool init(char *buff, int port_num);
 
+    /**
+     * \brief Sets the delay between failed connect attempts (see
+     * pollConnect).  The delay starts at min_delay and doubles after each
+     * failed attempt, up to max_delay.  It is reset once connected.
+     *
+     * \param min_delay (ms) delay after the first failed attempt
+     * \param max_delay (ms) maximum delay
+     *
+     * \return true on success, false otherwise (invalid delays)
+     */
+    bool setConnectBackoff(int min_delay, int max_delay);
+
+    /**
+     * \brief Sets the time a connect attempt may take before it fails
+     * (non-blocking connects only)
+     *
+     * \param timeout (ms) connect timeout
+     */
+    void setConnectTimeout(int timeout)
+    {
+      this->connect_timeout_ = timeout;
+    }
+
     // Overrides
+    // makeConnect always starts a new attempt (if none is in progress) and
+    // waits (at most the connect timeout) for it to complete
     bool makeConnect();
+    bool pollConnect(int timeout);
+    bool isConnecting()
+    {
+      return this->connecting_;
+    }
+
+protected:
+
+    /**
+     * \brief Default minimum/maximum delay (ms) between connect attempts
+     */
+    static const int DEFAULT_BACKOFF_MIN = 50;
+    static const int DEFAULT_BACKOFF_MAX = 500;
+
+    /**
+     * \brief Default connect timeout (ms)
+     */
+    static const int DEFAULT_CONNECT_TIMEOUT = 1000;
+
+    /**
+     * \brief flag indicating a (non-blocking) connect is in progress
+     */
+    bool connecting_;
+
+    /**
+     * \brief time (ms) the connect in progress was started (see getTimeMs)
+     */
+    unsigned int connect_start_;
+
+    /**
+     * \brief time (ms) of the next connect attempt, after a failed attempt
+     */
+    unsigned int next_connect_;
+
+    /**
+     * \brief connect timeout (ms)
+     */
+    int connect_timeout_;
+
+    /**
+     * \brief minimum/maximum delay (ms) between connect attempts
+     */
+    int backoff_min_;
+    int backoff_max_;
+
+    /**
+     * \brief current delay (ms) between connect attempts, 0 if the last
+     * attempt did not fail
+     */
+    int backoff_;
+
+    /**
+     * \brief Creates a new socket (closing the current one)
+     *
+     * \return true on success, false otherwise
+     */
+    bool openSocket();
+
+    /**
+     * \brief Starts a connect attempt (with a new socket)
+     */
+    void startConnect();
+
+    /**
+     * \brief Waits for the connect in progress to complete
+     *
+     * \param timeout (ms) negative values wait until the connect timeout
+     */
+    void checkConnect(int timeout);
+
+    /**
+     * \brief Completes a successful connect attempt
+     */
+    void finishConnect();
+
+    /**
+     * \brief Ends a failed connect attempt (closing the socket) and schedules
+     * the next attempt
+     */
+    void failConnect();
 
 
 };
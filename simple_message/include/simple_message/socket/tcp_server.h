@@ -45,6 +45,10 @@ namespace tcp_server
 
 /**
  * \brief Defines TCP server functions.
+ *
+ * By default a server communicates with a single client at a time (see
+ * makeConnect).  Multiple clients may be served by accepting each one into
+ * its own TcpServer object (see acceptClient and MessageServer).
  */
 class TcpServer : public industrial::tcp_socket::TcpSocket
 {
@@ -65,14 +69,45 @@ public:
    * following initialization in order to communicate with the remote host.
    *
    * \param port_num port number (server & client port number must match)
+   * \param backlog maximum number of pending (not yet accepted) client
+   * connections
    *
    * \return true on success, false otherwise (socket is invalid)
    */
-  bool init(int port_num);
+  bool init(int port_num, int backlog = 1);
 
   // Overrides
   bool makeConnect();
 
+  /**
+   * \brief Accepts a client connection from the listening socket of another
+   * server (multi-client mode).  The client is served by this object, which
+   * doesn't need to be initialized (see init).  Any previous client of this
+   * object is disconnected.
+   *
+   * \param listener initialized server (see init)
+   *
+   * \return true on success, false otherwise (including no pending client
+   * on a non-blocking listening socket)
+   */
+  bool acceptClient(TcpServer & listener);
+
+  /**
+   * \brief Closes the client connection (a listening socket remains open)
+   */
+  void closeClient();
+
+  /**
+   * \brief returns the listening socket handle (i.e. for registering the
+   * socket with an event loop, see MessageServer)
+   *
+   * \return listening socket handle
+   */
+  int getSrvrHandle() const
+  {
+    return srvr_handle_;
+  }
+
 protected:
   /**
    * \brief server handle.  Every time a connection is made, the class generates
@@ -81,10 +116,14 @@ protected:
    */
   int srvr_handle_;
 
-  int getSrvrHandle() const
-  {
-    return srvr_handle_;
-  }
+  /**
+   * \brief Accepts a client connection from a listening socket
+   *
+   * \param srvr_handle listening socket handle
+   *
+   * \return true on success, false otherwise
+   */
+  bool acceptFrom(int srvr_handle);
 
   void setSrvrHandle(int srvr_handle_)
   {
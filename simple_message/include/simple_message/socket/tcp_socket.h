@@ -71,6 +71,9 @@ private:
       industrial::shared_types::shared_int num_bytes);
   int rawReceiveBytes(char *buffer,
       industrial::shared_types::shared_int num_bytes);
+#ifdef LINUXSOCKETS
+  int rawSendVector(iovec *iov, int iov_count);
+#endif
 
 };
 
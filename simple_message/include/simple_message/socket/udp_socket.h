@@ -69,9 +69,141 @@ public:
   // receive is overridden because the base class implementation assumed
   // socket data could be read partially.  UDP socket data is lost when
   // only a portion of it is read.  For that reason this receive method
-  // reads the entire data stream (assumed to be a single message).
+  // reads the entire data stream (assumed to be a single message).  The
+  // header is parsed in place and the data portion is copied (once) into
+  // the message.  With sequencing enabled, out of sequence (stale)
+  // datagrams are discarded (see setSequencing).  Where supported, up to
+  // RECV_BATCH_SIZE datagrams are received with a single socket call, the
+  // following receives are served from the received batch.
   bool  receiveMsg(industrial::simple_message::SimpleMessage & message);
 
+  // Override
+  // sequence state (and any received datagrams) is reset when the socket
+  // (re)connects
+  void setConnected(bool connected);
+
+  // Override
+  // each received datagram holds a single message
+  bool isMsgBuffered()
+  {
+    return this->recv_next_ < this->recv_count_;
+  }
+
+  // Override
+  // the waiting datagrams are received into the batch (only if it is empty),
+  // where supported.  Receive failures don't close the socket.
+  bool receiveAvailable();
+
+  /**
+   * \brief Enables/disables message sequencing (disabled by default).  With
+   * sequencing, each datagram is prefixed by a sequence number (ahead of the
+   * message length), so that lost, duplicated and reordered datagrams can be
+   * detected by the receiver.  Duplicated and reordered (older) datagrams are
+   * discarded.  Both ends of the connection must enable sequencing.
+   *
+   * \param enable true to enable sequencing
+   */
+  void setSequencing(bool enable)
+  {
+    this->sequencing_ = enable;
+  }
+
+  /**
+   * \brief returns true if message sequencing is enabled (see setSequencing)
+   *
+   * \return true if sequencing
+   */
+  bool isSequencing()
+  {
+    return this->sequencing_;
+  }
+
+  /**
+   * \brief Enables/disables latest only receives (disabled by default).  When
+   * enabled, each receive returns the newest message available, any older
+   * messages waiting in the socket are skipped.  This is intended for state
+   * data (i.e. joint feedback), where only the latest value is of interest.
+   *
+   * \param enable true to only receive the latest message
+   */
+  void setLatestOnly(bool enable)
+  {
+    this->latest_only_ = enable;
+  }
+
+  /**
+   * \brief returns true if latest only receives are enabled (see setLatestOnly)
+   *
+   * \return true if latest only
+   */
+  bool isLatestOnly()
+  {
+    return this->latest_only_;
+  }
+
+  /**
+   * \brief Sets the time limit for the connect handshake (see makeConnect).
+   * When the limit is reached, makeConnect returns false (and may be called
+   * again).
+   *
+   * \param timeout (ms) negative values wait indefinitely (default)
+   */
+  void setConnectTimeout(int timeout)
+  {
+    this->connect_timeout_ = timeout;
+  }
+
+  /**
+   * \brief returns the connect handshake timeout (see setConnectTimeout)
+   *
+   * \return connect timeout (ms)
+   */
+  int getConnectTimeout()
+  {
+    return this->connect_timeout_;
+  }
+
+  /**
+   * \brief returns the number of datagrams lost (gaps in the received
+   * sequence numbers) since the socket connected (see setSequencing)
+   *
+   * \return number of lost datagrams
+   */
+  unsigned int getNumLost()
+  {
+    return this->num_lost_;
+  }
+
+  /**
+   * \brief returns the number of duplicated or reordered (stale) datagrams
+   * discarded since the socket connected (see setSequencing)
+   *
+   * \return number of stale datagrams
+   */
+  unsigned int getNumStale()
+  {
+    return this->num_stale_;
+  }
+
+  /**
+   * \brief returns the number of messages skipped in favor of a newer
+   * message since the socket connected (see setLatestOnly)
+   *
+   * \return number of skipped messages
+   */
+  unsigned int getNumSkipped()
+  {
+    return this->num_skipped_;
+  }
+
+  /**
+   * \brief resets the sequence statistics (lost, stale and skipped counts)
+   */
+  void resetSequenceStats()
+  {
+    this->num_lost_ = this->num_stale_ = this->num_skipped_ = 0;
+  }
+
 
 protected:
 
@@ -80,11 +212,224 @@ protected:
    */
   static const char CONNECT_HANDSHAKE = 255;
 
+  /**
+   * \brief sequence numbers this far (or less) behind the last received
+   * sequence number are treated as stale.  Larger jumps back are assumed to
+   * be a restart of the sender.
+   */
+  static const industrial::shared_types::shared_int SEQUENCE_WINDOW = 1000;
+
+  /**
+   * \brief maximum number of datagrams received with a single socket call
+   */
+  static const int RECV_BATCH_SIZE = 8;
+
+  /**
+   * \brief maximum number of datagrams sent with a single socket call
+   */
+  static const int SEND_BATCH_SIZE = 16;
+
+  /**
+   * \brief message sequencing flag (see setSequencing)
+   */
+  bool sequencing_;
+
+  /**
+   * \brief latest only receive flag (see setLatestOnly)
+   */
+  bool latest_only_;
+
+  /**
+   * \brief newer datagrams of a latest only receive (see receiveMsg) are
+   * parsed into this message, and only copied to the received message if
+   * they are valid
+   */
+  industrial::simple_message::SimpleMessage latest_msg_;
+
+  /**
+   * \brief connect handshake timeout (ms), negative values wait indefinitely
+   */
+  int connect_timeout_;
+
+  /**
+   * \brief sequence number of the next datagram sent
+   */
+  industrial::shared_types::shared_int send_seq_;
+
+  /**
+   * \brief sequence number of the last datagram received
+   */
+  industrial::shared_types::shared_int recv_seq_;
+
+  /**
+   * \brief true if a datagram has been received (recv_seq_ is valid)
+   */
+  bool recv_seq_valid_;
+
+  /**
+   * \brief sequence statistics (see getNumLost, getNumStale, getNumSkipped)
+   */
+  unsigned int num_lost_;
+  unsigned int num_stale_;
+  unsigned int num_skipped_;
+
+  /**
+   * \brief number of datagrams in the received batch
+   */
+  int recv_count_;
+
+  /**
+   * \brief index of the next datagram to be parsed from the received batch
+   */
+  int recv_next_;
+
+#ifdef LINUXSOCKETS
+  /**
+   * \brief received batch buffers, headers and source addresses (see
+   * receiveDatagram)
+   */
+  char recv_buffers_[RECV_BATCH_SIZE][MAX_BUFFER_SIZE];
+  mmsghdr recv_msgs_[RECV_BATCH_SIZE];
+  iovec recv_iov_[RECV_BATCH_SIZE];
+  sockaddr_in recv_addrs_[RECV_BATCH_SIZE];
+#endif
+
+  // Override
+  bool isDataBuffered()
+  {
+    return this->isMsgBuffered();
+  }
+
+  /**
+   * \brief Receives the next datagram, from the received batch if it is not
+   * empty, otherwise from the socket (which should be ready to receive).  The
+   * remote address is updated with the datagram's source address.
+   *
+   * \param data set to the datagram (valid until the next receive)
+   *
+   * \return size of the datagram, or SOCKET_FAIL
+   */
+  int receiveDatagram(char* & data);
+
+#ifdef LINUXSOCKETS
+  /**
+   * \brief Receives the waiting datagrams (up to RECV_BATCH_SIZE, without
+   * waiting) into the (empty) received batch
+   *
+   * \return number of datagrams received, or SOCKET_FAIL
+   */
+  int receiveBatch();
+#endif
+
+  /**
+   * \brief Gets the time left before the connect deadline (see
+   * setConnectTimeout) in order to limit a (single) poll timeout
+   *
+   * \param start time (ms) the connect started (see getTimeMs)
+   * \param timeout (ms) poll timeout, negative values wait indefinitely
+   *
+   * \return poll timeout (ms), 0 if the deadline has passed
+   */
+  int getConnectPollTimeout(unsigned int start, int timeout);
+
+  /**
+   * \brief returns true if the connect deadline has passed (see
+   * setConnectTimeout)
+   *
+   * \param start time (ms) the connect started (see getTimeMs)
+   *
+   * \return true if timed out
+   */
+  bool isConnectTimedOut(unsigned int start);
+
+  /**
+   * \brief Parses a received datagram (see receiveDatagram) into a message.
+   * The sequence number (if enabled) is checked before the message is
+   * modified, stale datagrams leave the message untouched.
+   *
+   * \param data datagram (parsed in place)
+   * \param rc size of the datagram (or SOCKET_FAIL)
+   * \param message message to populate
+   * \param stale set true if the datagram was discarded as stale
+   *
+   * \return true if the message was populated
+   */
+  bool parseMsg(char* data, int rc, industrial::simple_message::SimpleMessage & message,
+      bool & stale);
+
+  /**
+   * \brief Checks a received sequence number against the last one received
+   * and updates the sequence statistics.
+   *
+   * \param seq received sequence number
+   *
+   * \return true if the datagram is newer than the last one received, false
+   * if it is stale
+   */
+  bool checkSequence(industrial::shared_types::shared_int seq);
+
+  /**
+   * \brief Loads the next send sequence number, encoded as a message value
+   * (byte swapped, if enabled)
+   *
+   * \param seqData byte array to load (any existing data is deleted)
+   *
+   * \return true on success
+   */
+  bool loadSequence(industrial::byte_array::ByteArray & seqData);
+
+  // Override
+  // the buffer holds one or more complete messages (i.e. a flushed batch,
+  // see queueMsg), each message is sent as a datagram.  Where supported, up
+  // to SEND_BATCH_SIZE datagrams are sent with a single socket call.
+  bool sendBytes(industrial::byte_array::ByteArray & buffer);
+
+  // Override
+  // the sequence number (if enabled) is sent ahead of the message prefix
+  bool sendGatherBytes(industrial::byte_array::ByteArray & prefix,
+      industrial::byte_array::ByteArray & data);
+
+#ifdef LINUXSOCKETS
+  /**
+   * \brief Sends datagrams, retrying until all have been sent
+   *
+   * \param msgs datagrams to send
+   * \param count number of datagrams
+   *
+   * \return true if all datagrams were sent
+   */
+  bool sendBatch(mmsghdr *msgs, int count);
+
+  /**
+   * \brief Sends multiple datagrams with a single socket call
+   *
+   * \param msgs datagrams to send
+   * \param count number of datagrams
+   *
+   * \return number of datagrams sent or SOCKET_FAIL
+   */
+  virtual int rawSendBatch(mmsghdr *msgs, int count);
+
+  /**
+   * \brief Receives multiple (waiting) datagrams with a single socket call,
+   * without waiting for more datagrams to arrive
+   *
+   * \param msgs datagram buffers
+   * \param count number of datagram buffers
+   *
+   * \return number of datagrams received or SOCKET_FAIL
+   */
+  virtual int rawReceiveBatch(mmsghdr *msgs, int count);
+#endif
+
   // Virtual
   int rawSendBytes(char *buffer,
       industrial::shared_types::shared_int num_bytes);
   int rawReceiveBytes(char *buffer,
       industrial::shared_types::shared_int num_bytes);
+#ifdef LINUXSOCKETS
+  int rawSendVector(iovec *iov, int iov_count);
+#endif
 
 };
 
@@ -95,11 +95,10 @@ public:
    */
   virtual bool toRequest(industrial::simple_message::SimpleMessage & msg)
   {
-	  industrial::byte_array::ByteArray data;
-	  data.load(*this);
-	  return msg.init(this->getMessageType(),
+	  this->toData(msg);
+	  return msg.initHeader(this->getMessageType(),
 			  industrial::simple_message::CommTypes::SERVICE_REQUEST,
-			  industrial::simple_message::ReplyTypes::INVALID, data);
+			  industrial::simple_message::ReplyTypes::INVALID);
   }
 
   /**
@@ -110,11 +109,10 @@ public:
   virtual bool toReply(industrial::simple_message::SimpleMessage & msg,
 		  industrial::simple_message::ReplyType reply)
   {
-	  industrial::byte_array::ByteArray data;
-	data.load(*this);
-	return msg.init(this->getMessageType(),
+	this->toData(msg);
+	return msg.initHeader(this->getMessageType(),
 			industrial::simple_message::CommTypes::SERVICE_REPLY,
-			reply, data);
+			reply);
   }
   /**
    * \brief creates a simple_message topic
@@ -123,11 +121,10 @@ public:
    */
   virtual bool toTopic(industrial::simple_message::SimpleMessage & msg)
   {
-	  industrial::byte_array::ByteArray data;
-    data.load(*this);
-    return msg.init(this->getMessageType(),
+    this->toData(msg);
+    return msg.initHeader(this->getMessageType(),
     		industrial::simple_message::CommTypes::TOPIC,
-    		industrial::simple_message::ReplyTypes::INVALID, data);
+    		industrial::simple_message::ReplyTypes::INVALID);
   }
   /**
      * \brief gets message type (enumeration)
@@ -141,6 +138,18 @@ public:
 
 protected:
 
+  /**
+   * \brief Serializes this message directly into the data portion of a
+   * simple message (replacing any existing data), without an intermediate copy
+   *
+   * \param msg simple message
+   */
+  void toData(industrial::simple_message::SimpleMessage & msg)
+  {
+    msg.getData().init();
+    msg.getData().load(*this);
+  }
+
 /**
      * \brief sets message type
      *
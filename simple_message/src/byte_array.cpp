@@ -44,6 +44,14 @@
 
 #include "string.h"
 
+#ifdef __GNUC__
+#include <stdint.h>
+#endif
+
+#ifndef FIXED_SIZE_BUFFERS
+#include <new>
+#endif
+
 namespace industrial
 {
 namespace byte_array
@@ -55,19 +63,50 @@ using namespace industrial::byte_array;
 
 ByteArray::ByteArray(void)
 {
+#ifndef FIXED_SIZE_BUFFERS
+  this->buffer_ = &this->inline_buffer_[0];
+  this->buffer_capacity_ = this->INLINE_SIZE;
+#endif
   this->init();
 #ifdef BYTE_SWAPPING
   LOG_COMM("Byte swapping enabled");
 #endif
 }
 
+ByteArray::ByteArray(const ByteArray & buffer)
+{
+#ifndef FIXED_SIZE_BUFFERS
+  this->buffer_ = &this->inline_buffer_[0];
+  this->buffer_capacity_ = this->INLINE_SIZE;
+#endif
+  this->init();
+  *this = buffer;
+}
+
 ByteArray::~ByteArray(void)
 {
+#ifndef FIXED_SIZE_BUFFERS
+  if (this->buffer_ != &this->inline_buffer_[0])
+  {
+    delete[] this->buffer_;
+  }
+#endif
+}
+
+ByteArray & ByteArray::operator=(const ByteArray & rhs)
+{
+  if (this != &rhs)
+  {
+    if (this->setBufferSize(rhs.buffer_size_))
+    {
+      memcpy(this->getRawDataPtr(), &rhs.buffer_[0], this->buffer_size_);
+    }
+  }
+  return *this;
 }
 
 void ByteArray::init()
 {
-  memset(&(buffer_[0]), 0, this->MAX_SIZE);
   this->setBufferSize(0);
 }
 
@@ -104,31 +143,63 @@ void ByteArray::copyFrom(ByteArray & buffer)
 }
 
 
-#ifdef BYTE_SWAPPING
 void ByteArray::swap(void *value, shared_int byteSize)
 {
-  LOG_COMM("Executing byte swapping");
+  swapArray(value, byteSize, byteSize);
+}
 
-  LOG_COMM("Value (swapping-input): %u", (unsigned int)(*(unsigned int*)value));
-  for (unsigned int i = 0; i < byteSize / 2; i++)
-  {
-    unsigned int endIndex = byteSize - i - 1;
-    char endByte = ((char*)value)[endIndex];
-    unsigned int endInt = endByte;
+bool ByteArray::swapArray(void *values, shared_int byte_size, shared_int value_size)
+{
+  char* bytes = (char*)values;
 
-    unsigned int beginIndex = i;
-    char beginByte = ((char*)value)[beginIndex];
-    unsigned int beginInt = beginByte;
+  if ((value_size <= 0) || (byte_size < 0) || (0 != byte_size % value_size))
+  {
+    LOG_ERROR("Failed to swap bytes, array size: %d, not a multiple of value size: %d",
+              byte_size, value_size);
+    return false;
+  }
 
-    LOG_COMM("Swap beginIndex i: %u, endIndex: %u, begin[]: %u, end[]: %u",
-             beginIndex, endIndex, beginInt, endInt);
-    ((char*)value)[endIndex] = beginByte;
-    ((char*)value)[beginIndex] = endByte;
+#ifdef __GNUC__
+  // The common value sizes are swapped a word at a time (the compiler
+  // generates bswap instructions and may vectorize the loop).  memcpy is
+  // used because the values are not necessarily aligned.
+  if (4 == value_size)
+  {
+    uint32_t word;
+    for (shared_int i = 0; i < byte_size; i += 4)
+    {
+      memcpy(&word, &bytes[i], 4);
+      word = __builtin_bswap32(word);
+      memcpy(&bytes[i], &word, 4);
+    }
+    return true;
   }
-  LOG_COMM("Value (swapping-output): %u", (unsigned int)(*(unsigned int*)value));
+  if (8 == value_size)
+  {
+    uint64_t word;
+    for (shared_int i = 0; i < byte_size; i += 8)
+    {
+      memcpy(&word, &bytes[i], 8);
+      word = __builtin_bswap64(word);
+      memcpy(&bytes[i], &word, 8);
+    }
+    return true;
+  }
+#endif
 
+  for (shared_int i = 0; i < byte_size; i += value_size)
+  {
+    char* begin = &bytes[i];
+    char* end = &bytes[i + value_size - 1];
+    while (begin < end)
+    {
+      char temp = *begin;
+      *begin++ = *end;
+      *end-- = temp;
+    }
+  }
+  return true;
 }
-#endif
 
 char* ByteArray::getRawDataPtr()
 {
@@ -184,8 +255,10 @@ bool ByteArray::load(void* value, const shared_int byte_size)
 {
 
   bool rtn;
-  // Get the load pointer before extending the buffer.
   char* loadPtr;
+  const char* src = (const char*)value;
+  shared_int srcOffset;
+  bool srcInternal;
 
   LOG_COMM("Executing byte array load through void*, size: %d", byte_size);
   // Check inputs
@@ -195,9 +268,18 @@ bool ByteArray::load(void* value, const shared_int byte_size)
     return false;
   }
 
-  loadPtr = this->getLoadPtr();
+  // Get the load pointer (which grows the buffer as required) before
+  // extending the buffer.  If the value is held within this byte array
+  // (i.e. an array loaded into itself) it moves along with the buffer.
+  srcInternal = (src >= this->getRawDataPtr()) && (src < this->getLoadPtr());
+  srcOffset = src - this->getRawDataPtr();
+  loadPtr = this->getLoadPtr(byte_size);
+  if (srcInternal)
+  {
+    value = &this->buffer_[srcOffset];
+  }
 
-  if (this->extendBufferSize(byte_size))
+  if ((NULL != loadPtr) && this->extendBufferSize(byte_size))
   {
     memcpy(loadPtr, value, byte_size);
     rtn = true;
@@ -286,6 +368,35 @@ bool ByteArray::unload(ByteArray &value, const shared_int byte_size)
   return rtn;
 }
 
+bool ByteArray::unload(ByteArrayReader &value, const shared_int byte_size)
+{
+  LOG_COMM("Executing byte array unload through byte array reader");
+  char* unloadPtr = this->getUnloadPtr(byte_size);
+  bool rtn;
+
+  if (NULL != unloadPtr)
+  {
+    if (this->shortenBufferSize(byte_size))
+    {
+      // The unloaded data remains in the buffer (until overwritten by a load)
+      value.init(unloadPtr, byte_size);
+      rtn = true;
+    }
+    else
+    {
+      LOG_ERROR("Failed to shorten array");
+      rtn = false;
+    }
+  }
+  else
+  {
+    LOG_ERROR("Unload pointer returned NULL");
+    rtn = false;
+  }
+
+  return rtn;
+}
+
 bool ByteArray::unload(void* value, shared_int byteSize)
 {
   bool rtn;
@@ -422,14 +533,65 @@ bool ByteArray::isByteSwapEnabled()
   return false;
 }
 
+bool ByteArray::reserve(shared_int size)
+{
+#ifdef FIXED_SIZE_BUFFERS
+  return (this->MAX_SIZE >= size);
+#else
+  shared_int newCapacity;
+  char* newBuffer;
+
+  if (this->buffer_capacity_ >= size)
+  {
+    return true;
+  }
+  if (this->MAX_SIZE < size)
+  {
+    return false;
+  }
+
+  // Grow geometrically (limited to MAX) to avoid repeated allocations while
+  // a large buffer is loaded piece by piece.
+  newCapacity = 2 * this->buffer_capacity_;
+  if (newCapacity < size)
+  {
+    newCapacity = size;
+  }
+  if (newCapacity > this->MAX_SIZE)
+  {
+    newCapacity = this->MAX_SIZE;
+  }
+
+  newBuffer = new (std::nothrow) char[newCapacity];
+  if (NULL == newBuffer)
+  {
+    LOG_ERROR("Failed to allocate byte array buffer, size: %d", newCapacity);
+    return false;
+  }
+  LOG_COMM("Growing byte array buffer from: %d to: %d", this->buffer_capacity_, newCapacity);
+
+  memcpy(newBuffer, this->buffer_, this->buffer_size_);
+  if (this->buffer_ != &this->inline_buffer_[0])
+  {
+    delete[] this->buffer_;
+  }
+  this->buffer_ = newBuffer;
+  this->buffer_capacity_ = newCapacity;
+  return true;
+#endif
+}
+
 bool ByteArray::setBufferSize(shared_int size)
 {
   bool rtn;
 
   if (this->MAX_SIZE >= size)
   {
-    this->buffer_size_ = size;
-    rtn = true;
+    rtn = this->reserve(size);
+    if (rtn)
+    {
+      this->buffer_size_ = size;
+    }
   }
   else
   {
@@ -450,6 +612,23 @@ bool ByteArray::extendBufferSize(shared_int size)
 
 }
 
+bool ByteArray::truncate(shared_int size)
+{
+  bool rtn;
+
+  if ((size >= 0) && (size <= (shared_int)this->getBufferSize()))
+  {
+    rtn = this->setBufferSize(size);
+  }
+  else
+  {
+    LOG_ERROR("Failed to truncate buffer to %d bytes, buffer size: %u", size, this->getBufferSize());
+    rtn = false;
+  }
+
+  return rtn;
+}
+
 bool ByteArray::shortenBufferSize(shared_int size)
 {
   unsigned int newSize;
@@ -480,6 +659,24 @@ char* ByteArray::getLoadPtr()
   return &this->buffer_[this->buffer_size_];
 }
 
+char* ByteArray::getLoadPtr(const shared_int num_bytes)
+{
+  char* rtn;
+
+  if ((num_bytes >= 0) && this->reserve(this->buffer_size_ + num_bytes))
+  {
+    rtn = this->getLoadPtr();
+  }
+  else
+  {
+    LOG_ERROR("Get load pointer failed, buffer size: %d, plus byte size: %d, larger than MAX: %d",
+              this->getBufferSize(), num_bytes, this->MAX_SIZE);
+    rtn = NULL;
+  }
+
+  return rtn;
+}
+
 char* ByteArray::getUnloadPtr(shared_int byteSize)
 {
   char* rtn;
@@ -498,5 +695,125 @@ char* ByteArray::getUnloadPtr(shared_int byteSize)
   return rtn;
 }
 
+/****************************************************************
+ // ByteArrayReader
+ //
+ // Methods for unloading various data types in the forward direction.
+ // Unloading data only advances the read position, the data itself
+ // is left untouched.
+ //
+ */
+ByteArrayReader::ByteArrayReader(void)
+{
+  this->init(NULL, 0);
+}
+
+ByteArrayReader::ByteArrayReader(ByteArray & buffer)
+{
+  this->init(buffer);
+}
+
+ByteArrayReader::~ByteArrayReader(void)
+{
+}
+
+void ByteArrayReader::init(ByteArray & buffer)
+{
+  this->init(buffer.getRawDataPtr(), buffer.getBufferSize());
+}
+
+void ByteArrayReader::init(const char* buffer, const shared_int byte_size)
+{
+  this->buffer_ = buffer;
+  this->buffer_size_ = byte_size;
+  this->read_pos_ = 0;
+}
+
+bool ByteArrayReader::unload(shared_bool &value)
+{
+  return this->unload(&value, sizeof(shared_bool));
+}
+
+bool ByteArrayReader::unload(shared_real &value)
+{
+  bool rtn = this->unload(&value, sizeof(shared_real));
+
+#ifdef BYTE_SWAPPING
+  ByteArray::swap(&value, sizeof(shared_real));
+#endif
+
+  return rtn;
+}
+
+bool ByteArrayReader::unload(shared_int &value)
+{
+  bool rtn = this->unload(&value, sizeof(shared_int));
+
+#ifdef BYTE_SWAPPING
+  ByteArray::swap(&value, sizeof(shared_int));
+#endif
+
+  return rtn;
+}
+
+bool ByteArrayReader::unload(simple_serialize::SimpleSerialize &value)
+{
+  LOG_COMM("Executing byte array reader unload through simple serialize");
+  return value.unload(this);
+}
+
+bool ByteArrayReader::unload(ByteArray &value, const shared_int byte_size)
+{
+  bool rtn;
+
+  LOG_COMM("Executing byte array reader unload through byte array");
+  if ((byte_size >= 0) && (byte_size <= (shared_int)this->getRemainSize()))
+  {
+    rtn = value.load((void*)&this->buffer_[this->read_pos_], byte_size);
+    if (rtn)
+    {
+      this->read_pos_ += byte_size;
+    }
+  }
+  else
+  {
+    LOG_ERROR("Failed to unload %d bytes, only %u bytes remain", byte_size, this->getRemainSize());
+    rtn = false;
+  }
+
+  return rtn;
+}
+
+bool ByteArrayReader::unload(void* value, const shared_int byte_size)
+{
+  bool rtn;
+
+  // Check inputs
+  if (NULL == value)
+  {
+    LOG_ERROR("NULL point passed into unload method");
+    return false;
+  }
+
+  if ((byte_size >= 0) && (byte_size <= (shared_int)this->getRemainSize()))
+  {
+    memcpy(value, &this->buffer_[this->read_pos_], byte_size);
+    this->read_pos_ += byte_size;
+    rtn = true;
+  }
+  else
+  {
+    LOG_ERROR("Failed to unload %d bytes, only %u bytes remain", byte_size, this->getRemainSize());
+    rtn = false;
+  }
+
+  return rtn;
+}
+
+unsigned int ByteArrayReader::getRemainSize()
+{
+  return this->buffer_size_ - this->read_pos_;
+}
+
 } // namespace byte_array
 } // namespace industrial
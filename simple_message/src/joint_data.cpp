@@ -39,6 +39,7 @@
 #endif
 
 using namespace industrial::shared_types;
+using namespace industrial::byte_array;
 
 namespace industrial
 {
@@ -47,6 +48,7 @@ namespace joint_data
 
 JointData::JointData(void)
 {
+  this->num_joints_ = this->DEFAULT_NUM_JOINTS;
   this->init();
 }
 JointData::~JointData(void)
@@ -56,17 +58,50 @@ JointData::~JointData(void)
 
 void JointData::init()
 {
-  for (int i = 0; i < this->getMaxNumJoints(); i++)
+  for (int i = 0; i < this->MAX_NUM_JOINTS; i++)
+  {
+    this->joints_[i] = 0.0;
+  }
+}
+
+bool JointData::setNumJoints(shared_int num_joints)
+{
+  bool rtn = false;
+
+  if (num_joints >= 0 && num_joints <= this->MAX_NUM_JOINTS)
+  {
+    this->num_joints_ = num_joints;
+    rtn = true;
+  }
+  else
   {
-    this->setJoint(i, 0.0);
+    LOG_ERROR("Number of joints: %d, is greater than max: %d", num_joints, this->MAX_NUM_JOINTS);
+    rtn = false;
   }
+  return rtn;
+}
+
+bool JointData::numJointsFromLength(unsigned int byte_length, unsigned int fixed_length,
+                                    unsigned int num_data, shared_int & num_joints)
+{
+  unsigned int jointLength = num_data * sizeof(shared_real);
+
+  if (byte_length < fixed_length || 0 == jointLength || (byte_length - fixed_length) % jointLength != 0
+      || (byte_length - fixed_length) / jointLength > (unsigned int)MAX_NUM_JOINTS)
+  {
+    LOG_ERROR("Data length: %u, does not match a valid number of joints", byte_length);
+    return false;
+  }
+
+  num_joints = (byte_length - fixed_length) / jointLength;
+  return true;
 }
 
 bool JointData::setJoint(shared_int index, shared_real value)
 {
   bool rtn = false;
 
-  if (index < this->getMaxNumJoints())
+  if (index >= 0 && index < this->getMaxNumJoints())
   {
     this->joints_[index] = value;
     rtn = true;
@@ -83,7 +118,7 @@ bool JointData::getJoint(shared_int index, shared_real & value) const
 {
   bool rtn = false;
 
-  if (index < this->getMaxNumJoints())
+  if (index >= 0 && index < this->getMaxNumJoints())
   {
     value = this->joints_[index];
     rtn = true;
@@ -106,12 +141,10 @@ shared_real JointData::getJoint(shared_int index) const
 
 void JointData::copyFrom(JointData &src)
 {
-  shared_real value = 0.0;
-
+  this->num_joints_ = src.num_joints_;
   for (int i = 0; i < this->getMaxNumJoints(); i++)
   {
-    src.getJoint(i, value);
-    this->setJoint(i, value);
+    this->joints_[i] = src.joints_[i];
   }
 }
 
@@ -121,6 +154,11 @@ bool JointData::operator==(JointData &rhs)
 
   shared_real lhsvalue, rhsvalue;
 
+  if (this->getMaxNumJoints() != rhs.getMaxNumJoints())
+  {
+    return false;
+  }
+
   for (int i = 0; i < this->getMaxNumJoints(); i++)
   {
     this->getJoint(i, lhsvalue);
@@ -137,7 +175,7 @@ bool JointData::operator==(JointData &rhs)
 
 bool JointData::load(industrial::byte_array::ByteArray *buffer)
 {
-  bool rtn = false;
+  bool rtn = true;
   shared_real value = 0.0;
 
   LOG_COMM("Executing joint position load");
@@ -157,15 +195,34 @@ bool JointData::load(industrial::byte_array::ByteArray *buffer)
 bool JointData::unload(industrial::byte_array::ByteArray *buffer)
 {
   bool rtn = false;
+  ByteArrayReader reader;
+
+  LOG_COMM("Executing joint position unload");
+  // The joint data is at the end of the buffer, it is read forward (in place)
+  if (buffer->unload(reader, this->byteLength()))
+  {
+    rtn = this->unload(&reader);
+  }
+  else
+  {
+    LOG_ERROR("Failed to unload joint position data from data[%d]", buffer->getBufferSize());
+    rtn = false;
+  }
+  return rtn;
+}
+
+bool JointData::unload(industrial::byte_array::ByteArrayReader *buffer)
+{
+  bool rtn = true;
   shared_real value = 0.0;
 
   LOG_COMM("Executing joint position unload");
-  for (int i = this->getMaxNumJoints() - 1; i >= 0; i--)
+  for (int i = 0; i < this->getMaxNumJoints(); i++)
   {
     rtn = buffer->unload(value);
     if (!rtn)
     {
-      LOG_ERROR("Failed to unload message joint: %d from data[%d]", i, buffer->getBufferSize());
+      LOG_ERROR("Failed to unload message joint: %d from data[%d]", i, buffer->getRemainSize());
       break;
     }
     this->setJoint(i, value);
@@ -40,6 +40,7 @@
 
 using namespace industrial::joint_data;
 using namespace industrial::shared_types;
+using namespace industrial::byte_array;
 
 namespace industrial
 {
@@ -80,6 +81,21 @@ void JointFeedback::init(industrial::shared_types::shared_int robot_id,
   this->valid_fields_ = valid_fields;  // must happen after others are set
 }
 
+bool JointFeedback::setNumJoints(shared_int num_joints)
+{
+  return this->positions_.setNumJoints(num_joints) &&
+         this->velocities_.setNumJoints(num_joints) &&
+         this->accelerations_.setNumJoints(num_joints);
+}
+
+bool JointFeedback::setNumJointsFromLength(unsigned int byte_length)
+{
+  shared_int numJoints = 0;
+  unsigned int fixedLength = this->byteLength() - 3 * this->positions_.byteLength();
+
+  return JointData::numJointsFromLength(byte_length, fixedLength, 3, numJoints) && this->setNumJoints(numJoints);
+}
+
 void JointFeedback::copyFrom(JointFeedback &src)
 {
   this->setRobotID(src.getRobotID());
@@ -104,6 +120,9 @@ bool JointFeedback::load(industrial::byte_array::ByteArray *buffer)
 {
   LOG_COMM("Executing joint feedback load");
 
+  // All joint data is serialized with the number of joints of the positions
+  this->setNumJoints(this->positions_.getMaxNumJoints());
+
   if (!buffer->load(this->robot_id_))
   {
     LOG_ERROR("Failed to load joint feedback robot_id");
@@ -146,23 +165,33 @@ bool JointFeedback::load(industrial::byte_array::ByteArray *buffer)
 
 bool JointFeedback::unload(industrial::byte_array::ByteArray *buffer)
 {
+  ByteArrayReader reader;
+
   LOG_COMM("Executing joint feedback unload");
 
-  if (!this->accelerations_.unload(buffer))
+  // The feedback is at the end of the buffer, it is read forward (in place)
+  if (!buffer->unload(reader, this->byteLength()))
   {
-    LOG_ERROR("Failed to unload joint feedback accelerations");
+    LOG_ERROR("Failed to unload joint feedback from data[%d]", buffer->getBufferSize());
     return false;
   }
 
-  if (!this->velocities_.unload(buffer))
+  return this->unload(&reader);
+}
+
+bool JointFeedback::unload(industrial::byte_array::ByteArrayReader *buffer)
+{
+  LOG_COMM("Executing joint feedback unload");
+
+  if (!buffer->unload(this->robot_id_))
   {
-    LOG_ERROR("Failed to unload joint feedback velocities");
+    LOG_ERROR("Faild to unload joint feedback robot_id");
     return false;
   }
 
-  if (!this->positions_.unload(buffer))
+  if (!buffer->unload(this->valid_fields_))
   {
-    LOG_ERROR("Failed to unload joint feedback positions");
+    LOG_ERROR("Failed to unload joint feedback valid fields");
     return false;
   }
 
@@ -172,15 +201,21 @@ bool JointFeedback::unload(industrial::byte_array::ByteArray *buffer)
     return false;
   }
 
-  if (!buffer->unload(this->valid_fields_))
+  if (!this->positions_.unload(buffer))
   {
-    LOG_ERROR("Failed to unload joint feedback valid fields");
+    LOG_ERROR("Failed to unload joint feedback positions");
     return false;
   }
 
-  if (!buffer->unload(this->robot_id_))
+  if (!this->velocities_.unload(buffer))
   {
-    LOG_ERROR("Faild to unload joint feedback robot_id");
+    LOG_ERROR("Failed to unload joint feedback velocities");
+    return false;
+  }
+
+  if (!this->accelerations_.unload(buffer))
+  {
+    LOG_ERROR("Failed to unload joint feedback accelerations");
     return false;
   }
 
@@ -38,8 +38,14 @@
 #include "log_wrapper.h"
 #endif
 
+#ifndef FIXED_SIZE_BUFFERS
+#include <new>
+#endif
+
 using namespace industrial::shared_types;
 using namespace industrial::joint_traj_pt;
+using namespace industrial::byte_array;
+using namespace industrial::simple_message;
 
 namespace industrial
 {
@@ -48,29 +54,157 @@ namespace joint_traj
 
 JointTraj::JointTraj(void)
 {
+	JointTrajPt pt;
+
+#ifndef FIXED_SIZE_BUFFERS
+	this->points_ = NULL;
+	this->capacity_ = 0;
+#endif
+	this->num_joints_ = pt.getNumJoints();
 	this->init();
 }
+
+JointTraj::JointTraj(const JointTraj &src)
+{
+#ifndef FIXED_SIZE_BUFFERS
+	this->points_ = NULL;
+	this->capacity_ = 0;
+#endif
+	this->num_joints_ = src.num_joints_;
+	this->init();
+	*this = src;
+}
+
 JointTraj::~JointTraj(void)
 {
+#ifndef FIXED_SIZE_BUFFERS
+	delete[] this->points_;
+#endif
+}
 
+JointTraj & JointTraj::operator=(const JointTraj &rhs)
+{
+	// JointTrajPt::copyFrom takes a non-const reference (the source is not modified)
+	JointTraj &src = const_cast<JointTraj &>(rhs);
+
+	if (this != &src)
+	{
+		this->size_ = 0;
+		this->num_joints_ = src.num_joints_;
+	}
+	if (this != &src && this->reserve(src.size_))
+	{
+		this->size_ = src.size_;
+		for (shared_int i = 0; i < this->size_; i++)
+		{
+			this->points_[i].copyFrom(src.points_[i]);
+		}
+	}
+	return *this;
 }
 
 void JointTraj::init()
 {
-	JointTrajPt empty;
-
+	// Points are initialized when they are added/unloaded
 	this->size_ = 0;
-	for (shared_int i = 0; i < this->getMaxNumPoints(); i++)
+}
+
+int JointTraj::getMaxNumPoints() const
+{
+	ByteArray msgData;
+	JointTrajPt pt;
+	shared_int maxMsgPoints;
+
+	pt.setNumJoints(this->num_joints_);
+
+	// The trajectory (and the message prefix/header) must fit in a single message
+	maxMsgPoints = (msgData.getMaxBufferSize() - SimpleMessage::getLengthSize() - SimpleMessage::getHeaderSize()
+			- sizeof(shared_int)) / pt.byteLength();
+
+#ifdef FIXED_SIZE_BUFFERS
+	return (maxMsgPoints < this->MAX_NUM_POINTS) ? maxMsgPoints : this->MAX_NUM_POINTS;
+#else
+	return maxMsgPoints;
+#endif
+}
+
+bool JointTraj::reserve(shared_int size)
+{
+#ifdef FIXED_SIZE_BUFFERS
+	return (this->MAX_NUM_POINTS >= size);
+#else
+	shared_int newCapacity;
+	JointTrajPt* newPoints;
+
+	if (this->capacity_ >= size)
+	{
+		return true;
+	}
+	if (this->getMaxNumPoints() < size)
+	{
+		return false;
+	}
+
+	// Grow geometrically (limited to max) to avoid repeated allocations while
+	// a trajectory is built point by point.
+	newCapacity = 2 * this->capacity_;
+	if (newCapacity < size)
+	{
+		newCapacity = size;
+	}
+	if (newCapacity > this->getMaxNumPoints())
+	{
+		newCapacity = this->getMaxNumPoints();
+	}
+
+	newPoints = new (std::nothrow) JointTrajPt[newCapacity];
+	if (NULL == newPoints)
 	{
-		this->points_[i].copyFrom(empty);
+		LOG_ERROR("Failed to allocate joint trajectory buffer, size: %d", newCapacity);
+		return false;
 	}
+	LOG_COMM("Growing joint trajectory buffer from: %d to: %d", this->capacity_, newCapacity);
+
+	for (shared_int i = 0; i < this->size_; i++)
+	{
+		newPoints[i].copyFrom(this->points_[i]);
+	}
+	delete[] this->points_;
+	this->points_ = newPoints;
+	this->capacity_ = newCapacity;
+	return true;
+#endif
+}
+
+bool JointTraj::setNumJoints(shared_int num_joints)
+{
+	JointTrajPt pt;
+	bool rtn = pt.setNumJoints(num_joints);
+
+	if (rtn)
+	{
+		this->num_joints_ = num_joints;
+	}
+	return rtn;
 }
 
 bool JointTraj::addPoint(JointTrajPt & point)
 {
 	bool rtn = false;
 
-	if (!this->isFull())
+	// The first point determines the number of joints (of all points)
+	if (0 == this->size())
+	{
+		this->num_joints_ = point.getNumJoints();
+	}
+	if (point.getNumJoints() != this->num_joints_)
+	{
+		LOG_ERROR("Failed to add point, number of joints: %d, does not match trajectory: %d",
+				point.getNumJoints(), this->num_joints_);
+		return false;
+	}
+
+	if (!this->isFull() && this->reserve(this->size() + 1))
 	{
 		this->points_[this->size()].copyFrom(point);
 		this->size_++;
@@ -104,14 +238,7 @@ bool JointTraj::getPoint(shared_int index, JointTrajPt & point)
 
 void JointTraj::copyFrom(JointTraj &src)
 {
-	JointTrajPt value;
-
-	this->size_ = src.size();
-	for (shared_int i = 0; i < this->size(); i++)
-	{
-		src.getPoint(i, value);
-		this->points_[i].copyFrom(value);
-	}
+	*this = src;
 }
 
 bool JointTraj::operator==(JointTraj &rhs)
@@ -122,9 +249,7 @@ bool JointTraj::operator==(JointTraj &rhs)
 	{
 		for(shared_int i = 0; i < this->size(); i++)
 		{
-			JointTrajPt value;
-			rhs.getPoint(i, value);
-			if(!(this->points_[i] == value))
+			if(!(this->points_[i] == rhs.points_[i]))
 			{
 				LOG_DEBUG("Joint trajectory point different");
 				rtn = false;
@@ -148,21 +273,17 @@ bool JointTraj::operator==(JointTraj &rhs)
 
 bool JointTraj::load(industrial::byte_array::ByteArray *buffer)
 {
-	bool rtn = false;
-	JointTrajPt value;
+	bool rtn = true;
 
 	LOG_COMM("Executing joint trajectory load");
 	for (shared_int i = 0; i < this->size(); i++)
 	{
-		this->getPoint(i, value);
-		rtn = buffer->load(value);
+		rtn = buffer->load(this->points_[i]);
 		if (!rtn)
 		{
 			LOG_ERROR("Failed to load joint traj.pt. data");
-			rtn = false;
 			break;
 		}
-		rtn = true;
 	}
 
 	if (rtn)
@@ -175,23 +296,66 @@ bool JointTraj::load(industrial::byte_array::ByteArray *buffer)
 bool JointTraj::unload(industrial::byte_array::ByteArray *buffer)
 {
 	bool rtn = false;
+	ByteArrayReader reader;
 	JointTrajPt value;
+	shared_int size = 0;
+
+	value.setNumJoints(this->num_joints_);
 
 	LOG_COMM("Executing joint trajectory unload");
 
-	rtn = buffer->unload(this->size_);
+	rtn = buffer->unload(size);
 
 	if(rtn)
 	{
-		for (int i = this->size() - 1; i >= 0; i--)
+		// The points are at the end of the buffer, they are read forward (in place)
+		if (size < 0 || size > this->getMaxNumPoints())
+		{
+			LOG_ERROR("Invalid trajectory size: %d", size);
+			rtn = false;
+		}
+		else if (!buffer->unload(reader, size * value.byteLength()))
+		{
+			LOG_ERROR("Failed to unload trajectory points from data[%d]", buffer->getBufferSize());
+			rtn = false;
+		}
+		else
+		{
+			rtn = this->unloadPoints(&reader, size);
+		}
+	}
+	else
+	{
+		LOG_ERROR("Failed to unload trajectory size");
+	}
+	return rtn;
+}
+
+bool JointTraj::unload(industrial::byte_array::ByteArrayReader *buffer)
+{
+	bool rtn = false;
+	JointTrajPt value;
+	shared_int size = 0;
+
+	value.setNumJoints(this->num_joints_);
+
+	LOG_COMM("Executing joint trajectory unload");
+
+	// The trajectory size is loaded after the points.  The number of points
+	// is determined from the remaining data size (and checked against the
+	// trajectory size).
+	if (buffer->getRemainSize() >= sizeof(shared_int))
+	{
+		size = (buffer->getRemainSize() - sizeof(shared_int)) / value.byteLength();
+		rtn = this->unloadPoints(buffer, size);
+		if (rtn)
 		{
-			rtn = buffer->unload(value);
-			if (!rtn)
+			rtn = buffer->unload(size);
+			if (!rtn || size != this->size())
 			{
-				LOG_ERROR("Failed to unload message point: %d from data[%d]", i, buffer->getBufferSize());
-				break;
+				LOG_ERROR("Failed to unload trajectory size (or size mismatch): %d", size);
+				rtn = false;
 			}
-			this->points_[i].copyFrom(value);
 		}
 	}
 	else
@@ -201,6 +365,35 @@ bool JointTraj::unload(industrial::byte_array::ByteArray *buffer)
 	return rtn;
 }
 
+bool JointTraj::unloadPoints(industrial::byte_array::ByteArrayReader *buffer, shared_int size)
+{
+	bool rtn = true;
+
+	if (size < 0 || size > this->getMaxNumPoints())
+	{
+		LOG_ERROR("Invalid trajectory size: %d", size);
+		return false;
+	}
+
+	this->size_ = 0;
+	if (!this->reserve(size))
+	{
+		return false;
+	}
+	for (shared_int i = 0; i < size; i++)
+	{
+		this->points_[i].setNumJoints(this->num_joints_);
+		rtn = buffer->unload(this->points_[i]);
+		if (!rtn)
+		{
+			LOG_ERROR("Failed to unload message point: %d from data[%d]", i, buffer->getRemainSize());
+			break;
+		}
+		this->size_ = i + 1;
+	}
+	return rtn;
+}
+
 }
 }
 
@@ -0,0 +1,300 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2013, Southwest Research Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 	* Redistributions of source code must retain the above copyright
+ * 	notice, this list of conditions and the following disclaimer.
+ * 	* Redistributions in binary form must reproduce the above copyright
+ * 	notice, this list of conditions and the following disclaimer in the
+ * 	documentation and/or other materials provided with the distribution.
+ * 	* Neither the name of the Southwest Research Institute, nor the names
+ *	of its contributors may be used to endorse or promote products derived
+ *	from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FLATHEADERS
+#include "simple_message/joint_traj_full.h"
+#include "simple_message/shared_types.h"
+#include "simple_message/log_wrapper.h"
+#else
+#include "joint_traj_full.h"
+#include "shared_types.h"
+#include "log_wrapper.h"
+#endif
+
+using namespace industrial::shared_types;
+using namespace industrial::joint_traj_pt_full;
+using namespace industrial::byte_array;
+using namespace industrial::simple_message;
+
+namespace industrial
+{
+namespace joint_traj_full
+{
+
+JointTrajFull::JointTrajFull(void)
+{
+  JointTrajPtFull pt;
+
+  this->num_joints_ = pt.getNumJoints();
+  this->init();
+}
+JointTrajFull::~JointTrajFull(void)
+{
+
+}
+
+void JointTrajFull::init()
+{
+  // Points are initialized when they are added/unloaded
+  this->size_ = 0;
+}
+
+shared_int JointTrajFull::getMaxNumPoints()
+{
+  ByteArray msgData;
+  JointTrajPtFull pt;
+  shared_int maxMsgPoints;
+
+  pt.setNumJoints(this->num_joints_);
+
+  // The trajectory (and the message prefix/header) must fit in a single message
+  maxMsgPoints = (msgData.getMaxBufferSize() - SimpleMessage::getLengthSize() - SimpleMessage::getHeaderSize()
+      - sizeof(shared_int)) / pt.byteLength();
+
+  return (maxMsgPoints < this->MAX_NUM_POINTS) ? maxMsgPoints : this->MAX_NUM_POINTS;
+}
+
+bool JointTrajFull::setNumJoints(shared_int num_joints)
+{
+  JointTrajPtFull pt;
+  bool rtn = pt.setNumJoints(num_joints);
+
+  if (rtn)
+  {
+    this->num_joints_ = num_joints;
+  }
+  return rtn;
+}
+
+bool JointTrajFull::addPoint(JointTrajPtFull & point)
+{
+  bool rtn = false;
+
+  // The first point determines the number of joints (of all points)
+  if (0 == this->size())
+  {
+    this->num_joints_ = point.getNumJoints();
+  }
+  if (point.getNumJoints() != this->num_joints_)
+  {
+    LOG_ERROR("Failed to add point, number of joints: %d, does not match trajectory: %d",
+        point.getNumJoints(), this->num_joints_);
+    return false;
+  }
+
+  if (!this->isFull())
+  {
+    this->points_[this->size()].copyFrom(point);
+    this->size_++;
+    rtn = true;
+  }
+  else
+  {
+    rtn = false;
+    LOG_ERROR("Failed to add point, buffer is full");
+  }
+
+  return rtn;
+}
+
+bool JointTrajFull::getPoint(shared_int index, JointTrajPtFull & point)
+{
+  bool rtn = false;
+
+  if (index < this->size())
+  {
+    point.copyFrom(this->points_[index]);
+    rtn = true;
+  }
+  else
+  {
+    LOG_ERROR("Point index: %d, is greater than size: %d", index, this->size());
+    rtn = false;
+  }
+  return rtn;
+}
+
+void JointTrajFull::copyFrom(JointTrajFull &src)
+{
+  this->num_joints_ = src.num_joints_;
+  this->size_ = src.size();
+  for (shared_int i = 0; i < this->size(); i++)
+  {
+    this->points_[i].copyFrom(src.points_[i]);
+  }
+}
+
+bool JointTrajFull::operator==(JointTrajFull &rhs)
+{
+  bool rtn = true;
+
+  if (this->size() == rhs.size())
+  {
+    for (shared_int i = 0; i < this->size(); i++)
+    {
+      if (!(this->points_[i] == rhs.points_[i]))
+      {
+        LOG_DEBUG("Joint trajectory point different");
+        rtn = false;
+        break;
+      }
+    }
+  }
+  else
+  {
+    LOG_DEBUG("Joint trajectory compare failed, size mismatch");
+    rtn = false;
+  }
+
+  return rtn;
+}
+
+bool JointTrajFull::load(industrial::byte_array::ByteArray *buffer)
+{
+  bool rtn = true;
+
+  LOG_COMM("Executing joint trajectory full load");
+  for (shared_int i = 0; i < this->size(); i++)
+  {
+    rtn = buffer->load(this->points_[i]);
+    if (!rtn)
+    {
+      LOG_ERROR("Failed to load joint traj. pt. full data");
+      break;
+    }
+  }
+
+  if (rtn)
+  {
+    rtn = buffer->load(this->size());
+  }
+  return rtn;
+}
+
+bool JointTrajFull::unload(industrial::byte_array::ByteArray *buffer)
+{
+  bool rtn = false;
+  ByteArrayReader reader;
+  JointTrajPtFull value;
+  shared_int size = 0;
+
+  value.setNumJoints(this->num_joints_);
+
+  LOG_COMM("Executing joint trajectory full unload");
+
+  rtn = buffer->unload(size);
+
+  if (rtn)
+  {
+    // The points are at the end of the buffer, they are read forward (in place)
+    if (size < 0 || size > this->getMaxNumPoints())
+    {
+      LOG_ERROR("Invalid trajectory size: %d", size);
+      rtn = false;
+    }
+    else if (!buffer->unload(reader, size * value.byteLength()))
+    {
+      LOG_ERROR("Failed to unload trajectory points from data[%d]", buffer->getBufferSize());
+      rtn = false;
+    }
+    else
+    {
+      rtn = this->unloadPoints(&reader, size);
+    }
+  }
+  else
+  {
+    LOG_ERROR("Failed to unload trajectory size");
+  }
+  return rtn;
+}
+
+bool JointTrajFull::unload(industrial::byte_array::ByteArrayReader *buffer)
+{
+  bool rtn = false;
+  JointTrajPtFull value;
+  shared_int size = 0;
+
+  value.setNumJoints(this->num_joints_);
+
+  LOG_COMM("Executing joint trajectory full unload");
+
+  // The trajectory size is loaded after the points.  The number of points
+  // is determined from the remaining data size (and checked against the
+  // trajectory size).
+  if (buffer->getRemainSize() >= sizeof(shared_int))
+  {
+    size = (buffer->getRemainSize() - sizeof(shared_int)) / value.byteLength();
+    rtn = this->unloadPoints(buffer, size);
+    if (rtn)
+    {
+      rtn = buffer->unload(size);
+      if (!rtn || size != this->size())
+      {
+        LOG_ERROR("Failed to unload trajectory size (or size mismatch): %d", size);
+        rtn = false;
+      }
+    }
+  }
+  else
+  {
+    LOG_ERROR("Failed to unload trajectory size");
+  }
+  return rtn;
+}
+
+bool JointTrajFull::unloadPoints(industrial::byte_array::ByteArrayReader *buffer, shared_int size)
+{
+  bool rtn = true;
+
+  if (size < 0 || size > this->getMaxNumPoints())
+  {
+    LOG_ERROR("Invalid trajectory size: %d", size);
+    return false;
+  }
+
+  this->size_ = 0;
+  for (shared_int i = 0; i < size; i++)
+  {
+    this->points_[i].setNumJoints(this->num_joints_);
+    rtn = buffer->unload(this->points_[i]);
+    if (!rtn)
+    {
+      LOG_ERROR("Failed to unload message point: %d from data[%d]", i, buffer->getRemainSize());
+      break;
+    }
+    this->size_ = i + 1;
+  }
+  return rtn;
+}
+
+}
+}
+
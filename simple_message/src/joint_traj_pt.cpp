@@ -40,6 +40,7 @@
 
 using namespace industrial::joint_data;
 using namespace industrial::shared_types;
+using namespace industrial::byte_array;
 
 namespace industrial
 {
@@ -71,6 +72,19 @@ void JointTrajPt::init(shared_int sequence, JointData & position, shared_real ve
   this->setDuration(duration);
 }
 
+bool JointTrajPt::setNumJoints(shared_int num_joints)
+{
+  return this->joint_position_.setNumJoints(num_joints);
+}
+
+bool JointTrajPt::setNumJointsFromLength(unsigned int byte_length)
+{
+  shared_int numJoints = 0;
+  unsigned int fixedLength = this->byteLength() - this->joint_position_.byteLength();
+
+  return JointData::numJointsFromLength(byte_length, fixedLength, 1, numJoints) && this->setNumJoints(numJoints);
+}
+
 void JointTrajPt::copyFrom(JointTrajPt &src)
 {
   this->setSequence(src.getSequence());
@@ -133,43 +147,63 @@ bool JointTrajPt::load(industrial::byte_array::ByteArray *buffer)
 }
 
 bool JointTrajPt::unload(industrial::byte_array::ByteArray *buffer)
+{
+  bool rtn = false;
+  ByteArrayReader reader;
+
+  LOG_COMM("Executing joint traj. pt. unload");
+  // The point is at the end of the buffer, it is read forward (in place)
+  if (buffer->unload(reader, this->byteLength()))
+  {
+    rtn = this->unload(&reader);
+  }
+  else
+  {
+    LOG_ERROR("Failed to unload joint traj. pt. from data[%d]", buffer->getBufferSize());
+    rtn = false;
+  }
+
+  return rtn;
+}
+
+bool JointTrajPt::unload(industrial::byte_array::ByteArrayReader *buffer)
 {
   bool rtn = false;
 
   LOG_COMM("Executing joint traj. pt. unload");
-  if (buffer->unload(this->duration_))
+  if (buffer->unload(this->sequence_))
   {
-    if (buffer->unload(this->velocity_))
+    if (this->joint_position_.unload(buffer))
     {
-      if (this->joint_position_.unload(buffer))
+      if (buffer->unload(this->velocity_))
       {
-        if (buffer->unload(this->sequence_))
+        if (buffer->unload(this->duration_))
         {
           rtn = true;
           LOG_COMM("Joint traj. pt successfully unloaded");
         }
         else
         {
-          LOG_ERROR("Failed to unload joint traj. pt. sequence number");
+          LOG_ERROR("Failed to unload joint traj. pt. duration");
           rtn = false;
         }
       }
       else
       {
-        LOG_ERROR("Failed to unload joint traj. pt.  position data");
+        LOG_ERROR("Failed to unload joint traj. pt. velocity");
         rtn = false;
       }
 
     }
     else
     {
-      LOG_ERROR("Failed to unload joint traj. pt. velocity");
+      LOG_ERROR("Failed to unload joint traj. pt.  position data");
       rtn = false;
     }
   }
   else
   {
-    LOG_ERROR("Failed to unload joint traj. pt. duration");
+    LOG_ERROR("Failed to unload joint traj. pt. sequence number");
     rtn = false;
   }
 
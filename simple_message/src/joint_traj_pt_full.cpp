@@ -40,6 +40,7 @@
 
 using namespace industrial::joint_data;
 using namespace industrial::shared_types;
+using namespace industrial::byte_array;
 
 namespace industrial
 {
@@ -83,6 +84,21 @@ void JointTrajPtFull::init(industrial::shared_types::shared_int robot_id,
   this->valid_fields_ = valid_fields;  // must happen after others are set
 }
 
+bool JointTrajPtFull::setNumJoints(shared_int num_joints)
+{
+  return this->positions_.setNumJoints(num_joints) &&
+         this->velocities_.setNumJoints(num_joints) &&
+         this->accelerations_.setNumJoints(num_joints);
+}
+
+bool JointTrajPtFull::setNumJointsFromLength(unsigned int byte_length)
+{
+  shared_int numJoints = 0;
+  unsigned int fixedLength = this->byteLength() - 3 * this->positions_.byteLength();
+
+  return JointData::numJointsFromLength(byte_length, fixedLength, 3, numJoints) && this->setNumJoints(numJoints);
+}
+
 void JointTrajPtFull::copyFrom(JointTrajPtFull &src)
 {
   this->setRobotID(src.getRobotID());
@@ -109,6 +125,9 @@ bool JointTrajPtFull::load(industrial::byte_array::ByteArray *buffer)
 {
   LOG_COMM("Executing joint trajectory point load");
 
+  // All joint data is serialized with the number of joints of the positions
+  this->setNumJoints(this->positions_.getMaxNumJoints());
+
   if (!buffer->load(this->robot_id_))
   {
     LOG_ERROR("Failed to load joint traj pt. robot_id");
@@ -157,23 +176,39 @@ bool JointTrajPtFull::load(industrial::byte_array::ByteArray *buffer)
 
 bool JointTrajPtFull::unload(industrial::byte_array::ByteArray *buffer)
 {
+  ByteArrayReader reader;
+
   LOG_COMM("Executing joint traj. pt. unload");
 
-  if (!this->accelerations_.unload(buffer))
+  // The point is at the end of the buffer, it is read forward (in place)
+  if (!buffer->unload(reader, this->byteLength()))
   {
-    LOG_ERROR("Failed to unload joint traj. pt. accelerations");
+    LOG_ERROR("Failed to unload joint traj. pt. from data[%d]", buffer->getBufferSize());
     return false;
   }
 
-  if (!this->velocities_.unload(buffer))
+  return this->unload(&reader);
+}
+
+bool JointTrajPtFull::unload(industrial::byte_array::ByteArrayReader *buffer)
+{
+  LOG_COMM("Executing joint traj. pt. unload");
+
+  if (!buffer->unload(this->robot_id_))
   {
-    LOG_ERROR("Failed to unload joint traj. pt. velocities");
+    LOG_ERROR("Faild to unload joint traj. pt. robot_id");
     return false;
   }
 
-  if (!this->positions_.unload(buffer))
+  if (!buffer->unload(this->sequence_))
   {
-    LOG_ERROR("Failed to unload joint traj. pt. positions");
+    LOG_ERROR("Failed to unload joint traj. pt. sequence number");
+    return false;
+  }
+
+  if (!buffer->unload(this->valid_fields_))
+  {
+    LOG_ERROR("Failed to unload joint traj. pt. valid fields");
     return false;
   }
 
@@ -183,21 +218,21 @@ bool JointTrajPtFull::unload(industrial::byte_array::ByteArray *buffer)
     return false;
   }
 
-  if (!buffer->unload(this->valid_fields_))
+  if (!this->positions_.unload(buffer))
   {
-    LOG_ERROR("Failed to unload joint traj. pt. valid fields");
+    LOG_ERROR("Failed to unload joint traj. pt. positions");
     return false;
   }
 
-  if (!buffer->unload(this->sequence_))
+  if (!this->velocities_.unload(buffer))
   {
-    LOG_ERROR("Failed to unload joint traj. pt. sequence number");
+    LOG_ERROR("Failed to unload joint traj. pt. velocities");
     return false;
   }
 
-  if (!buffer->unload(this->robot_id_))
+  if (!this->accelerations_.unload(buffer))
   {
-    LOG_ERROR("Faild to unload joint traj. pt. robot_id");
+    LOG_ERROR("Failed to unload joint traj. pt. accelerations");
     return false;
   }
 
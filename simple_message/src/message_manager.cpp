@@ -40,8 +40,10 @@
 
 #ifdef ROS
 #include "ros/ros.h"
-#else
-#include "unistd.h"
+#endif
+
+#ifndef FIXED_SIZE_BUFFERS
+#include <new>
 #endif
 
 using namespace industrial::smpl_msg_connection;
@@ -61,16 +63,23 @@ namespace message_manager
 MessageManager::MessageManager()
 {
   this->num_handlers_ = 0;
-  for (unsigned int i = 0; i < this->getMaxNumHandlers(); i++)
+#ifdef FIXED_SIZE_BUFFERS
+  for (unsigned int i = 0; i < this->getTableSize(); i++)
   {
     this->handlers_[i] = NULL;
   }
+#else
+  this->handlers_ = NULL;
+  this->table_size_ = 0;
+#endif
   this->comms_hndlr_ = NULL;
 }
 
 MessageManager::~MessageManager()
 {
-
+#ifndef FIXED_SIZE_BUFFERS
+  delete[] this->handlers_;
+#endif
 }
 
 bool MessageManager::init(SmplMsgConnection* connection)
@@ -139,6 +148,12 @@ void MessageManager::spinOnce()
     this->getCommsFaultHandler()->connectionFailCB();
   }
 
+  // Queued messages are not held back by a (possibly long) receive
+  if (!this->getConnection()->flushIfDue())
+  {
+    this->getCommsFaultHandler()->sendFailCB();
+  }
+
   if (this->getConnection()->receiveMsg(msg))
   {
     LOG_COMM("Message received");
@@ -168,19 +183,6 @@ void MessageManager::spinOnce()
   }
 }
 
-int ms_per_clock;
-void mySleep(int sec)
-{
-#ifdef MOTOPLUS
-  if (ms_per_clock <= 0)
-    ms_per_clock = mpGetRtc();
-
-  mpTaskDelay(sec * 1000 / ms_per_clock);
-#else
-  sleep(sec);
-#endif
-}
-
 void MessageManager::spin()
 {
   LOG_INFO("Entering message manager spin loop");
@@ -192,9 +194,10 @@ void MessageManager::spin()
   {
     this->spinOnce();
 
-    // Throttle loop speed if waiting for a re-connection
+    // Wait for a re-connection (see SmplMsgConnection::pollConnect), which
+    // also throttles the loop speed while disconnected
     if (!this->getConnection()->isConnected())
-      mySleep(5);
+      this->getConnection()->pollConnect(this->CONNECT_WAIT);
   }
 }
 
@@ -212,9 +215,9 @@ bool MessageManager::add(MessageHandler * handler, bool allow_replace)
     idx = getHandlerIdx(handler->getMsgType());
     if (0 > idx)
     {
-      if (this->getMaxNumHandlers() > this->getNumHandlers())
+      if (this->getMaxNumHandlers() > this->getNumHandlers() && this->reserve(this->getNumHandlers() + 1))
       {
-        this->handlers_[this->getNumHandlers()] = handler;
+        this->handlers_[this->getTableIdx(handler->getMsgType())] = handler;
         this->setNumHandlers(this->getNumHandlers() + 1);
         LOG_INFO("Added message handler for message type: %d", handler->getMsgType());
         rtn = true;
@@ -227,8 +230,9 @@ bool MessageManager::add(MessageHandler * handler, bool allow_replace)
     }
     else if (allow_replace)
     {
-        ROS_WARN("Replaced Handler");
+      LOG_WARN("Replaced handler for message type: %d", handler->getMsgType());
       this->handlers_[idx] = handler;
+      rtn = true;
     }
     else
     {
@@ -262,22 +266,85 @@ MessageHandler* MessageManager::getHandler(int msg_type)
 int MessageManager::getHandlerIdx(int msg_type)
 {
   int rtn = -1;
-  MessageHandler* temp = NULL;
+  unsigned int idx = 0;
 
-  for (unsigned int i = 0; i < this->getMaxNumHandlers(); i++)
+  if (this->getNumHandlers() > 0)
   {
-    temp = this->handlers_[i];
-    if (NULL == temp) break;  // end of handler-list
-
-    if (temp->getMsgType() == msg_type)
+    idx = this->getTableIdx(msg_type);
+    if (NULL != this->handlers_[idx])
     {
-        rtn = i;
-        break;
+      rtn = idx;
     }
   }
 
   return rtn;
 }
 
+unsigned int MessageManager::getTableIdx(int msg_type)
+{
+  unsigned int mask = this->getTableSize() - 1;
+  unsigned int hash = (unsigned int)msg_type * 2654435761U;  // Knuth multiplicative hash
+  unsigned int idx = (hash ^ (hash >> 16)) & mask;
+
+  // Linear probing, the table is never more than half full so an empty entry
+  // always ends the search.
+  while (NULL != this->handlers_[idx] && this->handlers_[idx]->getMsgType() != msg_type)
+  {
+    idx = (idx + 1) & mask;
+  }
+
+  return idx;
+}
+
+bool MessageManager::reserve(unsigned int num_handlers)
+{
+#ifdef FIXED_SIZE_BUFFERS
+  return (this->MAX_NUM_HANDLERS >= num_handlers);
+#else
+  MessageHandler** oldHandlers = this->handlers_;
+  unsigned int oldSize = this->table_size_;
+  unsigned int newSize = (0 == oldSize) ? this->TABLE_SIZE : oldSize;
+
+  if (this->MAX_NUM_HANDLERS < num_handlers)
+  {
+    return false;
+  }
+
+  while (newSize < 2 * num_handlers)
+  {
+    newSize *= 2;
+  }
+  if (newSize == oldSize)
+  {
+    return true;
+  }
+
+  this->handlers_ = new (std::nothrow) MessageHandler*[newSize];
+  if (NULL == this->handlers_)
+  {
+    LOG_ERROR("Failed to allocate handler table, size: %u", newSize);
+    this->handlers_ = oldHandlers;
+    return false;
+  }
+  LOG_COMM("Growing handler table from: %u to: %u", oldSize, newSize);
+
+  // Rebuild the table (handler indices depend on the table size)
+  this->table_size_ = newSize;
+  for (unsigned int i = 0; i < newSize; i++)
+  {
+    this->handlers_[i] = NULL;
+  }
+  for (unsigned int i = 0; i < oldSize; i++)
+  {
+    if (NULL != oldHandlers[i])
+    {
+      this->handlers_[this->getTableIdx(oldHandlers[i]->getMsgType())] = oldHandlers[i];
+    }
+  }
+  delete[] oldHandlers;
+  return true;
+#endif
+}
+
 } // namespace message_manager
 } // namespace industrial
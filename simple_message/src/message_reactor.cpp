@@ -0,0 +1,462 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2013, Southwest Research Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 	* Redistributions of source code must retain the above copyright
+ * 	notice, this list of conditions and the following disclaimer.
+ * 	* Redistributions in binary form must reproduce the above copyright
+ * 	notice, this list of conditions and the following disclaimer in the
+ * 	documentation and/or other materials provided with the distribution.
+ * 	* Neither the name of the Southwest Research Institute, nor the names
+ *	of its contributors may be used to endorse or promote products derived
+ *	from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FLATHEADERS
+#include "simple_message/message_reactor.h"
+#include "simple_message/message_server.h"
+#include "simple_message/log_wrapper.h"
+#else
+#include "message_reactor.h"
+#include "message_server.h"
+#include "log_wrapper.h"
+#endif
+
+#ifdef LINUXSOCKETS
+
+#ifdef ROS
+#include "ros/ros.h"
+#endif
+
+#include <sys/epoll.h>
+
+using namespace industrial::message_manager;
+using namespace industrial::message_server;
+using namespace industrial::simple_socket;
+
+namespace industrial
+{
+namespace message_reactor
+{
+
+MessageReactor::MessageReactor()
+{
+  for (unsigned int i = 0; i < this->MAX_NUM_MANAGERS; i++)
+  {
+    this->managed_[i].manager = NULL;
+    this->managed_[i].connection = NULL;
+    this->managed_[i].sock_handle = -1;
+    this->managed_[i].events = 0;
+    this->managed_[i].last_connect = 0;
+  }
+  for (unsigned int i = 0; i < this->MAX_NUM_SERVERS; i++)
+  {
+    this->servers_[i] = NULL;
+  }
+  this->num_managers_ = 0;
+  this->epoll_handle_ = -1;
+  this->reconnect_period_ = this->DEFAULT_RECONNECT_PERIOD;
+}
+
+MessageReactor::~MessageReactor()
+{
+  if (0 <= this->epoll_handle_)
+  {
+    close(this->epoll_handle_);
+  }
+}
+
+bool MessageReactor::init()
+{
+  bool rtn = false;
+
+  if (0 > this->epoll_handle_)
+  {
+    this->epoll_handle_ = epoll_create(this->MAX_NUM_MANAGERS);
+  }
+
+  if (0 <= this->epoll_handle_)
+  {
+    LOG_INFO("Message reactor initialized");
+    rtn = true;
+  }
+  else
+  {
+    LOG_ERROR("Failed to create message reactor epoll handle, errno: %d", errno);
+    rtn = false;
+  }
+
+  return rtn;
+}
+
+bool MessageReactor::add(MessageManager* manager)
+{
+  SimpleSocket* connection = NULL;
+  int idx = -1;
+
+  if (NULL == manager || NULL == manager->getConnection())
+  {
+    LOG_ERROR("NULL (or uninitialized) manager not added");
+    return false;
+  }
+
+  connection = dynamic_cast<SimpleSocket*>(manager->getConnection());
+  if (NULL == connection)
+  {
+    LOG_ERROR("Manager connection is not a socket, manager not added");
+    return false;
+  }
+
+  for (unsigned int i = 0; i < this->MAX_NUM_MANAGERS; i++)
+  {
+    if (manager == this->managed_[i].manager)
+    {
+      LOG_ERROR("Failed to add manager, manager already exists");
+      return false;
+    }
+    else if (0 > idx && NULL == this->managed_[i].manager)
+    {
+      idx = i;
+    }
+  }
+
+  if (0 > idx)
+  {
+    LOG_ERROR("Max number of managers exceeded");
+    return false;
+  }
+
+  this->managed_[idx].manager = manager;
+  this->managed_[idx].connection = connection;
+  this->managed_[idx].sock_handle = -1;
+  // Disconnected connections are reconnected on the next spin
+  this->managed_[idx].last_connect = SimpleSocket::getTimeMs() - this->reconnect_period_;
+  this->num_managers_++;
+
+  if (connection->isConnected())
+  {
+    this->registerSocket(idx, EPOLLIN);
+  }
+  LOG_INFO("Added message manager, number of managers: %u", this->getNumManagers());
+
+  return true;
+}
+
+bool MessageReactor::remove(MessageManager* manager)
+{
+  for (unsigned int i = 0; i < this->MAX_NUM_MANAGERS; i++)
+  {
+    if (NULL != manager && manager == this->managed_[i].manager)
+    {
+      this->unregisterSocket(i);
+      this->managed_[i].manager = NULL;
+      this->managed_[i].connection = NULL;
+      this->num_managers_--;
+      return true;
+    }
+  }
+
+  LOG_ERROR("Failed to remove manager, manager not found");
+  return false;
+}
+
+bool MessageReactor::addServer(MessageServer* server)
+{
+  epoll_event event;
+  int idx = -1;
+
+  if (NULL == server || 0 > this->epoll_handle_)
+  {
+    LOG_ERROR("NULL server (or reactor not initialized), server not added");
+    return false;
+  }
+
+  for (unsigned int i = 0; i < this->MAX_NUM_SERVERS; i++)
+  {
+    if (server == this->servers_[i])
+    {
+      LOG_ERROR("Failed to add server, server already exists");
+      return false;
+    }
+    else if (0 > idx && NULL == this->servers_[i])
+    {
+      idx = i;
+    }
+  }
+
+  if (0 > idx)
+  {
+    LOG_ERROR("Max number of servers exceeded");
+    return false;
+  }
+
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.u32 = this->MAX_NUM_MANAGERS + idx;
+  if (0 != epoll_ctl(this->epoll_handle_, EPOLL_CTL_ADD, server->getListenHandle(), &event))
+  {
+    LOG_ERROR("Failed to register server socket handle: %d, errno: %d", server->getListenHandle(), errno);
+    return false;
+  }
+
+  this->servers_[idx] = server;
+  LOG_INFO("Added message server, idx: %d", idx);
+  return true;
+}
+
+bool MessageReactor::removeServer(MessageServer* server)
+{
+  epoll_event event = {};
+
+  for (unsigned int i = 0; i < this->MAX_NUM_SERVERS; i++)
+  {
+    if (NULL != server && server == this->servers_[i])
+    {
+      epoll_ctl(this->epoll_handle_, EPOLL_CTL_DEL, server->getListenHandle(), &event);
+      this->servers_[i] = NULL;
+      return true;
+    }
+  }
+
+  LOG_ERROR("Failed to remove server, server not found");
+  return false;
+}
+
+int MessageReactor::spinOnce(int timeout)
+{
+  epoll_event events[MAX_NUM_MANAGERS];
+  unsigned int now = SimpleSocket::getTimeMs();
+  int rc = 0;
+  int count = 0;
+  int flushTimeout = -1;
+
+  if (0 > this->epoll_handle_)
+  {
+    LOG_ERROR("Message reactor not initialized");
+    return -1;
+  }
+
+  // Reconnect (throttled) disconnected connections and keep the wait set
+  // up to date with the connection socket handles.
+  for (unsigned int i = 0; i < this->MAX_NUM_MANAGERS; i++)
+  {
+    Managed & m = this->managed_[i];
+    if (NULL == m.manager)
+    {
+      continue;
+    }
+
+    if (!m.connection->isConnected() && (int)(now - m.last_connect) >= this->reconnect_period_)
+    {
+      // The socket handle may be closed (and reused) by the reconnect
+      this->unregisterSocket(i);
+      m.last_connect = now;
+      m.manager->getCommsFaultHandler()->connectionFailCB();
+
+      // The fault handler may remove the manager (see MessageServer)
+      if (NULL == m.manager)
+      {
+        continue;
+      }
+    }
+
+    if (m.connection->isConnected())
+    {
+      this->registerSocket(i, EPOLLIN);
+
+      // The wait ends when queued messages are due (see below)
+      flushTimeout = m.connection->getFlushTimeout();
+      if (0 <= flushTimeout && (0 > timeout || timeout > flushTimeout))
+      {
+        timeout = flushTimeout;
+      }
+    }
+    else
+    {
+      // Connect completion (or failure) is reported as ready to send
+      if (m.connection->isConnecting())
+      {
+        this->registerSocket(i, EPOLLOUT);
+      }
+      else
+      {
+        this->unregisterSocket(i);
+      }
+
+      if (0 > timeout || timeout > this->reconnect_period_)
+      {
+        timeout = this->reconnect_period_;
+      }
+    }
+  }
+
+  rc = epoll_wait(this->epoll_handle_, events, this->MAX_NUM_MANAGERS, timeout);
+  if (0 > rc)
+  {
+    if (EINTR != errno)
+    {
+      LOG_ERROR("Message reactor wait failed, errno: %d", errno);
+      return -1;
+    }
+    rc = 0;
+  }
+
+  for (int i = 0; i < rc; i++)
+  {
+    unsigned int idx = events[i].data.u32;
+
+    if (idx >= this->MAX_NUM_MANAGERS)
+    {
+      idx -= this->MAX_NUM_MANAGERS;
+      if (idx < this->MAX_NUM_SERVERS && NULL != this->servers_[idx])
+      {
+        LOG_COMM("Server ready, accepting clients, idx: %u", idx);
+        this->servers_[idx]->acceptClients();
+      }
+      continue;
+    }
+
+    Managed & m = this->managed_[idx];
+
+    if (NULL == m.manager || m.sock_handle != m.connection->getSockHandle())
+    {
+      continue;
+    }
+
+    if (!m.connection->isConnected())
+    {
+      // Completes (or fails) a connect in progress, the socket is registered
+      // again by the next spin
+      if (m.connection->isConnecting())
+      {
+        this->unregisterSocket(idx);
+        m.connection->pollConnect(0);
+      }
+      continue;
+    }
+
+    // The available data is received (without waiting) and the manager is
+    // only spun for complete messages, so that a partial message (i.e. a
+    // stalled peer) doesn't block the other connections.  Messages received
+    // into the readahead buffer are not reported by the wait, so they are
+    // all handled now.  A hang-up or error closes the connection, it is
+    // reported to the manager's fault handler.
+    if (!m.connection->receiveAvailable())
+    {
+      m.manager->getCommsFaultHandler()->receiveFailCB();
+    }
+
+    while (NULL != m.manager && m.connection->isConnected() && m.connection->isMsgBuffered())
+    {
+      LOG_COMM("Message buffered, executing manager spin, idx: %u", idx);
+      m.manager->spinOnce();
+      count++;
+    }
+
+    // Remove closed connections before any other socket handles are (re)used
+    if (NULL != m.manager && !m.connection->isConnected())
+    {
+      LOG_WARN("Managed connection lost, idx: %u", idx);
+      this->unregisterSocket(idx);
+    }
+  }
+
+  // Queued messages are sent once they are due (see
+  // SmplMsgConnection::setBatching), whether or not anything was received
+  for (unsigned int i = 0; i < this->MAX_NUM_MANAGERS; i++)
+  {
+    Managed & m = this->managed_[i];
+    if (NULL != m.manager && m.connection->isConnected() && !m.connection->flushIfDue())
+    {
+      m.manager->getCommsFaultHandler()->sendFailCB();
+    }
+  }
+
+  return count;
+}
+
+void MessageReactor::spin()
+{
+  LOG_INFO("Entering message reactor spin loop");
+#ifdef ROS
+  while (ros::ok())
+#else
+  while (true)
+#endif
+  {
+    if (0 > this->spinOnce(this->SPIN_TIMEOUT))
+    {
+      break;
+    }
+  }
+}
+
+bool MessageReactor::registerSocket(unsigned int idx, unsigned int events)
+{
+  Managed & m = this->managed_[idx];
+  int sock_handle = m.connection->getSockHandle();
+  epoll_event event;
+
+  if (sock_handle == m.sock_handle && events == m.events)
+  {
+    return true;
+  }
+  this->unregisterSocket(idx);
+
+  if (!m.connection->setNonBlocking(true))
+  {
+    LOG_WARN("Failed to set non-blocking socket, idx: %u", idx);
+  }
+
+  memset(&event, 0, sizeof(event));
+  event.events = events;
+  event.data.u32 = idx;
+  if (0 != epoll_ctl(this->epoll_handle_, EPOLL_CTL_ADD, sock_handle, &event))
+  {
+    LOG_ERROR("Failed to register socket handle: %d, errno: %d", sock_handle, errno);
+    return false;
+  }
+
+  LOG_DEBUG("Registered socket handle: %d, idx: %u, events: %u", sock_handle, idx, events);
+  m.sock_handle = sock_handle;
+  m.events = events;
+  return true;
+}
+
+void MessageReactor::unregisterSocket(unsigned int idx)
+{
+  Managed & m = this->managed_[idx];
+  epoll_event event = {};
+
+  if (0 <= m.sock_handle)
+  {
+    // May fail if the socket has already been closed (closed sockets are
+    // removed automatically)
+    epoll_ctl(this->epoll_handle_, EPOLL_CTL_DEL, m.sock_handle, &event);
+    LOG_DEBUG("Unregistered socket handle: %d, idx: %u", m.sock_handle, idx);
+    m.sock_handle = -1;
+    m.events = 0;
+  }
+}
+
+} // namespace message_reactor
+} // namespace industrial
+
+#endif //LINUXSOCKETS
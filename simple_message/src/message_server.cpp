@@ -0,0 +1,237 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2013, Southwest Research Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 	* Redistributions of source code must retain the above copyright
+ * 	notice, this list of conditions and the following disclaimer.
+ * 	* Redistributions in binary form must reproduce the above copyright
+ * 	notice, this list of conditions and the following disclaimer in the
+ * 	documentation and/or other materials provided with the distribution.
+ * 	* Neither the name of the Southwest Research Institute, nor the names
+ *	of its contributors may be used to endorse or promote products derived
+ *	from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FLATHEADERS
+#include "simple_message/message_server.h"
+#include "simple_message/message_reactor.h"
+#include "simple_message/log_wrapper.h"
+#else
+#include "message_server.h"
+#include "message_reactor.h"
+#include "log_wrapper.h"
+#endif
+
+#ifdef LINUXSOCKETS
+
+using namespace industrial::message_manager;
+using namespace industrial::message_reactor;
+
+namespace industrial
+{
+namespace message_server
+{
+
+SessionFaultHandler::SessionFaultHandler()
+{
+  this->server_ = NULL;
+  this->idx_ = 0;
+}
+
+void SessionFaultHandler::init(MessageServer* server, unsigned int idx)
+{
+  this->server_ = server;
+  this->idx_ = idx;
+}
+
+void SessionFaultHandler::sendFailCB()
+{
+  LOG_WARN("Session: %u, send failure", this->idx_);
+}
+
+void SessionFaultHandler::receiveFailCB()
+{
+  LOG_WARN("Session: %u, receive failure", this->idx_);
+}
+
+void SessionFaultHandler::connectionFailCB()
+{
+  if (NULL != this->server_)
+  {
+    this->server_->closeSession(this->idx_);
+  }
+}
+
+MessageServer::MessageServer()
+{
+  for (unsigned int i = 0; i < this->MAX_NUM_SESSIONS; i++)
+  {
+    this->sessions_[i].active = false;
+  }
+  this->num_sessions_ = 0;
+  this->reactor_ = NULL;
+}
+
+MessageServer::~MessageServer()
+{
+  if (NULL != this->reactor_)
+  {
+    for (unsigned int i = 0; i < this->MAX_NUM_SESSIONS; i++)
+    {
+      this->closeSession(i);
+    }
+    this->reactor_->removeServer(this);
+  }
+}
+
+bool MessageServer::init(int port_num, MessageReactor* reactor)
+{
+  int flags = 0;
+
+  if (NULL == reactor || NULL != this->reactor_)
+  {
+    LOG_ERROR("NULL reactor (or server already initialized)");
+    return false;
+  }
+
+  // Clients that connect while all sessions are in use wait in the backlog
+  // until they are rejected (see acceptClients)
+  if (!this->listener_.init(port_num, this->MAX_NUM_SESSIONS))
+  {
+    LOG_ERROR("Failed to initialize message server listening socket");
+    return false;
+  }
+
+  // All pending clients are accepted, until none are left
+  flags = fcntl(this->getListenHandle(), F_GETFL, 0);
+  if (0 > flags || 0 > fcntl(this->getListenHandle(), F_SETFL, flags | O_NONBLOCK))
+  {
+    LOG_ERROR("Failed to set non-blocking listening socket, errno: %d", errno);
+    return false;
+  }
+
+  for (unsigned int i = 0; i < this->MAX_NUM_SESSIONS; i++)
+  {
+    this->sessions_[i].fault.init(this, i);
+    if (!this->sessions_[i].manager.init(&this->sessions_[i].connection, &this->sessions_[i].fault))
+    {
+      LOG_ERROR("Failed to initialize session: %u", i);
+      return false;
+    }
+  }
+
+  if (!reactor->addServer(this))
+  {
+    return false;
+  }
+  this->reactor_ = reactor;
+
+  LOG_INFO("Message server initialized, port: %d", port_num);
+  return true;
+}
+
+MessageManager* MessageServer::getManager(unsigned int idx)
+{
+  if (idx >= this->MAX_NUM_SESSIONS)
+  {
+    LOG_ERROR("Session index: %u, out of range", idx);
+    return NULL;
+  }
+  return &this->sessions_[idx].manager;
+}
+
+bool MessageServer::isSessionActive(unsigned int idx)
+{
+  return (idx < this->MAX_NUM_SESSIONS) && this->sessions_[idx].active;
+}
+
+int MessageServer::acceptClients()
+{
+  int count = 0;
+  int idx = -1;
+  int rc = -1;
+
+  while (true)
+  {
+    idx = -1;
+    for (unsigned int i = 0; i < this->MAX_NUM_SESSIONS; i++)
+    {
+      if (!this->sessions_[i].active)
+      {
+        idx = i;
+        break;
+      }
+    }
+
+    if (0 > idx)
+    {
+      // A pending client would keep the listening socket ready, so it is
+      // accepted and closed immediately
+      rc = ACCEPT(this->getListenHandle(), NULL, NULL);
+      if (0 > rc)
+      {
+        break;
+      }
+      LOG_WARN("Max number of sessions exceeded, client rejected");
+      CLOSE(rc);
+      continue;
+    }
+
+    Session & s = this->sessions_[idx];
+    if (!s.connection.acceptClient(this->listener_))
+    {
+      break;
+    }
+
+    if (!this->reactor_->add(&s.manager))
+    {
+      LOG_ERROR("Failed to add session: %d, to reactor", idx);
+      s.connection.closeClient();
+      continue;
+    }
+    s.active = true;
+    this->num_sessions_++;
+
+    LOG_INFO("Session: %d, opened, number of sessions: %u", idx, this->getNumSessions());
+    count++;
+  }
+
+  return count;
+}
+
+void MessageServer::closeSession(unsigned int idx)
+{
+  if (!this->isSessionActive(idx))
+  {
+    return;
+  }
+
+  Session & s = this->sessions_[idx];
+  this->reactor_->remove(&s.manager);
+  s.connection.closeClient();
+  s.active = false;
+  this->num_sessions_--;
+  LOG_INFO("Session: %u, closed, number of sessions: %u", idx, this->getNumSessions());
+}
+
+} // namespace message_server
+} // namespace industrial
+
+#endif //LINUXSOCKETS
@@ -63,10 +63,11 @@ JointFeedbackMessage::~JointFeedbackMessage(void)
 bool JointFeedbackMessage::init(industrial::simple_message::SimpleMessage & msg)
 {
   bool rtn = false;
-  ByteArray data = msg.getData();
+  ByteArrayReader data(msg.getData());
   this->init();
 
-  if (data.unload(this->data_))
+  // The number of joints is determined from the message data length
+  if (this->data_.setNumJointsFromLength(msg.getDataLength()) && data.unload(this->data_))
   {
     rtn = true;
   }
@@ -65,25 +65,28 @@ JointMessage::~JointMessage(void)
 bool JointMessage::init(industrial::simple_message::SimpleMessage & msg)
 {
   bool rtn = false;
-  ByteArray data = msg.getData();
+  ByteArrayReader data(msg.getData());
+  shared_int numJoints = 0;
 
   this->setMessageType(StandardMsgTypes::JOINT_POSITION);
 
-  if (data.unload(this->joints_))
+  if (data.unload(this->sequence_))
   {
-    if (data.unload(this->sequence_))
+    // The number of joints is determined from the message data length
+    if (JointData::numJointsFromLength(msg.getDataLength(), sizeof(shared_int), 1, numJoints)
+        && this->joints_.setNumJoints(numJoints) && data.unload(this->joints_))
     {
       rtn = true;
     }
     else
     {
       rtn = false;
-      LOG_ERROR("Failed to unload sequence data");
+      LOG_ERROR("Failed to unload joint data");
     }
   }
   else
   {
-    LOG_ERROR("Failed to unload joint data");
+    LOG_ERROR("Failed to unload sequence data");
   }
   return rtn;
 }
@@ -0,0 +1,163 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2013, Southwest Research Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 	* Redistributions of source code must retain the above copyright
+ * 	notice, this list of conditions and the following disclaimer.
+ * 	* Redistributions in binary form must reproduce the above copyright
+ * 	notice, this list of conditions and the following disclaimer in the
+ * 	documentation and/or other materials provided with the distribution.
+ * 	* Neither the name of the Southwest Research Institute, nor the names
+ *	of its contributors may be used to endorse or promote products derived
+ *	from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FLATHEADERS
+#include "simple_message/messages/joint_traj_full_message.h"
+#include "simple_message/joint_data.h"
+#include "simple_message/byte_array.h"
+#include "simple_message/log_wrapper.h"
+#else
+#include "joint_traj_full_message.h"
+#include "joint_data.h"
+#include "byte_array.h"
+#include "log_wrapper.h"
+#endif
+
+using namespace industrial::shared_types;
+using namespace industrial::byte_array;
+using namespace industrial::simple_message;
+using namespace industrial::joint_traj_full;
+using namespace industrial::joint_traj_pt_full;
+
+namespace industrial
+{
+namespace joint_traj_full_message
+{
+
+JointTrajFullMessage::JointTrajFullMessage(void)
+{
+  this->init();
+}
+
+JointTrajFullMessage::~JointTrajFullMessage(void)
+{
+
+}
+
+bool JointTrajFullMessage::init(industrial::simple_message::SimpleMessage & msg)
+{
+  bool rtn = false;
+  ByteArrayReader data(msg.getData());
+  this->init();
+
+  if (this->setNumJointsFromMsg(msg) && data.unload(this->traj_))
+  {
+    rtn = true;
+  }
+  else
+  {
+    LOG_ERROR("Failed to unload joint traj full data");
+  }
+  return rtn;
+}
+
+bool JointTrajFullMessage::setNumJointsFromMsg(industrial::simple_message::SimpleMessage & msg)
+{
+  ByteArrayReader trailer;
+  JointTrajPtFull point;
+  unsigned int dataLength = msg.getDataLength();
+  shared_int size = 0;
+
+  // The trajectory size is the last value of the message data, the remaining
+  // data is evenly split between the points.
+  if (dataLength < sizeof(shared_int))
+  {
+    LOG_ERROR("Failed to unload trajectory size");
+    return false;
+  }
+  trailer.init(msg.getData().getRawDataPtr() + dataLength - sizeof(shared_int), sizeof(shared_int));
+  if (!trailer.unload(size) || size < 0)
+  {
+    LOG_ERROR("Invalid trajectory size: %d", size);
+    return false;
+  }
+  if (0 == size)
+  {
+    return true;
+  }
+  if ((dataLength - sizeof(shared_int)) % size != 0
+      || !point.setNumJointsFromLength((dataLength - sizeof(shared_int)) / size))
+  {
+    LOG_ERROR("Trajectory data length: %u, does not match size: %d", dataLength, size);
+    return false;
+  }
+  return this->traj_.setNumJoints(point.getNumJoints());
+}
+
+void JointTrajFullMessage::init(industrial::joint_traj_full::JointTrajFull & traj)
+{
+  this->init();
+  this->traj_.copyFrom(traj);
+}
+
+void JointTrajFullMessage::init()
+{
+  this->setMessageType(StandardMsgTypes::JOINT_TRAJ_FULL);
+  this->traj_.init();
+}
+
+
+bool JointTrajFullMessage::load(ByteArray *buffer)
+{
+  bool rtn = false;
+  LOG_COMM("Executing joint traj. full message load");
+  if (buffer->load(this->traj_))
+  {
+    rtn = true;
+  }
+  else
+  {
+    rtn = false;
+    LOG_ERROR("Failed to load joint traj. full data");
+  }
+  return rtn;
+}
+
+bool JointTrajFullMessage::unload(ByteArray *buffer)
+{
+  bool rtn = false;
+  LOG_COMM("Executing joint traj full message unload");
+
+  if (buffer->unload(this->traj_))
+  {
+    rtn = true;
+  }
+  else
+  {
+    rtn = false;
+    LOG_ERROR("Failed to unload joint traj full data");
+  }
+  return rtn;
+}
+
+}
+}
+
@@ -64,10 +64,11 @@ JointTrajPtFullMessage::~JointTrajPtFullMessage(void)
 bool JointTrajPtFullMessage::init(industrial::simple_message::SimpleMessage & msg)
 {
   bool rtn = false;
-  ByteArray data = msg.getData();
+  ByteArrayReader data(msg.getData());
   this->init();
 
-  if (data.unload(this->point_))
+  // The number of joints is determined from the message data length
+  if (this->point_.setNumJointsFromLength(msg.getDataLength()) && data.unload(this->point_))
   {
     rtn = true;
   }
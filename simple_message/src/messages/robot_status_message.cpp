@@ -64,7 +64,7 @@ RobotStatusMessage::~RobotStatusMessage(void)
 bool RobotStatusMessage::init(industrial::simple_message::SimpleMessage & msg)
 {
   bool rtn = false;
-  ByteArray data = msg.getData();
+  ByteArrayReader data(msg.getData());
   this->init();
 
   if (data.unload(this->status_))
@@ -46,6 +46,7 @@
 #endif
 
 using namespace industrial::shared_types;
+using namespace industrial::byte_array;
 
 namespace industrial
 {
@@ -180,11 +181,31 @@ bool RobotStatus::load(industrial::byte_array::ByteArray *buffer)
 bool RobotStatus::unload(industrial::byte_array::ByteArray *buffer)
 {
   bool rtn = false;
+  ByteArrayReader reader;
 
   LOG_COMM("Executing robot status unload");
-  if (buffer->unload(this->error_code_) && buffer->unload(this->in_error_) && buffer->unload(this->in_motion_) 
-    && buffer->unload(this->motion_possible_) && buffer->unload(this->drives_powered_) && buffer->unload(this->e_stopped_)
-    && buffer->unload(this->mode_))
+  // The status is at the end of the buffer, it is read forward (in place)
+  if (buffer->unload(reader, this->byteLength()))
+  {
+    rtn = this->unload(&reader);
+  }
+  else
+  {
+    LOG_ERROR("Failed to unload robot status from data[%d]", buffer->getBufferSize());
+    rtn = false;
+  }
+
+  return rtn;
+}
+
+bool RobotStatus::unload(industrial::byte_array::ByteArrayReader *buffer)
+{
+  bool rtn = false;
+
+  LOG_COMM("Executing robot status unload");
+  if (buffer->unload(this->drives_powered_) && buffer->unload(this->e_stopped_) && buffer->unload(this->error_code_)
+      && buffer->unload(this->in_error_) && buffer->unload(this->in_motion_) && buffer->unload(this->mode_)
+      && buffer->unload(this->motion_possible_))
   {
 
     rtn = true;
@@ -75,8 +75,13 @@ void SimpleCommsFaultHandler::connectionFailCB()
 
   if (!(this->getConnection()->isConnected()))
   {
-    LOG_INFO("Connection failed, attempting reconnect");
-    this->getConnection()->makeConnect();
+    // Non-blocking connections only advance the connect here (they are
+    // expected to be polled again, see SmplMsgConnection::pollConnect)
+    if (!this->getConnection()->isConnecting())
+    {
+      LOG_DEBUG("Connection failed, attempting reconnect");
+    }
+    this->getConnection()->pollConnect(0);
   }
   else
   {
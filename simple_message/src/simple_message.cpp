@@ -52,6 +52,9 @@ namespace simple_message
 
 SimpleMessage::SimpleMessage(void)
 {
+  this->setMessageType(StandardMsgTypes::INVALID);
+  this->setCommType(CommTypes::INVALID);
+  this->setReplyCode(ReplyTypes::INVALID);
 }
 
 SimpleMessage::~SimpleMessage(void)
@@ -62,9 +65,9 @@ SimpleMessage::~SimpleMessage(void)
 
 bool SimpleMessage::init(int msgType, int commType, int replyCode)
 {
-  ByteArray data;
-  data.init();
-  return this->init(msgType, commType, replyCode, data);
+  // Any existing data is removed (the message may be reused)
+  this->data_.init();
+  return this->initHeader(msgType, commType, replyCode);
 }
 
 bool SimpleMessage::init(int msgType, int commType, int replyCode, ByteArray & data )
@@ -74,7 +77,18 @@ bool SimpleMessage::init(int msgType, int commType, int replyCode, ByteArray & d
   this->setMessageType(msgType);
   this->setCommType(commType);
   this->setReplyCode(replyCode);
-  this->data_.copyFrom(data);
+  this->setData(data);
+
+  return this->validateMessage();
+}
+
+bool SimpleMessage::initHeader(int msgType, int commType, int replyCode)
+{
+  LOG_COMM("SimpleMessage::initHeader(type: %d, comm: %d, reply: %d, data[%d]...)",
+            msgType, commType, replyCode, this->data_.getBufferSize());
+  this->setMessageType(msgType);
+  this->setCommType(commType);
+  this->setReplyCode(replyCode);
 
   return this->validateMessage();
 }
@@ -83,21 +97,25 @@ bool SimpleMessage::init(ByteArray & msg)
 {
   int dataSize = 0;
   bool rtn = false;
+  ByteArrayReader reader(msg);
 
   if (msg.getBufferSize() >= this->getHeaderSize())
   {
+    // The header is read first (in place), followed by the data portion.
+    LOG_COMM("Unloading header data");
+    reader.unload(this->message_type_);
+    reader.unload(this->comm_type_);
+    reader.unload(this->reply_code_);
+
     // Check to see if the message is larger than the standard header
     // If so, copy out the data portion.
-    if (msg.getBufferSize() > this->getHeaderSize())
+    this->data_.init();
+    dataSize = reader.getRemainSize();
+    if (dataSize > 0)
     {
-      dataSize = msg.getBufferSize() - this->getHeaderSize();
       LOG_COMM("Unloading data portion of message: %d bytes", dataSize);
-      msg.unload(this->data_, dataSize);
+      reader.unload(this->data_, dataSize);
     }
-    LOG_COMM("Unloading header data");
-    msg.unload(this->reply_code_);
-    msg.unload(this->comm_type_);
-    msg.unload(this->message_type_);
     LOG_COMM("SimpleMessage::init(type: %d, comm: %d, reply: %d, data[%d]...)",
               this->message_type_, this->comm_type_, this->reply_code_, this->data_.getBufferSize());
     rtn = this->validateMessage();
@@ -127,7 +145,15 @@ void SimpleMessage::toByteArray(ByteArray & msg)
 
 void SimpleMessage::setData( ByteArray & data)
 {
-  this->data_.copyFrom(data);
+  // An empty copy does not modify the destination
+  if (data.getBufferSize() > 0)
+  {
+    this->data_.copyFrom(data);
+  }
+  else
+  {
+    this->data_.init();
+  }
 }
 
 
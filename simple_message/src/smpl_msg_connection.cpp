@@ -39,12 +39,18 @@
 #include "byte_array.h"
 #endif
 
+#ifdef LINUXSOCKETS
+#include "time.h"
+#include "unistd.h"
+#endif
+
 #ifdef MOTOPLUS
 #include "motoPlus.h"
 #endif
 
 using namespace industrial::simple_message;
 using namespace industrial::byte_array;
+using namespace industrial::shared_types;
 
 namespace industrial
 {
@@ -52,19 +58,123 @@ namespace industrial
 namespace smpl_msg_connection
 {
 
+SmplMsgConnection::SmplMsgConnection()
+{
+  this->byte_swapping_ = false;
+  this->batch_max_bytes_ = 0;
+  this->batch_max_delay_ = 0;
+  this->batch_start_ = 0;
+}
+
+bool SmplMsgConnection::setByteSwapping(bool enable)
+{
+  if (enable && (sizeof(shared_int) != sizeof(shared_real)))
+  {
+    LOG_ERROR("Runtime byte swapping requires int size: %u equal to real size: %u",
+              (unsigned int)sizeof(shared_int), (unsigned int)sizeof(shared_real));
+    return false;
+  }
+
+  LOG_INFO("Runtime byte swapping %s", enable ? "enabled" : "disabled");
+  this->byte_swapping_ = enable;
+  return true;
+}
+
+bool SmplMsgConnection::setBatching(shared_int max_bytes, int max_delay)
+{
+  if ((max_bytes < 0) || (max_bytes > MAX_BATCH_BYTES) || (max_delay < 0))
+  {
+    LOG_ERROR("Invalid batch size: %d (max: %d) or delay: %d", max_bytes,
+              MAX_BATCH_BYTES, max_delay);
+    return false;
+  }
+
+  // Queued messages are sent using the previous bounds
+  if (!this->flush())
+  {
+    LOG_WARN("Failed to flush queued messages, messages discarded");
+  }
+
+  LOG_INFO("Message batching %s (size: %d, delay: %d ms)",
+           max_bytes > 0 ? "enabled" : "disabled", max_bytes, max_delay);
+  this->batch_max_bytes_ = max_bytes;
+  this->batch_max_delay_ = max_delay;
+  return true;
+}
+
+unsigned int SmplMsgConnection::getTimeMs()
+{
+#ifdef LINUXSOCKETS
+  timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (unsigned int)time.tv_sec * 1000 + (unsigned int)(time.tv_nsec / 1000000);
+#else
+  return 0;
+#endif
+}
+
+#ifdef MOTOPLUS
+static int ms_per_clock;
+#endif
+
+void SmplMsgConnection::sleepMs(int ms)
+{
+  if (0 >= ms)
+  {
+    return;
+  }
+#ifdef MOTOPLUS
+  if (ms_per_clock <= 0)
+    ms_per_clock = mpGetRtc();
+
+  mpTaskDelay(ms / ms_per_clock);
+#elif defined(LINUXSOCKETS)
+  usleep(ms * 1000);
+#endif
+}
+
+bool SmplMsgConnection::pollConnect(int timeout)
+{
+  unsigned int start = this->getTimeMs();
+
+  if (this->isConnected() || this->makeConnect())
+  {
+    return true;
+  }
+
+  this->sleepMs(timeout - (int)(this->getTimeMs() - start));
+  return false;
+}
+
+bool SmplMsgConnection::swapMsgBytes(char* data, shared_int byte_size)
+{
+  if (!this->byte_swapping_)
+  {
+    return true;
+  }
+  return ByteArray::swapArray(data, byte_size, sizeof(shared_int));
+}
 
 bool SmplMsgConnection::sendMsg(SimpleMessage & message)
 {
   bool rtn;
-  ByteArray sendBuffer;
-  ByteArray msgData;
+  ByteArray prefix;
+
+  // Messages sent directly must not overtake queued messages
+  if (!this->flush())
+  {
+    return false;
+  }
 
   if (message.validateMessage())
   {
-    message.toByteArray(msgData);
-    sendBuffer.load((int)msgData.getBufferSize());
-    sendBuffer.load(msgData);
-    rtn = this->sendBytes(sendBuffer);
+    // Only the length and header are serialized here, the data is sent
+    // directly from the message (see sendGatherBytes)
+    prefix.load((int)message.getMsgLength());
+    prefix.load(message.getMessageType());
+    prefix.load(message.getCommType());
+    prefix.load(message.getReplyCode());
+    rtn = this->sendGatherBytes(prefix, message.getData());
   }
   else
   {
@@ -75,47 +185,184 @@ bool SmplMsgConnection::sendMsg(SimpleMessage & message)
 return rtn;
 }
 
+bool SmplMsgConnection::queueMsg(SimpleMessage & message)
+{
+  bool rtn;
+  shared_int start;
+
+  if (!this->isBatching())
+  {
+    return this->sendMsg(message);
+  }
+
+  if (!message.validateMessage())
+  {
+    LOG_ERROR("Message validation failed, message not queued");
+    return false;
+  }
+
+  // Flush first if the message does not fit, a message larger than the batch
+  // size is sent on its own (below)
+  if ((this->batch_.getBufferSize() > 0)
+      && ((int)(this->batch_.getBufferSize() + message.getLengthSize() + message.getMsgLength())
+          > this->batch_max_bytes_))
+  {
+    if (!this->flush())
+    {
+      return false;
+    }
+  }
+
+  if (0 == this->batch_.getBufferSize())
+  {
+    this->batch_start_ = this->getTimeMs();
+  }
+
+  start = this->batch_.getBufferSize();
+  rtn = this->batch_.load((int)message.getMsgLength()) && this->batch_.load(message.getMessageType())
+      && this->batch_.load(message.getCommType()) && this->batch_.load(message.getReplyCode())
+      && this->batch_.load(message.getData())
+      && this->swapMsgBytes(this->batch_.getRawDataPtr() + start, this->batch_.getBufferSize() - start);
+  if (!rtn)
+  {
+    // Remove the partially queued message, so the batch stays well formed
+    this->batch_.truncate(start);
+    LOG_ERROR("Failed to load (or byte swap) message, message not queued");
+    return false;
+  }
+
+  if ((int)this->batch_.getBufferSize() >= this->batch_max_bytes_)
+  {
+    rtn = this->flush();
+  }
+  else
+  {
+    rtn = this->flushIfDue();
+  }
+
+  return rtn;
+}
+
+bool SmplMsgConnection::flushIfDue()
+{
+  if (0 == this->getFlushTimeout())
+  {
+    return this->flush();
+  }
+  return true;
+}
+
+int SmplMsgConnection::getFlushTimeout()
+{
+  int left;
+
+  if (0 == this->batch_.getBufferSize())
+  {
+    return -1;
+  }
+
+  left = this->batch_max_delay_ - (int)(this->getTimeMs() - this->batch_start_);
+  return (left > 0) ? left : 0;
+}
+
+bool SmplMsgConnection::flush()
+{
+  bool rtn = true;
+
+  if (this->batch_.getBufferSize() > 0)
+  {
+    LOG_COMM("Flushing %d queued bytes", this->batch_.getBufferSize());
+    rtn = this->sendBytes(this->batch_);
+    if (!rtn)
+    {
+      LOG_ERROR("Failed to send queued messages");
+    }
+    this->batch_.init();
+  }
+
+  return rtn;
+}
+
+bool SmplMsgConnection::sendGatherBytes(ByteArray & prefix, ByteArray & data)
+{
+  bool rtn;
+  ByteArray sendBuffer;
+
+  sendBuffer.copyFrom(prefix);
+  rtn = sendBuffer.load(data)
+      && this->swapMsgBytes(sendBuffer.getRawDataPtr(), sendBuffer.getBufferSize());
+  if (rtn)
+  {
+    rtn = this->sendBytes(sendBuffer);
+  }
+  else
+  {
+    LOG_ERROR("Failed to load (or byte swap) message, message not sent");
+  }
+
+  return rtn;
+}
+
 
 bool SmplMsgConnection::receiveMsg(SimpleMessage & message)
 {
-  ByteArray lengthBuffer;
-  ByteArray msgBuffer;
+  // The message data member is used as the receive buffer.  The length and
+  // header are received (and unloaded) first, after which the data portion
+  // is received directly into the message (no intermediate copies).
+  ByteArray & msgData = message.getData();
   int length;
+  int msgType;
+  int commType;
+  int replyCode;
+  int dataSize;
 
   bool rtn = false;
 
 
-  rtn = this->receiveBytes(lengthBuffer, message.getLengthSize());
+  rtn = this->receiveBytes(msgData, message.getLengthSize() + message.getHeaderSize())
+      && this->swapMsgBytes(msgData.getRawDataPtr(), msgData.getBufferSize());
 
   if (rtn)
   {
-    rtn = lengthBuffer.unload(length);
+    // Unloaded in reverse order (from the end of the buffer)
+    rtn = msgData.unload(replyCode) && msgData.unload(commType) && msgData.unload(msgType)
+        && msgData.unload(length);
     LOG_COMM("Message length: %d", length);
 
     if (rtn)
     {
-      rtn = this->receiveBytes(msgBuffer, length);
+      dataSize = length - message.getHeaderSize();
+      if (dataSize > 0)
+      {
+        rtn = this->receiveBytes(msgData, dataSize)
+            && this->swapMsgBytes(msgData.getRawDataPtr(), msgData.getBufferSize());
+      }
+      else if (dataSize < 0)
+      {
+        LOG_ERROR("Message length: %d, smaller than header size: %u", length, message.getHeaderSize());
+        rtn = false;
+      }
 
       if (rtn)
       {
-        rtn = message.init(msgBuffer);
+        rtn = message.initHeader(msgType, commType, replyCode);
       }
       else
       {
-        LOG_ERROR("Failed to initialize message");
+        LOG_ERROR("Failed to receive message data");
         rtn = false;
       }
 
     }
     else
     {
-      LOG_ERROR("Failed to receive message");
+      LOG_ERROR("Failed to unload message header");
       rtn = false;
     }
   }
   else
   {
-    LOG_ERROR("Failed to receive message length");
+    LOG_ERROR("Failed to receive message length and header");
     rtn = false;
   }
 
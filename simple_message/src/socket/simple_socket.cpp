@@ -39,16 +39,46 @@
 
 using namespace industrial::byte_array;
 using namespace industrial::shared_types;
+using industrial::simple_message::SimpleMessage;
 
 namespace industrial
 {
   namespace simple_socket
   {
 
+    SimpleSocket::SimpleSocket()
+    {
+#ifdef LINUXSOCKETS
+      this->poll_method_ = PollMethods::POLL;
+#else
+      this->poll_method_ = PollMethods::SELECT;
+#endif
+      this->receive_timeout_ = -1;
+      this->msg_receiving_ = false;
+      this->msg_start_ = 0;
+      this->msg_received_ = 0;
+      this->epoll_handle_ = this->SOCKET_FAIL;
+      this->readahead_ = true;
+      this->connected_ = false;
+      this->setSockHandle(this->SOCKET_FAIL);
+    }
+
+    SimpleSocket::~SimpleSocket()
+    {
+#ifdef LINUXSOCKETS
+      if (this->SOCKET_FAIL != this->epoll_handle_)
+      {
+        CLOSE(this->epoll_handle_);
+      }
+#endif
+    }
+
     bool SimpleSocket::sendBytes(ByteArray & buffer)
     {
       int rc = this->SOCKET_FAIL;
       bool rtn = false;
+      char* sendPtr = buffer.getRawDataPtr();
+      shared_int remainBytes = buffer.getBufferSize();
 
       if (this->isConnected())
       {
@@ -56,16 +86,32 @@ namespace industrial
         // can handle.
         if (this->MAX_BUFFER_SIZE > (int)buffer.getBufferSize())
         {
-
-          rc = rawSendBytes(buffer.getRawDataPtr(), buffer.getBufferSize());
-          if (this->SOCKET_FAIL != rc)
+          // Partial sends (and non-blocking sockets that are not ready) are
+          // retried until all the bytes are sent.
+          rtn = true;
+          while (remainBytes > 0)
           {
-            rtn = true;
-          }
-          else
-          {
-            rtn = false;
-            logSocketError("Socket sendBytes failed", rc);
+            rc = rawSendBytes(sendPtr, remainBytes);
+            if (this->SOCKET_FAIL != rc)
+            {
+              remainBytes -= rc;
+              sendPtr += rc;
+            }
+            else if (this->isWouldBlock(rc))
+            {
+              if (!this->pollSend(this->SOCKET_POLL_TO))
+              {
+                LOG_ERROR("Socket not ready to send, bytes left: %d", remainBytes);
+                rtn = false;
+                break;
+              }
+            }
+            else
+            {
+              rtn = false;
+              logSocketError("Socket sendBytes failed", rc);
+              break;
+            }
           }
 
         }
@@ -91,18 +137,100 @@ namespace industrial
 
     }
 
+#ifdef LINUXSOCKETS
+    bool SimpleSocket::sendGatherBytes(ByteArray & prefix, ByteArray & data)
+    {
+      int rc = this->SOCKET_FAIL;
+      bool rtn = false;
+      iovec iov[2];
+      iovec* sendIov = &iov[0];
+      int iovCount = 2;
+      int remainBytes = prefix.getBufferSize() + data.getBufferSize();
+
+      // Runtime byte swapping modifies the message bytes, which requires a copy
+      if (this->isByteSwapping())
+      {
+        return SmplMsgConnection::sendGatherBytes(prefix, data);
+      }
+
+      if (!this->isConnected())
+      {
+        LOG_WARN("Not connected, bytes not sent");
+        this->setConnected(false);
+        return false;
+      }
+
+      if (this->MAX_BUFFER_SIZE <= remainBytes)
+      {
+        LOG_ERROR("Buffer size: %d, is greater than max socket size: %u", remainBytes, this->MAX_BUFFER_SIZE);
+        this->setConnected(false);
+        return false;
+      }
+
+      iov[0].iov_base = prefix.getRawDataPtr();
+      iov[0].iov_len = prefix.getBufferSize();
+      iov[1].iov_base = data.getRawDataPtr();
+      iov[1].iov_len = data.getBufferSize();
+
+      // Partial sends (and non-blocking sockets that are not ready) are
+      // retried until all the bytes are sent (see sendBytes).
+      rtn = true;
+      while (remainBytes > 0)
+      {
+        rc = this->rawSendVector(sendIov, iovCount);
+        if (this->SOCKET_FAIL != rc)
+        {
+          remainBytes -= rc;
+          while (iovCount > 0 && rc >= (int)sendIov->iov_len)
+          {
+            rc -= sendIov->iov_len;
+            sendIov++;
+            iovCount--;
+          }
+          if (iovCount > 0)
+          {
+            sendIov->iov_base = (char*)sendIov->iov_base + rc;
+            sendIov->iov_len -= rc;
+          }
+        }
+        else if (this->isWouldBlock(rc))
+        {
+          if (!this->pollSend(this->SOCKET_POLL_TO))
+          {
+            LOG_ERROR("Socket not ready to send, bytes left: %d", remainBytes);
+            rtn = false;
+            break;
+          }
+        }
+        else
+        {
+          rtn = false;
+          logSocketError("Socket sendGatherBytes failed", rc);
+          break;
+        }
+      }
+
+      if (!rtn)
+      {
+        this->setConnected(false);
+      }
+
+      return rtn;
+    }
+#endif
+
     bool SimpleSocket::receiveBytes(ByteArray & buffer, shared_int num_bytes)
     {
       int rc = this->SOCKET_FAIL;
       bool rtn = false;
       shared_int remainBytes = num_bytes;
+      char* loadPtr = NULL;
+      char* readPtr = NULL;
+      int readSize = 0;
+      int bufferedBytes = 0;
       bool ready, error;
-
-      // Reset the buffer (this is not required since the buffer length should
-      // ensure that we don't read any of the garbage that may be left over from
-      // a previous read), but it is good practice.
-
-      memset(&this->buffer_, 0, sizeof(this->buffer_));
+      bool tryRead = this->non_blocking_;
+      unsigned int start = this->msg_receiving_ ? this->msg_start_ : this->getTimeMs();
 
       // Doing a sanity check to determine if the byte array buffer is larger than
       // what can be sent in the socket.  This should not happen and might be indicative
@@ -115,17 +243,57 @@ namespace industrial
       if (this->isConnected())
       {
         buffer.init();
+
+        // Data is read directly into the byte array (no intermediate copy
+        // through the socket buffer), unless readahead is enabled.
+        loadPtr = buffer.getLoadPtr(num_bytes);
+        if (NULL == loadPtr)
+        {
+          LOG_ERROR("Receive size: %d, is greater than byte array max size: %u",
+              num_bytes, buffer.getMaxBufferSize());
+          remainBytes = 0;
+          rtn = false;
+        }
+
         while (remainBytes > 0)
         {
+          // Readahead (buffered) data is received first
+          bufferedBytes = this->read_end_ - this->read_pos_;
+          if (bufferedBytes > 0)
+          {
+            rc = (bufferedBytes < remainBytes) ? bufferedBytes : remainBytes;
+            memcpy(loadPtr, &this->buffer_[this->read_pos_], rc);
+            this->read_pos_ += rc;
+            remainBytes = remainBytes - rc;
+            buffer.extendBufferSize(rc);
+            loadPtr += rc;
+            rtn = true;
+            continue;
+          }
+
           // Polling the socket results in an "interruptable" socket read.  This
           // allows Control-C to break out of a socket read.  Without polling,
           // a sig-term is required to kill a program in a socket read function.
-          if (this->poll(this->SOCKET_POLL_TO, ready, error))
+          // Non-blocking sockets are read first, and only polled if no data is
+          // ready.
+          ready = tryRead;
+          error = false;
+          if (tryRead || this->poll(this->getReceivePollTimeout(start, this->SOCKET_POLL_TO), ready, error))
           {
             if(ready)
             {
-              rc = rawReceiveBytes(this->buffer_, remainBytes);
-              if (this->SOCKET_FAIL == rc)
+              // With readahead, all the available data is read (into the
+              // readahead buffer, which is empty at this point)
+              readPtr = this->readahead_ ? &this->buffer_[0] : loadPtr;
+              readSize = this->readahead_ ? this->MAX_BUFFER_SIZE : remainBytes;
+              rc = rawReceiveBytes(readPtr, readSize);
+              tryRead = this->non_blocking_;
+              if (this->isWouldBlock(rc))
+              {
+                LOG_COMM("Socket receive not ready, trying again");
+                tryRead = false;
+              }
+              else if (this->SOCKET_FAIL == rc)
               {
                 this->logSocketError("Socket received failed", rc);
 		        remainBytes = 0;
@@ -139,12 +307,19 @@ namespace industrial
                 rtn = false;
                 break;
               }
+              else if (this->readahead_)
+              {
+                LOG_COMM("Readahead receive, bytes read: %u, bytes reqd: %u", rc, remainBytes);
+                this->read_pos_ = 0;
+                this->read_end_ = rc;
+              }
               else
               {
                 remainBytes = remainBytes - rc;
                 LOG_COMM("Byte array receive, bytes read: %u, bytes reqd: %u, bytes left: %u",
                     rc, num_bytes, remainBytes);
-                buffer.load(&this->buffer_, rc);
+                buffer.extendBufferSize(rc);
+                loadPtr += rc;
                 rtn = true;
               }
             }
@@ -161,6 +336,18 @@ namespace industrial
               break;
             }
           }
+          else if (this->isReceiveTimedOut(start))
+          {
+            rtn = false;
+            if (num_bytes == remainBytes)
+            {
+              // Nothing received, the message stream is still intact
+              LOG_WARN("Socket receive timed out (%d ms)", this->getReceiveTimeout());
+              return rtn;
+            }
+            LOG_ERROR("Socket receive timed out (%d ms), bytes left: %d", this->getReceiveTimeout(), remainBytes);
+            break;
+          }
           else
           {
             LOG_COMM("Socket poll timeout, trying again");
@@ -177,30 +364,198 @@ namespace industrial
       {
         this->setConnected(false);
       }
+      else if (this->msg_receiving_)
+      {
+        this->msg_received_ += num_bytes;
+      }
+      return rtn;
+    }
+
+    bool SimpleSocket::receiveMsg(SimpleMessage & message)
+    {
+      bool rtn = false;
+
+      // The length/header and data are received separately (see
+      // SmplMsgConnection::receiveMsg), against a single deadline
+      this->msg_receiving_ = true;
+      this->msg_start_ = this->getTimeMs();
+      this->msg_received_ = 0;
+      rtn = SmplMsgConnection::receiveMsg(message);
+      this->msg_receiving_ = false;
+
+      if (!rtn && (this->msg_received_ > 0) && this->isConnected())
+      {
+        LOG_ERROR("Message receive failed after %d bytes, disconnecting", this->msg_received_);
+        this->setConnected(false);
+      }
+
       return rtn;
     }
 
-    bool SimpleSocket::poll(int timeout, bool & ready, bool & error)
+    bool SimpleSocket::isMsgBuffered()
+    {
+      char prefix[sizeof(shared_int)];
+      ByteArray lengthData;
+      shared_int length = 0;
+      int bufferedBytes = this->read_end_ - this->read_pos_;
+
+      if (bufferedBytes < (int)sizeof(prefix))
+      {
+        return false;
+      }
+
+      // The length prefix is decoded the same as a received message (see
+      // SmplMsgConnection::receiveMsg)
+      memcpy(prefix, &this->buffer_[this->read_pos_], sizeof(prefix));
+      if (!this->swapMsgBytes(prefix, sizeof(prefix)) || !lengthData.load(prefix, sizeof(prefix))
+          || !lengthData.unload(length))
+      {
+        return false;
+      }
+
+      return (length >= 0) && (bufferedBytes - (int)sizeof(prefix) >= length);
+    }
+
+    bool SimpleSocket::receiveAvailable()
+    {
+      int rc = this->SOCKET_FAIL;
+      int bufferedBytes = this->read_end_ - this->read_pos_;
+
+      if (!this->isConnected())
+      {
+        LOG_WARN("Not connected, bytes not received");
+        return false;
+      }
+
+      // Buffered data is moved to the start of the buffer, making room for
+      // the rest of the message
+      if (this->read_pos_ > 0)
+      {
+        memmove(&this->buffer_[0], &this->buffer_[this->read_pos_], bufferedBytes);
+        this->read_pos_ = 0;
+        this->read_end_ = bufferedBytes;
+      }
+
+      if (this->read_end_ >= this->MAX_BUFFER_SIZE)
+      {
+        LOG_ERROR("Readahead buffer full (%d bytes) without a complete message, disconnecting",
+            this->read_end_);
+        this->setConnected(false);
+        return false;
+      }
+
+      rc = rawReceiveBytes(&this->buffer_[this->read_end_], this->MAX_BUFFER_SIZE - this->read_end_);
+      if (this->isWouldBlock(rc))
+      {
+        LOG_COMM("Socket receive not ready");
+        return true;
+      }
+      else if (this->SOCKET_FAIL == rc)
+      {
+        this->logSocketError("Socket receive failed", rc);
+        this->setConnected(false);
+        return false;
+      }
+      else if (0 == rc)
+      {
+        LOG_WARN("Recieved zero bytes, connection closed");
+        this->setConnected(false);
+        return false;
+      }
+
+      LOG_COMM("Available receive, bytes read: %d, bytes buffered: %d", rc, this->read_end_ + rc);
+      this->read_end_ += rc;
+      return true;
+    }
+
+    bool SimpleSocket::pollReady(int timeout, bool send, bool & ready, bool & error)
     {
-      timeval time;
-      fd_set read, write, except;
       int rc = this->SOCKET_FAIL;
       bool rtn = false;
       ready = false;
       error = false;
 
-      // The select function uses the timeval data structure
-      time.tv_sec = timeout / 1000;
-      time.tv_usec = (timeout % 1000) * 1000;
+      // Buffered data is received without polling the socket
+      if (!send && this->isDataBuffered())
+      {
+        ready = true;
+        return true;
+      }
 
-      FD_ZERO(&read);
-      FD_ZERO(&write);
-      FD_ZERO(&except);
+#ifdef LINUXSOCKETS
+      if (PollMethods::POLL == this->getPollMethod())
+      {
+        pollfd fds;
+        fds.fd = this->getSockHandle();
+        fds.events = send ? POLLOUT : POLLIN;
+        fds.revents = 0;
 
-      FD_SET(this->getSockHandle(), &read);
-      FD_SET(this->getSockHandle(), &except);
+        rc = ::poll(&fds, 1, timeout);
+        ready = (0 < rc) && (fds.revents & fds.events);
+        error = (0 < rc) && !ready && (fds.revents & (POLLERR | POLLHUP | POLLNVAL));
+      }
+      else if (PollMethods::EPOLL == this->getPollMethod())
+      {
+        epoll_event event;
+        unsigned int events = send ? EPOLLOUT : EPOLLIN;
+
+        // The socket is only (re)registered if it (or the polled events) changed.
+        // A new socket gets a new wait set, the previous socket may have been closed
+        // (or its handle reused).
+        if (events != this->epoll_events_)
+        {
+          memset(&event, 0, sizeof(event));
+          event.events = events;
+          if (0 == this->epoll_events_)
+          {
+            if (this->SOCKET_FAIL != this->epoll_handle_)
+            {
+              CLOSE(this->epoll_handle_);
+            }
+            this->epoll_handle_ = epoll_create(1);
+            rc = epoll_ctl(this->epoll_handle_, EPOLL_CTL_ADD, this->getSockHandle(), &event);
+          }
+          else
+          {
+            rc = epoll_ctl(this->epoll_handle_, EPOLL_CTL_MOD, this->getSockHandle(), &event);
+          }
+          this->epoll_events_ = (this->SOCKET_FAIL != rc) ? events : 0;
+        }
+
+        if (0 != this->epoll_events_)
+        {
+          rc = epoll_wait(this->epoll_handle_, &event, 1, timeout);
+          ready = (0 < rc) && (event.events & events);
+          error = (0 < rc) && !ready && (event.events & (EPOLLERR | EPOLLHUP));
+        }
+      }
+      else
+#endif
+      {
+        timeval time;
+        fd_set fds, except;
+
+        if (FD_SETSIZE <= this->getSockHandle())
+        {
+          LOG_ERROR("Socket handle: %d, too large for select, use another poll method", this->getSockHandle());
+          return false;
+        }
+
+        // The select function uses the timeval data structure (NULL blocks)
+        time.tv_sec = timeout / 1000;
+        time.tv_usec = (timeout % 1000) * 1000;
 
-      rc = SELECT(this->getSockHandle() + 1, &read, &write, &except, &time);
+        FD_ZERO(&fds);
+        FD_ZERO(&except);
+
+        FD_SET(this->getSockHandle(), &fds);
+        FD_SET(this->getSockHandle(), &except);
+
+        rc = SELECT(this->getSockHandle() + 1, send ? NULL : &fds, send ? &fds : NULL, &except,
+                    (0 > timeout) ? NULL : &time);
+        ready = (0 < rc) && FD_ISSET(this->getSockHandle(), &fds);
+        error = (0 < rc) && !ready && FD_ISSET(this->getSockHandle(), &except);
+      }
 
       if (this->SOCKET_FAIL != rc)
       {
@@ -208,34 +563,111 @@ namespace industrial
         {
           rtn = false;
         }
+        else if (ready || error)
+        {
+          rtn = true;
+        }
         else
         {
-          if (FD_ISSET(this->getSockHandle(), &read))
-          {
-            ready = true;
-            rtn = true;
-          }
-          else if(FD_ISSET(this->getSockHandle(), &except))
-          {
-            error = true;
-            rtn = true;
-          }
-          else
-          {
-            LOG_WARN("Select returned, but no flags are set");
-            rtn = false;
-          }
+          LOG_WARN("Poll returned, but no flags are set");
+          rtn = false;
         }
       }
       else
       {
-        this->logSocketError("Socket select function failed", rc);
+        this->logSocketError("Socket poll function failed", rc);
         rtn = false;
       }
 
       return rtn;
     }
 
+    bool SimpleSocket::setPollMethod(PollMethod method)
+    {
+      bool rtn = false;
+
+      switch (method)
+      {
+        case PollMethods::SELECT:
+          rtn = true;
+          break;
+#ifdef LINUXSOCKETS
+        case PollMethods::POLL:
+        case PollMethods::EPOLL:
+          rtn = true;
+          break;
+#endif
+        default:
+          LOG_ERROR("Poll method: %d, not supported on this platform", method);
+          rtn = false;
+      }
+
+      if (rtn)
+      {
+        this->poll_method_ = method;
+      }
+      return rtn;
+    }
+
+    int SimpleSocket::getReceivePollTimeout(unsigned int start, int timeout)
+    {
+      int left = 0;
+
+      if (0 <= this->getReceiveTimeout())
+      {
+        left = this->getReceiveTimeout() - (int)(this->getTimeMs() - start);
+        if (left < timeout)
+        {
+          timeout = (0 < left) ? left : 0;
+        }
+      }
+      return timeout;
+    }
+
+    bool SimpleSocket::isReceiveTimedOut(unsigned int start)
+    {
+#ifdef LINUXSOCKETS
+      return (0 <= this->getReceiveTimeout())
+          && ((int)(this->getTimeMs() - start) >= this->getReceiveTimeout());
+#else
+      return false;
+#endif
+    }
+
+    bool SimpleSocket::isWouldBlock(int rc)
+    {
+#ifdef LINUXSOCKETS
+      return (this->SOCKET_FAIL == rc) && (EAGAIN == errno || EWOULDBLOCK == errno);
+#else
+      return false;
+#endif
+    }
+
+    bool SimpleSocket::setNonBlocking(bool enable)
+    {
+      bool rtn = false;
+#ifdef LINUXSOCKETS
+      int flags = fcntl(this->getSockHandle(), F_GETFL, 0);
+
+      if (this->SOCKET_FAIL != flags)
+      {
+        flags = enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+        rtn = (this->SOCKET_FAIL != fcntl(this->getSockHandle(), F_SETFL, flags));
+      }
+      if (rtn)
+      {
+        this->non_blocking_ = enable;
+      }
+      if (!rtn)
+      {
+        this->logSocketError("Failed to set socket blocking mode", flags);
+      }
+#else
+      LOG_ERROR("Non-blocking sockets are not supported on this platform");
+#endif
+      return rtn;
+    }
+
   }  //simple_socket
 }  //industrial
 
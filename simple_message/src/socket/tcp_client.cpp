@@ -43,7 +43,13 @@ namespace tcp_client
 
 TcpClient::TcpClient()
 {
-
+  this->connecting_ = false;
+  this->connect_start_ = 0;
+  this->next_connect_ = 0;
+  this->connect_timeout_ = this->DEFAULT_CONNECT_TIMEOUT;
+  this->backoff_min_ = this->DEFAULT_BACKOFF_MIN;
+  this->backoff_max_ = this->DEFAULT_BACKOFF_MAX;
+  this->backoff_ = 0;
 }
 
 TcpClient::~TcpClient()
@@ -54,60 +60,56 @@ TcpClient::~TcpClient()
 bool TcpClient::init(char *buff, int port_num)
 {
 
-  int rc;
   bool rtn;
-  int disableNodeDelay = 1;
 
-  rc = SOCKET(AF_INET, SOCK_STREAM, 0);
-  if (this->SOCKET_FAIL != rc)
+  if (this->openSocket())
   {
-    this->setSockHandle(rc);
-
-    // The set no delay disables the NAGEL algorithm
-    rc = SET_NO_DELAY(this->getSockHandle(), disableNodeDelay);
-    if (this->SOCKET_FAIL == rc)
-    {
-      LOG_WARN("Failed to set no socket delay, sending data can be delayed by up to 250ms");
-    }
-
     // Initialize address data structure
     memset(&this->sockaddr_, 0, sizeof(this->sockaddr_));
     this->sockaddr_.sin_family = AF_INET;
     this->sockaddr_.sin_addr.s_addr = INET_ADDR(buff);
     this->sockaddr_.sin_port = HTONS(port_num);
 
+    this->connecting_ = false;
+    this->backoff_ = 0;
     rtn = true;
 
   }
   else
   {
-    LOG_ERROR("Failed to create socket, rc: %d", rc);
     rtn = false;
   }
   return rtn;
 }
 
+bool TcpClient::setConnectBackoff(int min_delay, int max_delay)
+{
+  if (0 > min_delay || min_delay > max_delay)
+  {
+    LOG_ERROR("Invalid connect backoff, min: %d, max: %d", min_delay, max_delay);
+    return false;
+  }
+
+  this->backoff_min_ = min_delay;
+  this->backoff_max_ = max_delay;
+  return true;
+}
+
 bool TcpClient::makeConnect()
 {
   bool rtn = false;
-  int rc = this->SOCKET_FAIL;
-  SOCKLEN_T addrSize = 0;
 
   if (!this->isConnected())
   {
-    addrSize = sizeof(this->sockaddr_);
-    rc = CONNECT(this->getSockHandle(), (sockaddr *)&this->sockaddr_, addrSize);
-    if (this->SOCKET_FAIL != rc)
+    if (!this->isConnecting())
     {
-      LOG_INFO("Connected to server");
-      this->setConnected(true);
-      rtn = true;
+      this->startConnect();
     }
-    else
+    if (this->isConnecting())
     {
-      this->logSocketError("Failed to connect to server", rc);
-      rtn = false;
+      this->checkConnect(-1);
     }
+    rtn = this->isConnected();
   }
 
   else
@@ -119,6 +121,188 @@ bool TcpClient::makeConnect()
 
 }
 
+bool TcpClient::pollConnect(int timeout)
+{
+  unsigned int start = this->getTimeMs();
+  int left = timeout;
+  int wait = 0;
+
+  while (!this->isConnected())
+  {
+    if (this->isConnecting())
+    {
+      this->checkConnect(left);
+    }
+    else
+    {
+      // Wait (at most the time left) for the next attempt
+      wait = (int)(this->next_connect_ - this->getTimeMs());
+      if (0 < wait)
+      {
+        this->sleepMs((0 > left || left > wait) ? wait : left);
+      }
+
+      wait = (int)(this->next_connect_ - this->getTimeMs());
+      if (0 >= wait)
+      {
+        this->startConnect();
+      }
+    }
+
+    if (0 <= timeout)
+    {
+      left = timeout - (int)(this->getTimeMs() - start);
+      if (0 >= left)
+      {
+        break;
+      }
+    }
+  }
+
+  return this->isConnected();
+}
+
+bool TcpClient::openSocket()
+{
+  int rc;
+  int disableNodeDelay = 1;
+
+  if (this->SOCKET_FAIL != this->getSockHandle())
+  {
+    CLOSE(this->getSockHandle());
+    this->setSockHandle(this->SOCKET_FAIL);
+  }
+
+  rc = SOCKET(AF_INET, SOCK_STREAM, 0);
+  if (this->SOCKET_FAIL == rc)
+  {
+    LOG_ERROR("Failed to create socket, rc: %d", rc);
+    return false;
+  }
+  this->setSockHandle(rc);
+
+  // The set no delay disables the NAGEL algorithm
+  rc = SET_NO_DELAY(this->getSockHandle(), disableNodeDelay);
+  if (this->SOCKET_FAIL == rc)
+  {
+    LOG_WARN("Failed to set no socket delay, sending data can be delayed by up to 250ms");
+  }
+
+  return true;
+}
+
+void TcpClient::startConnect()
+{
+  int rc = this->SOCKET_FAIL;
+  SOCKLEN_T addrSize = sizeof(this->sockaddr_);
+
+  // A socket can't be reused after a failed connect, so each attempt
+  // starts with a new one
+  this->setConnected(false);
+  if (!this->openSocket())
+  {
+    this->failConnect();
+    return;
+  }
+
+#ifdef LINUXSOCKETS
+  if (!this->setNonBlocking(true))
+  {
+    LOG_WARN("Failed to set non-blocking socket, connect will block");
+  }
+#endif
+
+  rc = CONNECT(this->getSockHandle(), (sockaddr *)&this->sockaddr_, addrSize);
+  if (this->SOCKET_FAIL != rc)
+  {
+    this->finishConnect();
+  }
+#ifdef LINUXSOCKETS
+  else if (EINPROGRESS == errno)
+  {
+    LOG_DEBUG("Connect in progress");
+    this->connecting_ = true;
+    this->connect_start_ = this->getTimeMs();
+  }
+#endif
+  else
+  {
+    this->logSocketError("Failed to connect to server", rc);
+    this->failConnect();
+  }
+}
+
+void TcpClient::checkConnect(int timeout)
+{
+#ifdef LINUXSOCKETS
+  int wait = this->connect_timeout_ - (int)(this->getTimeMs() - this->connect_start_);
+  int err = 0;
+  SOCKLEN_T errSize = sizeof(err);
+  bool ready, error;
+
+  if (0 <= timeout && timeout < wait)
+  {
+    wait = timeout;
+  }
+
+  // Connect completion (or failure) is reported as ready to send
+  if (this->pollReady(0 < wait ? wait : 0, true, ready, error))
+  {
+    if (0 != getsockopt(this->getSockHandle(), SOL_SOCKET, SO_ERROR, &err, &errSize))
+    {
+      err = errno;
+    }
+
+    if (0 == err)
+    {
+      this->finishConnect();
+    }
+    else
+    {
+      LOG_ERROR("Failed to connect to server. Error: '%s' (errno: %d)", strerror(err), err);
+      this->failConnect();
+    }
+  }
+  else if ((int)(this->getTimeMs() - this->connect_start_) >= this->connect_timeout_)
+  {
+    LOG_ERROR("Failed to connect to server, timed out (%d ms)", this->connect_timeout_);
+    this->failConnect();
+  }
+#endif
+}
+
+void TcpClient::finishConnect()
+{
+  LOG_INFO("Connected to server");
+  this->connecting_ = false;
+  this->backoff_ = 0;
+#ifdef LINUXSOCKETS
+  this->setNonBlocking(false);
+#endif
+  this->setConnected(true);
+}
+
+void TcpClient::failConnect()
+{
+  this->connecting_ = false;
+  if (this->SOCKET_FAIL != this->getSockHandle())
+  {
+    CLOSE(this->getSockHandle());
+    this->setSockHandle(this->SOCKET_FAIL);
+  }
+
+  if (0 == this->backoff_)
+  {
+    this->backoff_ = this->backoff_min_;
+  }
+  else
+  {
+    this->backoff_ = (this->backoff_ > this->backoff_max_ / 2) ? this->backoff_max_ : 2 * this->backoff_;
+  }
+  this->next_connect_ = this->getTimeMs() + this->backoff_;
+  LOG_DEBUG("Next connect attempt in %d ms", this->backoff_);
+}
+
 } //tcp_client
 } //industrial
 
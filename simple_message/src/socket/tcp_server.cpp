@@ -54,7 +54,7 @@ TcpServer::~TcpServer()
   CLOSE(this->getSrvrHandle());
 }
 
-bool TcpServer::init(int port_num)
+bool TcpServer::init(int port_num, int backlog)
 {
   int rc;
   bool rtn;
@@ -85,7 +85,7 @@ bool TcpServer::init(int port_num)
     {
       LOG_INFO("Server socket successfully initialized");
 
-      rc = LISTEN(this->getSrvrHandle(), 1);
+      rc = LISTEN(this->getSrvrHandle(), backlog);
 
       if (this->SOCKET_FAIL != rc)
       {
@@ -116,48 +116,72 @@ bool TcpServer::init(int port_num)
 }
 
 bool TcpServer::makeConnect()
+{
+  bool rtn = false;
+
+  if (!this->isConnected())
+  {
+    rtn = this->acceptFrom(this->getSrvrHandle());
+  }
+  else
+  {
+    LOG_WARN("Tried to connect when socket already in connected state");
+  }
+
+  return rtn;
+
+}
+
+bool TcpServer::acceptClient(TcpServer & listener)
+{
+  return this->acceptFrom(listener.getSrvrHandle());
+}
+
+void TcpServer::closeClient()
+{
+  this->setConnected(false);
+  if (this->SOCKET_FAIL != this->getSockHandle())
+  {
+    CLOSE(this->getSockHandle());
+    this->setSockHandle(this->SOCKET_FAIL);
+  }
+}
+
+bool TcpServer::acceptFrom(int srvr_handle)
 {
   bool rtn = false;
   int rc = this->SOCKET_FAIL;
-  //int socket = this->SOCKET_FAIL;
   int disableNodeDelay = 1;
   int err = 0;
 
-  if (!this->isConnected())
-  {
-    this->setConnected(false);
-    if (this->SOCKET_FAIL != this->getSockHandle())
-    {
-      CLOSE(this->getSockHandle());
-      this->setSockHandle(this->SOCKET_FAIL);
-    }
+  this->closeClient();
 
-    rc = ACCEPT(this->getSrvrHandle(), NULL, NULL);
+  rc = ACCEPT(srvr_handle, NULL, NULL);
 
-    if (this->SOCKET_FAIL != rc)
-    {
-      this->setSockHandle(rc);
-      LOG_INFO("Client socket accepted");
+  if (this->SOCKET_FAIL != rc)
+  {
+    this->setSockHandle(rc);
+    LOG_INFO("Client socket accepted");
 
-      // The set no delay disables the NAGEL algorithm
-      rc = SET_NO_DELAY(this->getSockHandle(), disableNodeDelay);
-      err = errno;
-      if (this->SOCKET_FAIL == rc)
-      {
-        LOG_WARN("Failed to set no socket delay, errno: %d, sending data can be delayed by up to 250ms", err);
-      }
-      this->setConnected(true);
-      rtn = true;
-    }
-    else
+    // The set no delay disables the NAGEL algorithm
+    rc = SET_NO_DELAY(this->getSockHandle(), disableNodeDelay);
+    err = errno;
+    if (this->SOCKET_FAIL == rc)
     {
-      LOG_ERROR("Failed to accept for client connection");
-      rtn = false;
+      LOG_WARN("Failed to set no socket delay, errno: %d, sending data can be delayed by up to 250ms", err);
     }
+    this->setConnected(true);
+    rtn = true;
+  }
+  else if (this->isWouldBlock(rc))
+  {
+    LOG_COMM("No pending client connection");
+    rtn = false;
   }
   else
   {
-    LOG_WARN("Tried to connect when socket already in connected state");
+    LOG_ERROR("Failed to accept for client connection");
+    rtn = false;
   }
 
   return rtn;
@@ -77,6 +77,17 @@ int TcpSocket::rawSendBytes(char *buffer, shared_int num_bytes)
   return rc;
 }
 
+#ifdef LINUXSOCKETS
+int TcpSocket::rawSendVector(iovec *iov, int iov_count)
+{
+  int rc = this->SOCKET_FAIL;
+
+  rc = writev(this->getSockHandle(), iov, iov_count);
+
+  return rc;
+}
+#endif
+
 int TcpSocket::rawReceiveBytes(char *buffer, shared_int num_bytes)
 {
   int rc = this->SOCKET_FAIL;
@@ -95,6 +95,7 @@ bool UdpClient::makeConnect()
   bool rtn = false;
   const int timeout = 1000;  // Time (ms) between handshake sends
   int bytesRcvd = 0;
+  unsigned int start = this->getTimeMs();
   
   if (!this->isConnected())
   {
@@ -107,13 +108,18 @@ bool UdpClient::makeConnect()
       recvHS = 0;
       LOG_DEBUG("UDP client sending handshake");
       this->rawSendBytes(send.getRawDataPtr(), send.getBufferSize());
-      if (this->isReadyReceive(timeout))
+      if (this->isReadyReceive(this->getConnectPollTimeout(start, timeout)))
       {
-        bytesRcvd = this->rawReceiveBytes(this->buffer_, 0);
+        bytesRcvd = this->rawReceiveBytes(this->buffer_, this->MAX_BUFFER_SIZE);
  	LOG_DEBUG("UDP client received possible handshake");	
         recv.init(&this->buffer_[0], bytesRcvd);
         recv.unload((void*)&recvHS, sizeof(recvHS));
       }
+      else if (this->isConnectTimedOut(start))
+      {
+        LOG_WARN("UDP client handshake timed out (%d ms)", this->getConnectTimeout());
+        return false;
+      }
     }
     while(recvHS != sendHS);
     LOG_INFO("UDP client connected");
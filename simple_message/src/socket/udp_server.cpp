@@ -113,6 +113,7 @@ bool UdpServer::makeConnect()
   char recvHS = 0;
   int bytesRcvd = 0;
   bool rtn = false;
+  unsigned int start = this->getTimeMs();
   
   send.load((void*)&sendHS, sizeof(sendHS));
     
@@ -126,7 +127,16 @@ bool UdpServer::makeConnect()
     {
       ByteArray recv;
       recvHS = 0;
-      bytesRcvd = this->rawReceiveBytes(this->buffer_, 0);
+      bytesRcvd = 0;
+      if (this->isReadyReceive(this->getConnectPollTimeout(start, -1)))
+      {
+        bytesRcvd = this->rawReceiveBytes(this->buffer_, this->MAX_BUFFER_SIZE);
+      }
+      else if (this->isConnectTimedOut(start))
+      {
+        LOG_WARN("UDP server handshake timed out (%d ms)", this->getConnectTimeout());
+        return false;
+      }
       
       if (bytesRcvd > 0)
       {
@@ -55,6 +55,15 @@ UdpSocket::UdpSocket()
 {
   this->setSockHandle(this->SOCKET_FAIL);
   memset(&this->sockaddr_, 0, sizeof(this->sockaddr_));
+  this->sequencing_ = false;
+  this->latest_only_ = false;
+  this->connect_timeout_ = -1;
+  this->send_seq_ = 0;
+  this->recv_seq_ = 0;
+  this->recv_seq_valid_ = false;
+  this->resetSequenceStats();
+  this->recv_count_ = 0;
+  this->recv_next_ = 0;
 
 }
 
@@ -65,57 +74,475 @@ UdpSocket::~UdpSocket()
   CLOSE(this->getSockHandle());
 }
 
+void UdpSocket::setConnected(bool connected)
+{
+  if (connected != this->isConnected())
+  {
+    // Received datagrams belong to the previous connection (or handshake)
+    this->recv_count_ = 0;
+    this->recv_next_ = 0;
+  }
+  if (connected && !this->isConnected())
+  {
+    // Each connection starts a new sequence
+    this->send_seq_ = 0;
+    this->recv_seq_ = 0;
+    this->recv_seq_valid_ = false;
+    this->resetSequenceStats();
+  }
+  SimpleSocket::setConnected(connected);
+}
+
 bool UdpSocket::receiveMsg(SimpleMessage & message)
 {
-  ByteArray msgBuffer;
+  int rc = this->SOCKET_FAIL;
+  bool rtn = false;
+  bool ready, error;
+  bool stale = false;
+  char* data = NULL;
+  unsigned int start = this->getTimeMs();
+
+  if (!this->isConnected())
+  {
+    LOG_WARN("Not connected, message not received");
+    return false;
+  }
+
+  // Stale datagrams are discarded, the receive continues (within the
+  // receive timeout) until a valid datagram arrives.
+  do
+  {
+    // Polling the socket results in an "interruptable" socket read (see
+    // SimpleSocket::receiveBytes)
+    while (!this->poll(this->getReceivePollTimeout(start, this->SOCKET_POLL_TO), ready, error))
+    {
+      if (this->isReceiveTimedOut(start))
+      {
+        LOG_WARN("Socket receive timed out (%d ms)", this->getReceiveTimeout());
+        return false;
+      }
+      LOG_COMM("Socket poll timeout, trying again");
+    }
+
+    rc = this->SOCKET_FAIL;
+    if (ready)
+    {
+      rc = this->receiveDatagram(data);
+    }
+    else
+    {
+      LOG_ERROR("Socket poll returned an error");
+    }
+
+    rtn = this->parseMsg(data, rc, message, stale);
+  }
+  while (stale);
+
+  // Any datagrams already waiting (or received) are newer, the message is
+  // replaced by the newest (valid) of them.  Invalid datagrams are skipped.
+  while (rtn && this->isLatestOnly() && this->isConnected() && this->poll(0, ready, error) && ready)
+  {
+    rc = this->receiveDatagram(data);
+    if (this->parseMsg(data, rc, this->latest_msg_, stale)
+        && message.init(this->latest_msg_.getMessageType(), this->latest_msg_.getCommType(),
+                        this->latest_msg_.getReplyCode(), this->latest_msg_.getData()))
+    {
+      this->num_skipped_++;
+    }
+    else if (!stale)
+    {
+      LOG_WARN("Skipping invalid datagram, latest valid message kept");
+    }
+  }
+
+  return rtn;
+}
 
+bool UdpSocket::parseMsg(char* data, int rc, SimpleMessage & message, bool & stale)
+{
+  ByteArray & msgData = message.getData();
+  ByteArrayReader reader;
+  const int seqSize = this->isSequencing() ? sizeof(shared_int) : 0;
+  const int prefixSize = seqSize + message.getLengthSize() + message.getHeaderSize();
   bool rtn = false;
+  shared_int seq = 0;
   shared_int size = 0;
+  int msgType;
+  int commType;
+  int replyCode;
+
+  stale = false;
+
+  if (this->SOCKET_FAIL == rc)
+  {
+    this->logSocketError("Socket receive failed", rc);
+    rtn = false;
+  }
+  else if (rc >= prefixSize)
+  {
+    LOG_DEBUG("Receive message bytes: %d", rc);
+
+    // The entire datagram is byte swapped (if enabled) before it is parsed
+    // in place.  The sequence number is checked before the message is
+    // modified.
+    rtn = this->swapMsgBytes(data, rc);
+    reader.init(data, rc);
+    if (rtn && (seqSize > 0))
+    {
+      rtn = reader.unload(seq);
+      if (rtn && !this->checkSequence(seq))
+      {
+        LOG_COMM("Discarding stale datagram, sequence: %d", seq);
+        stale = true;
+        return false;
+      }
+    }
+
+    rtn = rtn && reader.unload(size) && reader.unload(msgType) && reader.unload(commType)
+        && reader.unload(replyCode);
 
-  rtn = this->receiveBytes(msgBuffer, 0);
-
-  if (rtn)
-  {
-    LOG_DEBUG("Receive message bytes: %u", msgBuffer.getBufferSize());
-    if (msgBuffer.getBufferSize() >= sizeof(shared_int))
-    {
-	    LOG_DEBUG("Unloading message length from front of the buffer");
-	    msgBuffer.unloadFront((void*)(&size), sizeof(shared_int));
-
-	    if ( size != (shared_int) msgBuffer.getBufferSize() )
-	    {
-	      LOG_WARN("readBytes returned a message other than the expected size");
-	    }
-	    rtn = message.init(msgBuffer);
-
-	    if (rtn)
-	    {
-	      rtn = true;
-	    }
-	    else
-	    {
-	      LOG_ERROR("Failed to initialize message");
-	      rtn = false;
-	    }
-     }
-     else
-     {
-        LOG_ERROR("Receive bytes returned small: %d message", rtn);
-        LOG_ERROR("Possible handshake or other connection issue, setting disconnected");
-        this->setConnected(false);
-        rtn = false;
-     }
+    if ( size != (shared_int) (rc - seqSize - message.getLengthSize()) )
+    {
+      LOG_WARN("readBytes returned a message other than the expected size");
+    }
 
+    if (rtn)
+    {
+      msgData.init();
+      rtn = reader.unload(msgData, reader.getRemainSize());
+    }
+
+    if (rtn)
+    {
+      rtn = message.initHeader(msgType, commType, replyCode);
+    }
+    else
+    {
+      LOG_ERROR("Failed to initialize message");
+      rtn = false;
+    }
   }
   else
   {
-    LOG_ERROR("Failed to receive message");
+    LOG_ERROR("Receive bytes returned small: %d message", rc);
+    LOG_ERROR("Possible handshake or other connection issue, setting disconnected");
+    this->setConnected(false);
     rtn = false;
   }
 
   return rtn;
 }
 
+bool UdpSocket::checkSequence(shared_int seq)
+{
+  // Unsigned arithmetic handles sequence number wrap around
+  int diff = (int)((unsigned int)seq - (unsigned int)this->recv_seq_);
+
+  if (this->recv_seq_valid_ && (diff <= 0) && (diff > -this->SEQUENCE_WINDOW))
+  {
+    this->num_stale_++;
+    return false;
+  }
+
+  if (!this->recv_seq_valid_ || (diff <= 0))
+  {
+    if (this->recv_seq_valid_)
+    {
+      LOG_WARN("UDP sequence restarted (%d -> %d)", this->recv_seq_, seq);
+    }
+  }
+  else if (diff > 1)
+  {
+    LOG_DEBUG("UDP datagrams lost: %d", diff - 1);
+    this->num_lost_ += diff - 1;
+  }
+
+  this->recv_seq_ = seq;
+  this->recv_seq_valid_ = true;
+  return true;
+}
+
+int UdpSocket::receiveDatagram(char* & data)
+{
+#ifdef LINUXSOCKETS
+  int idx;
+
+  if (this->recv_next_ >= this->recv_count_ && 0 >= this->receiveBatch())
+  {
+    return this->SOCKET_FAIL;
+  }
+
+  // Replies go to the source of the last received datagram
+  idx = this->recv_next_++;
+  memcpy(&this->sockaddr_, &this->recv_addrs_[idx], sizeof(this->sockaddr_));
+  data = this->recv_buffers_[idx];
+  return this->recv_msgs_[idx].msg_len;
+#else
+  data = &this->buffer_[0];
+  return this->rawReceiveBytes(this->buffer_, this->MAX_BUFFER_SIZE);
+#endif
+}
+
+#ifdef LINUXSOCKETS
+int UdpSocket::receiveBatch()
+{
+  int rc = this->SOCKET_FAIL;
+
+  // Every waiting datagram (up to the batch size) is received at once
+  for (int idx = 0; idx < this->RECV_BATCH_SIZE; idx++)
+  {
+    this->recv_iov_[idx].iov_base = this->recv_buffers_[idx];
+    this->recv_iov_[idx].iov_len = this->MAX_BUFFER_SIZE;
+    memset(&this->recv_msgs_[idx], 0, sizeof(this->recv_msgs_[idx]));
+    this->recv_msgs_[idx].msg_hdr.msg_name = &this->recv_addrs_[idx];
+    this->recv_msgs_[idx].msg_hdr.msg_namelen = sizeof(this->recv_addrs_[idx]);
+    this->recv_msgs_[idx].msg_hdr.msg_iov = &this->recv_iov_[idx];
+    this->recv_msgs_[idx].msg_hdr.msg_iovlen = 1;
+  }
+
+  this->recv_next_ = this->recv_count_ = 0;
+  rc = this->rawReceiveBatch(this->recv_msgs_, this->RECV_BATCH_SIZE);
+  if (0 < rc)
+  {
+    LOG_COMM("Received datagram batch: %d", rc);
+    this->recv_count_ = rc;
+  }
+  return rc;
+}
+#endif
+
+bool UdpSocket::receiveAvailable()
+{
+  if (!this->isConnected())
+  {
+    LOG_WARN("Not connected, message not received");
+    return false;
+  }
+
+#ifdef LINUXSOCKETS
+  // Each datagram is a complete message, the waiting datagrams are received
+  // into the batch (if it is empty)
+  if (!this->isMsgBuffered())
+  {
+    int rc = this->receiveBatch();
+    if (0 >= rc && !this->isWouldBlock(rc))
+    {
+      // Receive failures don't close datagram "connections" (see receiveMsg)
+      this->logSocketError("Socket receive failed", rc);
+    }
+  }
+#endif
+  return true;
+}
+
+bool UdpSocket::loadSequence(ByteArray & seqData)
+{
+  seqData.init();
+  return seqData.load(this->send_seq_++)
+      && this->swapMsgBytes(seqData.getRawDataPtr(), seqData.getBufferSize());
+}
+
+bool UdpSocket::sendBytes(ByteArray & buffer)
+{
+  ByteArrayReader reader;
+  ByteArray seqData;
+  char prefix[sizeof(shared_int)];
+  char* sendPtr = buffer.getRawDataPtr();
+  int remainBytes = buffer.getBufferSize();
+  const int seqSize = this->isSequencing() ? sizeof(shared_int) : 0;
+  shared_int length = 0;
+  int msgSize;
+  bool rtn = true;
+#ifdef LINUXSOCKETS
+  mmsghdr msgs[SEND_BATCH_SIZE];
+  iovec iov[SEND_BATCH_SIZE][2];
+  char seqs[SEND_BATCH_SIZE][sizeof(shared_int)];
+  int count = 0;
+#else
+  ByteArray datagram;
+#endif
+
+  if (!this->isConnected())
+  {
+    LOG_WARN("Not connected, bytes not sent");
+    return false;
+  }
+
+  while (rtn && (remainBytes > 0))
+  {
+    // The length prefix is decoded the same as a received message (the
+    // buffer is byte swapped, if enabled)
+    rtn = (remainBytes >= (int)sizeof(prefix));
+    if (rtn)
+    {
+      memcpy(prefix, sendPtr, sizeof(prefix));
+      reader.init(prefix, sizeof(prefix));
+      rtn = this->swapMsgBytes(prefix, sizeof(prefix)) && reader.unload(length);
+    }
+    msgSize = sizeof(prefix) + length;
+    if (!rtn || (length < 0) || (msgSize > remainBytes)
+        || (seqSize + msgSize > this->MAX_BUFFER_SIZE))
+    {
+      LOG_ERROR("Send buffer does not hold a complete message (bytes left: %d)", remainBytes);
+      rtn = false;
+      break;
+    }
+
+    if (this->isSequencing())
+    {
+      rtn = this->loadSequence(seqData);
+    }
+
+#ifdef LINUXSOCKETS
+    memcpy(seqs[count], seqData.getRawDataPtr(), seqSize);
+    iov[count][0].iov_base = seqs[count];
+    iov[count][0].iov_len = seqSize;
+    iov[count][1].iov_base = sendPtr;
+    iov[count][1].iov_len = msgSize;
+    memset(&msgs[count], 0, sizeof(msgs[count]));
+    msgs[count].msg_hdr.msg_name = &this->sockaddr_;
+    msgs[count].msg_hdr.msg_namelen = sizeof(this->sockaddr_);
+    msgs[count].msg_hdr.msg_iov = iov[count];
+    msgs[count].msg_hdr.msg_iovlen = 2;
+    count++;
+
+    if ((this->SEND_BATCH_SIZE == count) || (msgSize == remainBytes))
+    {
+      rtn = rtn && this->sendBatch(msgs, count);
+      count = 0;
+    }
+#else
+    datagram.copyFrom(seqData);
+    rtn = rtn && datagram.load(sendPtr, msgSize)
+        && (msgSize + seqSize == this->rawSendBytes(datagram.getRawDataPtr(), msgSize + seqSize));
+#endif
+
+    sendPtr += msgSize;
+    remainBytes -= msgSize;
+  }
+
+  if (!rtn)
+  {
+    this->setConnected(false);
+  }
+
+  return rtn;
+}
+
+bool UdpSocket::sendGatherBytes(ByteArray & prefix, ByteArray & data)
+{
+#ifdef LINUXSOCKETS
+  ByteArray seqData;
+  mmsghdr msg;
+  iovec iov[3];
+
+  // Runtime byte swapping modifies the message bytes, which requires a copy
+  // (see sendBytes)
+  if (this->isByteSwapping())
+  {
+    return SmplMsgConnection::sendGatherBytes(prefix, data);
+  }
+
+  if (!this->isConnected())
+  {
+    LOG_WARN("Not connected, bytes not sent");
+    return false;
+  }
+
+  if (this->isSequencing() && !this->loadSequence(seqData))
+  {
+    LOG_ERROR("Failed to load sequence number");
+    return false;
+  }
+
+  if (this->MAX_BUFFER_SIZE < (int)(seqData.getBufferSize() + prefix.getBufferSize() + data.getBufferSize()))
+  {
+    LOG_ERROR("Message size: %u, is greater than max socket size: %u",
+              prefix.getBufferSize() + data.getBufferSize(), this->MAX_BUFFER_SIZE);
+    return false;
+  }
+
+  // The sequence number, prefix and data are sent as a single datagram
+  iov[0].iov_base = seqData.getRawDataPtr();
+  iov[0].iov_len = seqData.getBufferSize();
+  iov[1].iov_base = prefix.getRawDataPtr();
+  iov[1].iov_len = prefix.getBufferSize();
+  iov[2].iov_base = data.getRawDataPtr();
+  iov[2].iov_len = data.getBufferSize();
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_hdr.msg_name = &this->sockaddr_;
+  msg.msg_hdr.msg_namelen = sizeof(this->sockaddr_);
+  msg.msg_hdr.msg_iov = iov;
+  msg.msg_hdr.msg_iovlen = 3;
+
+  if (!this->sendBatch(&msg, 1))
+  {
+    this->setConnected(false);
+    return false;
+  }
+  return true;
+#else
+  return SmplMsgConnection::sendGatherBytes(prefix, data);
+#endif
+}
+
+#ifdef LINUXSOCKETS
+bool UdpSocket::sendBatch(mmsghdr *msgs, int count)
+{
+  int rc = this->SOCKET_FAIL;
+
+  while (count > 0)
+  {
+    rc = this->rawSendBatch(msgs, count);
+    if (this->SOCKET_FAIL != rc)
+    {
+      msgs += rc;
+      count -= rc;
+    }
+    else if (this->isWouldBlock(rc))
+    {
+      if (!this->pollSend(this->SOCKET_POLL_TO))
+      {
+        LOG_ERROR("Socket not ready to send, datagrams left: %d", count);
+        return false;
+      }
+    }
+    else
+    {
+      this->logSocketError("Socket sendmmsg failed", rc);
+      return false;
+    }
+  }
+
+  return true;
+}
+#endif
+
+int UdpSocket::getConnectPollTimeout(unsigned int start, int timeout)
+{
+  int left = 0;
+
+  if (0 <= this->getConnectTimeout())
+  {
+    left = this->getConnectTimeout() - (int)(this->getTimeMs() - start);
+    if ((timeout < 0) || (left < timeout))
+    {
+      timeout = (0 < left) ? left : 0;
+    }
+  }
+  return timeout;
+}
+
+bool UdpSocket::isConnectTimedOut(unsigned int start)
+{
+#ifdef LINUXSOCKETS
+  return (0 <= this->getConnectTimeout())
+      && ((int)(this->getTimeMs() - start) >= this->getConnectTimeout());
+#else
+  return false;
+#endif
+}
+
 int UdpSocket::rawSendBytes(char *buffer, shared_int num_bytes)
 {
   int rc = this->SOCKET_FAIL;
@@ -127,6 +554,35 @@ int UdpSocket::rawSendBytes(char *buffer, shared_int num_bytes)
   return rc;
 }
 
+#ifdef LINUXSOCKETS
+int UdpSocket::rawSendVector(iovec *iov, int iov_count)
+{
+  int rc = this->SOCKET_FAIL;
+  msghdr msg;
+
+  // The buffers are sent as a single datagram
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_name = &this->sockaddr_;
+  msg.msg_namelen = sizeof(this->sockaddr_);
+  msg.msg_iov = iov;
+  msg.msg_iovlen = iov_count;
+
+  rc = sendmsg(this->getSockHandle(), &msg, 0);
+
+  return rc;
+}
+
+int UdpSocket::rawSendBatch(mmsghdr *msgs, int count)
+{
+  return sendmmsg(this->getSockHandle(), msgs, count, 0);
+}
+
+int UdpSocket::rawReceiveBatch(mmsghdr *msgs, int count)
+{
+  return recvmmsg(this->getSockHandle(), msgs, count, MSG_DONTWAIT, NULL);
+}
+#endif
+
 int UdpSocket::rawReceiveBytes(char *buffer, shared_int num_bytes)
 {
   int rc = this->SOCKET_FAIL;
@@ -134,7 +590,7 @@ int UdpSocket::rawReceiveBytes(char *buffer, shared_int num_bytes)
 
   addrSize = sizeof(this->sockaddr_);
 
-  rc = RECV_FROM(this->getSockHandle(), &this->buffer_[0], this->MAX_BUFFER_SIZE,
+  rc = RECV_FROM(this->getSockHandle(), buffer, num_bytes,
       0, (sockaddr *)&this->sockaddr_, &addrSize);
   
   return rc;
@@ -0,0 +1,490 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2013, Southwest Research Institute
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 	* Redistributions of source code must retain the above copyright
+ * 	notice, this list of conditions and the following disclaimer.
+ * 	* Redistributions in binary form must reproduce the above copyright
+ * 	notice, this list of conditions and the following disclaimer in the
+ * 	documentation and/or other materials provided with the distribution.
+ * 	* Neither the name of the Southwest Research Institute, nor the names
+ *	of its contributors may be used to endorse or promote products derived
+ *	from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "simple_message/simple_message.h"
+#include "simple_message/byte_array.h"
+#include "simple_message/shared_types.h"
+#include "simple_message/smpl_msg_connection.h"
+#include "simple_message/socket/udp_client.h"
+#include "simple_message/socket/udp_server.h"
+#include "simple_message/socket/tcp_client.h"
+#include "simple_message/socket/tcp_server.h"
+#include "simple_message/messages/joint_message.h"
+#include "simple_message/joint_data.h"
+#include "simple_message/joint_traj_pt.h"
+#include "simple_message/messages/joint_traj_pt_message.h"
+#include "simple_message/message_handler.h"
+#include "simple_message/message_manager.h"
+
+#include <pthread.h>
+#include <sys/time.h>
+#include <stdio.h>
+#include <time.h>
+#include <algorithm>
+
+using namespace industrial::simple_message;
+using namespace industrial::byte_array;
+using namespace industrial::shared_types;
+using namespace industrial::smpl_msg_connection;
+using namespace industrial::udp_client;
+using namespace industrial::udp_server;
+using namespace industrial::tcp_socket;
+using namespace industrial::tcp_client;
+using namespace industrial::tcp_server;
+using namespace industrial::joint_data;
+using namespace industrial::joint_message;
+using namespace industrial::joint_traj_pt;
+using namespace industrial::joint_traj_pt_message;
+using namespace industrial::message_manager;
+
+/*
+ * Benchmarks for simple message encoding, dispatch and (loopback) socket
+ * streaming.  These are not run as tests (the timing results are printed).
+ *
+ * The benchmark requires TEST_PORT_BASE to be defined (see CMakeLists.txt).
+ */
+
+// Returns the elapsed time (in seconds) since start
+double elapsed(timeval & start)
+{
+  timeval now;
+  gettimeofday(&now, NULL);
+  return (now.tv_sec - start.tv_sec) + (now.tv_usec - start.tv_usec) / 1e6;
+}
+
+// Counts the messages it receives
+class CountHandler : public industrial::message_handler::MessageHandler
+{
+  public:
+  CountHandler() : count_(0) {};
+  bool init(int msg_type, SmplMsgConnection* connection)
+  {
+    return MessageHandler::init(msg_type, connection);
+  }
+  bool internalCB(SimpleMessage & in)
+  {
+    this->count_++;
+    return true;
+  }
+  int count_;
+};
+
+// "Receives" messages of a pre-defined type (without any socket I/O)
+class LoopbackConnection : public SmplMsgConnection
+{
+  public:
+  LoopbackConnection() : msg_type_(StandardMsgTypes::INVALID) {};
+  bool receiveMsg(SimpleMessage & message)
+  {
+    return message.init(this->msg_type_, CommTypes::TOPIC, ReplyTypes::INVALID);
+  }
+  bool sendMsg(SimpleMessage & message) { return true; }
+  bool isConnected() { return true; }
+  bool makeConnect() { return true; }
+  int msg_type_;
+  protected:
+  bool sendBytes(ByteArray & buffer) { return true; }
+  bool receiveBytes(ByteArray & buffer, shared_int num_bytes) { return false; }
+};
+
+// Counts socket reads
+class ReadCountTcpServer : public TcpServer
+{
+  public:
+  ReadCountTcpServer() : reads_(0) {};
+  int rawReceiveBytes(char *buffer, shared_int num_bytes)
+  {
+    this->reads_++;
+    return RECV(this->getSockHandle(), buffer, num_bytes, 0);
+  }
+  int reads_;
+};
+
+// Counts socket writes
+class SendCountTcpClient : public TcpClient
+{
+  public:
+  SendCountTcpClient() : sends_(0) {};
+  int sends_;
+  protected:
+  int rawSendBytes(char *buffer, shared_int num_bytes)
+  {
+    this->sends_++;
+    return SEND(this->getSockHandle(), buffer, num_bytes, 0);
+  }
+#ifdef LINUXSOCKETS
+  int rawSendVector(iovec *iov, int iov_count)
+  {
+    this->sends_++;
+    return writev(this->getSockHandle(), iov, iov_count);
+  }
+#endif
+};
+
+#ifdef LINUXSOCKETS
+// Counts batched udp socket sends
+class SendCountUdpClient : public UdpClient
+{
+  public:
+  SendCountUdpClient() : sends_(0) {};
+  int sends_;
+  protected:
+  int rawSendBatch(mmsghdr *msgs, int count)
+  {
+    this->sends_++;
+    return UdpClient::rawSendBatch(msgs, count);
+  }
+};
+
+// Counts batched udp socket receives
+class ReceiveCountUdpServer : public UdpServer
+{
+  public:
+  ReceiveCountUdpServer() : receives_(0) {};
+  int receives_;
+  protected:
+  int rawReceiveBatch(mmsghdr *msgs, int count)
+  {
+    this->receives_++;
+    return UdpServer::rawReceiveBatch(msgs, count);
+  }
+};
+
+// Utility for running a udp server connect (waits for the client handshake)
+void*
+udpConnect(void* arg)
+{
+  UdpServer* server = (UdpServer*)arg;
+  server->makeConnect();
+  return NULL;
+}
+#endif
+
+struct StreamSenderArgs
+{
+  SmplMsgConnection* client;
+  int num_msgs;
+  bool queue;  // queue (batch) messages, see SmplMsgConnection::queueMsg
+};
+
+// Utility for sending a stream of joint messages (as fast as possible)
+void*
+streamSender(void* arg)
+{
+  StreamSenderArgs* args = (StreamSenderArgs*)arg;
+  JointData joints;
+  JointMessage jMsg;
+  SimpleMessage msg;
+
+  for (int i = 0; i < args->num_msgs; i++)
+  {
+    jMsg.init(i, joints);
+    jMsg.toTopic(msg);
+    if (!(args->queue ? args->client->queueMsg(msg) : args->client->sendMsg(msg)))
+    {
+      break;
+    }
+  }
+  args->client->flush();
+  return NULL;
+}
+
+// Receives a stream of joint messages (in order), returns the number received
+int
+receiveStream(SmplMsgConnection & server, int num_msgs)
+{
+  SimpleMessage msg;
+  JointMessage jMsg;
+  int received = 0;
+
+  for (received = 0; received < num_msgs; received++)
+  {
+    if (!server.receiveMsg(msg) || !jMsg.init(msg) || received != jMsg.getSequence())
+    {
+      break;
+    }
+  }
+  return received;
+}
+
+// Decoding of a joint trajectory point message, copy/unload (previous
+// message init method) vs forward, in place, read
+bool
+decodeBenchmark()
+{
+  const int ITERATIONS = 100000;
+  JointTrajPtMessage send, recv;
+  JointTrajPt point;
+  JointData joint;
+  SimpleMessage msg;
+  timeval start;
+  double copyTime, readerTime;
+
+  joint.init();
+  for (int i = 0; i < joint.getMaxNumJoints(); i++)
+  {
+    joint.setJoint(i, 1.0 + i);
+  }
+  point.init(1, joint, 0.5, 2.0);
+  send.init(point);
+  if (!send.toTopic(msg))
+  {
+    return false;
+  }
+
+  gettimeofday(&start, NULL);
+  for (int i = 0; i < ITERATIONS; i++)
+  {
+    ByteArray data = msg.getData();
+    if (!data.unload(recv.point_))
+    {
+      return false;
+    }
+  }
+  copyTime = elapsed(start);
+
+  gettimeofday(&start, NULL);
+  for (int i = 0; i < ITERATIONS; i++)
+  {
+    if (!recv.init(msg))
+    {
+      return false;
+    }
+  }
+  readerTime = elapsed(start);
+
+  printf("JointTrajPtMessage decode (%d iterations), copy/unload: %f s, in place read: %f s\n",
+         ITERATIONS, copyTime, readerTime);
+  return send.point_==recv.point_;
+}
+
+// Dispatch cost of the last added handler (the worst case of a linear search)
+bool
+dispatchBenchmark()
+{
+  const int MAX_HANDLERS = 200;
+  const int ITERATIONS = 1000000;
+  MessageManager manager;
+  LoopbackConnection connection;
+  CountHandler handlers[MAX_HANDLERS];
+  timeval start;
+
+  if (!manager.init(&connection))
+  {
+    return false;
+  }
+
+  // Limited by the max number of handlers (FIXED_SIZE_BUFFERS), less the ping handler
+  const int NUM_HANDLERS = std::min(MAX_HANDLERS, (int)manager.getMaxNumHandlers() - 1);
+
+  // Sparse (vendor specific) message types
+  for (int i = 0; i < NUM_HANDLERS; i++)
+  {
+    int type = (i % 2) ? StandardMsgTypes::SWRI_MSG_BEGIN + 7 * i : StandardMsgTypes::MOTOMAN_MSG_BEGIN + i;
+    if (!handlers[i].init(type, &connection) || !manager.add(&handlers[i]))
+    {
+      return false;
+    }
+  }
+
+  connection.msg_type_ = handlers[NUM_HANDLERS - 1].getMsgType();
+  gettimeofday(&start, NULL);
+  for (int i = 0; i < ITERATIONS; i++)
+  {
+    manager.spinOnce();
+  }
+  printf("MessageManager spinOnce (%d handlers, %d iterations): %f us per message\n", NUM_HANDLERS + 1,
+         ITERATIONS, elapsed(start) * 1e6 / ITERATIONS);
+  return ITERATIONS == handlers[NUM_HANDLERS - 1].count_;
+}
+
+// Loopback joint message stream, with and without readahead
+bool
+readaheadBenchmark()
+{
+  const int tcpPort = TEST_PORT_BASE;
+  char ipAddr[] = "127.0.0.1";
+  const int NUM_MSGS = 100000;
+
+  for (int i = 0; i < 2; i++)
+  {
+    bool readahead = (1 == i);
+    TcpClient tcpClient;
+    ReadCountTcpServer tcpServer;
+    StreamSenderArgs args = {&tcpClient, NUM_MSGS, false};
+    pthread_t senderThrd;
+    timeval start;
+    int received = 0;
+
+    if (!tcpServer.init(tcpPort + i) || !tcpClient.init(&ipAddr[0], tcpPort + i)
+        || !tcpClient.makeConnect() || !tcpServer.makeConnect())
+    {
+      return false;
+    }
+    tcpServer.setReadahead(readahead);
+
+    gettimeofday(&start, NULL);
+    pthread_create(&senderThrd, NULL, streamSender, &args);
+    received = receiveStream(tcpServer, NUM_MSGS);
+    pthread_join(senderThrd, NULL);
+
+    printf("Joint message stream (readahead: %d, %d messages): %f reads, %f us per message\n", readahead,
+           NUM_MSGS, (double)tcpServer.reads_ / NUM_MSGS, elapsed(start) * 1e6 / NUM_MSGS);
+    if (NUM_MSGS != received)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Loopback joint message stream, with and without batching (see
+// SmplMsgConnection::setBatching)
+bool
+batchingBenchmark()
+{
+  const int tcpPort = TEST_PORT_BASE + 2;
+  char ipAddr[] = "127.0.0.1";
+  const int NUM_MSGS = 100000;
+
+  for (int i = 0; i < 2; i++)
+  {
+    bool queue = (1 == i);
+    SendCountTcpClient tcpClient;
+    TcpServer tcpServer;
+    StreamSenderArgs args = {&tcpClient, NUM_MSGS, queue};
+    pthread_t senderThrd;
+    timeval start;
+    int received = 0;
+
+    if (!tcpServer.init(tcpPort + i) || !tcpClient.init(&ipAddr[0], tcpPort + i)
+        || !tcpClient.makeConnect() || !tcpServer.makeConnect()
+        || !tcpClient.setBatching(queue ? SmplMsgConnection::MAX_BATCH_BYTES : 0, 1000))
+    {
+      return false;
+    }
+
+    gettimeofday(&start, NULL);
+    pthread_create(&senderThrd, NULL, streamSender, &args);
+    received = receiveStream(tcpServer, NUM_MSGS);
+    pthread_join(senderThrd, NULL);
+
+    printf("Joint message stream (batched: %d, %d messages): %d writes, %f us per message\n", queue,
+           NUM_MSGS, tcpClient.sends_, elapsed(start) * 1e6 / NUM_MSGS);
+    if (NUM_MSGS != received)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+#ifdef LINUXSOCKETS
+// Loopback (sequenced) UDP joint message stream, with and without batching.
+// The stream ends when the receive times out.  Stream datagrams may be
+// dropped (if the receiver falls behind).
+bool
+udpBenchmark()
+{
+  const int udpPort = TEST_PORT_BASE + 4;
+  char ipAddr[] = "127.0.0.1";
+  const int NUM_MSGS = 20000;
+  SendCountUdpClient udpClient;
+  ReceiveCountUdpServer udpServer;
+  SimpleMessage msg;
+  pthread_t connectThrd;
+
+  if (!udpServer.init(udpPort) || !udpClient.init(&ipAddr[0], udpPort))
+  {
+    return false;
+  }
+  udpServer.setSequencing(true);
+  udpClient.setSequencing(true);
+  pthread_create(&connectThrd, NULL, udpConnect, &udpServer);
+  udpClient.makeConnect();
+  pthread_join(connectThrd, NULL);
+  if (!udpServer.isConnected() || !udpClient.setBatching(SmplMsgConnection::MAX_BATCH_BYTES, 1000))
+  {
+    return false;
+  }
+  udpServer.setReceiveTimeout(100);
+
+  for (int i = 0; i < 2; i++)
+  {
+    bool queue = (1 == i);
+    StreamSenderArgs args = {&udpClient, NUM_MSGS, queue};
+    pthread_t senderThrd;
+    timeval start, end;
+    clock_t cpuStart, cpuEnd;
+    int received = 0;
+
+    udpClient.sends_ = udpServer.receives_ = 0;
+    udpServer.resetSequenceStats();
+    gettimeofday(&start, NULL);
+    end = start;
+    cpuStart = cpuEnd = clock();
+    pthread_create(&senderThrd, NULL, streamSender, &args);
+    while (udpServer.receiveMsg(msg))
+    {
+      gettimeofday(&end, NULL);
+      cpuEnd = clock();
+      received++;
+    }
+    pthread_join(senderThrd, NULL);
+
+    if (0 == received)
+    {
+      return false;
+    }
+    printf("UDP joint message stream (batched: %d, %d messages): %d received, %u lost, "
+           "%f sends, %f receives per datagram, %.0f datagrams/s, %.0f datagrams per CPU second\n",
+           queue, NUM_MSGS, received, udpServer.getNumLost(),
+           (double)udpClient.sends_ / NUM_MSGS, (double)udpServer.receives_ / received,
+           received / ((end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) * 1e-6),
+           received / ((double)(cpuEnd - cpuStart) / CLOCKS_PER_SEC));
+  }
+  return true;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+  bool rtn = decodeBenchmark() && dispatchBenchmark() && readaheadBenchmark() && batchingBenchmark();
+#ifdef LINUXSOCKETS
+  rtn = rtn && udpBenchmark();
+#endif
+
+  if (!rtn)
+  {
+    printf("Benchmark failed\n");
+  }
+  return rtn ? 0 : 1;
+}
@@ -42,6 +42,8 @@
 #include "simple_message/messages/joint_message.h"
 #include "simple_message/joint_data.h"
 #include "simple_message/message_manager.h"
+#include "simple_message/message_reactor.h"
+#include "simple_message/message_server.h"
 #include "simple_message/simple_comms_fault_handler.h"
 #include "simple_message/joint_traj_pt.h"
 #include "simple_message/messages/joint_traj_pt_message.h"
@@ -53,6 +55,7 @@
 // threads 
 //#include <boost/thread/thread.hpp>
 #include <pthread.h>
+#include <algorithm>
 
 using namespace industrial::simple_message;
 using namespace industrial::byte_array;
@@ -64,11 +67,15 @@ using namespace industrial::udp_server;
 using namespace industrial::tcp_socket;
 using namespace industrial::tcp_client;
 using namespace industrial::tcp_server;
+using namespace industrial::simple_socket;
 using namespace industrial::ping_message;
 using namespace industrial::ping_handler;
 using namespace industrial::joint_data;
 using namespace industrial::joint_message;
 using namespace industrial::message_manager;
+using namespace industrial::message_reactor;
+using namespace industrial::message_server;
+using namespace industrial::comms_fault_handler;
 using namespace industrial::simple_comms_fault_handler;
 using namespace industrial::joint_traj_pt;
 using namespace industrial::joint_traj_pt_message;
@@ -210,6 +217,49 @@ TEST(ByteArraySuite, byteSwapping)
 
 }
 
+TEST(ByteArraySuite, swapArray)
+{
+  unsigned char buffer[] = {
+      0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+      0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+  unsigned char words[] = {
+      0x03, 0x02, 0x01, 0x00, 0x07, 0x06, 0x05, 0x04,
+      0x0b, 0x0a, 0x09, 0x08, 0x0f, 0x0e, 0x0d, 0x0c };
+  unsigned char longs[] = {
+      0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01, 0x00,
+      0x0f, 0x0e, 0x0d, 0x0c, 0x0b, 0x0a, 0x09, 0x08 };
+  unsigned char halves[] = {
+      0x01, 0x00, 0x03, 0x02, 0x05, 0x04, 0x07, 0x06,
+      0x09, 0x08, 0x0b, 0x0a, 0x0d, 0x0c, 0x0f, 0x0e };
+  unsigned char values[sizeof(buffer)];
+  const shared_int SIZE = sizeof(buffer);
+
+  memcpy(values, buffer, SIZE);
+  ASSERT_TRUE(ByteArray::swapArray(values, SIZE, 4));
+  EXPECT_EQ(0, memcmp(values, words, SIZE));
+  ASSERT_TRUE(ByteArray::swapArray(values, SIZE, 4));
+  EXPECT_EQ(0, memcmp(values, buffer, SIZE));
+
+  ASSERT_TRUE(ByteArray::swapArray(values, SIZE, 8));
+  EXPECT_EQ(0, memcmp(values, longs, SIZE));
+  ASSERT_TRUE(ByteArray::swapArray(values, SIZE, 8));
+
+  ASSERT_TRUE(ByteArray::swapArray(values, SIZE, 2));
+  EXPECT_EQ(0, memcmp(values, halves, SIZE));
+  ASSERT_TRUE(ByteArray::swapArray(values, SIZE, 2));
+  EXPECT_EQ(0, memcmp(values, buffer, SIZE));
+
+  // Unaligned values
+  ASSERT_TRUE(ByteArray::swapArray(&values[1], 8, 4));
+  EXPECT_EQ(0, memcmp(&values[1], "\x04\x03\x02\x01\x08\x07\x06\x05", 8));
+
+  // Partial values are not swapped
+  memcpy(values, buffer, SIZE);
+  EXPECT_FALSE(ByteArray::swapArray(values, SIZE - 1, 4));
+  EXPECT_FALSE(ByteArray::swapArray(values, SIZE, 0));
+  EXPECT_EQ(0, memcmp(values, buffer, SIZE));
+}
+
 TEST(ByteArraySuite, copy)
 {
 
@@ -238,6 +288,90 @@ TEST(ByteArraySuite, copy)
   EXPECT_EQ((shared_int)copyTo.getBufferSize(), 2*SIZE);
 }
 
+TEST(ByteArraySuite, directLoad)
+{
+  ByteArray bytes;
+  shared_int iIN = 999, iOUT = 0;
+  char* loadPtr = NULL;
+
+  // Data written to the load pointer is not part of the array until the
+  // buffer size is extended.
+  ASSERT_TRUE(bytes.load(iIN));
+  loadPtr = bytes.getLoadPtr(sizeof(shared_int));
+  ASSERT_TRUE(NULL != loadPtr);
+  memcpy(loadPtr, bytes.getRawDataPtr(), sizeof(shared_int));
+  EXPECT_EQ(bytes.getBufferSize(), sizeof(shared_int));
+  ASSERT_TRUE(bytes.extendBufferSize(sizeof(shared_int)));
+  EXPECT_EQ(bytes.getBufferSize(), 2*sizeof(shared_int));
+  EXPECT_TRUE(bytes.unload(iOUT));
+  EXPECT_EQ(iOUT, iIN);
+
+  // Writing past the max size is not allowed
+  EXPECT_TRUE(NULL == bytes.getLoadPtr(bytes.getMaxBufferSize()));
+  EXPECT_FALSE(bytes.extendBufferSize(bytes.getMaxBufferSize()));
+
+  // Truncating keeps the start of the array
+  ASSERT_TRUE(bytes.load(iIN + 1));
+  EXPECT_FALSE(bytes.truncate(-1));
+  EXPECT_FALSE(bytes.truncate(bytes.getBufferSize() + 1));
+  ASSERT_TRUE(bytes.truncate(sizeof(shared_int)));
+  EXPECT_EQ(bytes.getBufferSize(), sizeof(shared_int));
+  EXPECT_TRUE(bytes.unload(iOUT));
+  EXPECT_EQ(iOUT, iIN);
+  ASSERT_TRUE(bytes.truncate(0));
+  EXPECT_EQ(0u, bytes.getBufferSize());
+}
+
+TEST(ByteArraySuite, largeBuffers)
+{
+  ByteArray bytes;
+  const shared_int NUM_INTS = bytes.getMaxBufferSize() / sizeof(shared_int);
+  shared_int value;
+
+  // Fill the array to the max size (one value at a time)
+  for (shared_int i = 0; i < NUM_INTS; i++)
+  {
+    ASSERT_TRUE(bytes.load(i));
+  }
+  EXPECT_EQ(bytes.getBufferSize(), bytes.getMaxBufferSize());
+  EXPECT_FALSE(bytes.load(value));
+
+  // Copies are deep and independent of the original
+  ByteArray copy(bytes);
+  ByteArray assigned;
+  assigned = copy;
+  ASSERT_EQ(copy.getBufferSize(), bytes.getBufferSize());
+  ASSERT_EQ(assigned.getBufferSize(), bytes.getBufferSize());
+  EXPECT_EQ(0, memcmp(copy.getRawDataPtr(), bytes.getRawDataPtr(), bytes.getBufferSize()));
+  EXPECT_EQ(0, memcmp(assigned.getRawDataPtr(), bytes.getRawDataPtr(), bytes.getBufferSize()));
+
+  bytes.init();
+  EXPECT_EQ(bytes.getBufferSize(), 0u);
+  for (shared_int i = NUM_INTS - 1; i >= 0; i--)
+  {
+    ASSERT_TRUE(copy.unload(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_EQ(assigned.getBufferSize(), assigned.getMaxBufferSize());
+
+  // Loading an array into itself
+  ByteArray self;
+  for (shared_int i = 0; i < 300; i++)
+  {
+    ASSERT_TRUE(self.load(i));
+  }
+  ASSERT_TRUE(self.load(self));
+  EXPECT_EQ(self.getBufferSize(), 600*sizeof(shared_int));
+  for (shared_int i = 0; i < 2; i++)
+  {
+    for (shared_int j = 299; j >= 0; j--)
+    {
+      ASSERT_TRUE(self.unload(value));
+      EXPECT_EQ(value, j);
+    }
+  }
+}
+
 // Need access to protected members for testing
 class TestTcpClient : public TcpClient
 {
@@ -341,6 +475,721 @@ TEST(SocketSuite, splitPackets)
   pthread_join(senderThrd, NULL);
 }
 
+TEST(SocketSuite, byteSwapping)
+{
+  const int tcpPort = TEST_PORT_BASE + 2;
+  char ipAddr[] = "127.0.0.1";
+
+  TestTcpClient tcpClient;
+  TestTcpServer tcpServer;
+  SimpleMessage send, recv;
+  ByteArray data, raw;
+  shared_int value;
+
+  // Runtime swapping is only supported for equal int/real sizes
+  bool supported = (sizeof(shared_int) == sizeof(shared_real));
+  EXPECT_FALSE(tcpClient.isByteSwapping());
+  ASSERT_EQ(supported, tcpClient.setByteSwapping(true));
+  if (!supported)
+  {
+    EXPECT_FALSE(tcpClient.isByteSwapping());
+    return;
+  }
+  EXPECT_TRUE(tcpClient.isByteSwapping());
+
+  ASSERT_TRUE(tcpServer.init(tcpPort));
+  ASSERT_TRUE(tcpClient.init(&ipAddr[0], tcpPort));
+  ASSERT_TRUE(tcpClient.makeConnect());
+  ASSERT_TRUE(tcpServer.makeConnect());
+
+  ASSERT_TRUE(data.load((shared_int)1234));
+  ASSERT_TRUE(send.init(StandardMsgTypes::PING, CommTypes::TOPIC, ReplyTypes::INVALID, data));
+
+  // Bytes on the wire are swapped
+  ASSERT_TRUE(tcpClient.sendMsg(send));
+  ASSERT_TRUE(tcpServer.receiveBytes(raw, send.getLengthSize() + send.getMsgLength()));
+  ASSERT_TRUE(ByteArray::swapArray(raw.getRawDataPtr(), raw.getBufferSize(), sizeof(shared_int)));
+  ASSERT_TRUE(raw.unload(value));
+  EXPECT_EQ(1234, value);
+  ASSERT_TRUE(raw.unload(value));
+  ASSERT_TRUE(raw.unload(value));
+  EXPECT_EQ(CommTypes::TOPIC, value);
+  ASSERT_TRUE(raw.unload(value));
+  EXPECT_EQ(StandardMsgTypes::PING, value);
+
+  // A swapping receiver restores the message
+  ASSERT_TRUE(tcpServer.setByteSwapping(true));
+  ASSERT_TRUE(tcpClient.sendMsg(send));
+  ASSERT_TRUE(tcpServer.receiveMsg(recv));
+  EXPECT_EQ(StandardMsgTypes::PING, recv.getMessageType());
+  EXPECT_EQ(CommTypes::TOPIC, recv.getCommType());
+  ASSERT_EQ(sizeof(shared_int), recv.getDataLength());
+  ASSERT_TRUE(recv.getData().unload(value));
+  EXPECT_EQ(1234, value);
+}
+
+
+TEST(SocketSuite, pollMethods)
+{
+  const int tcpPort = TEST_PORT_BASE + 6;
+  char ipAddr[] = "127.0.0.1";
+  const PollMethod METHODS[] = {PollMethods::SELECT, PollMethods::POLL, PollMethods::EPOLL};
+  const int TIMEOUT = 50;
+
+  for (int i = 0; i < 3; i++)
+  {
+    TestTcpClient tcpClient;
+    TestTcpServer tcpServer;
+    ByteArray send, recv;
+    shared_int DATA = 99;
+    unsigned int start;
+
+    ASSERT_TRUE(tcpServer.init(tcpPort + i));
+    ASSERT_TRUE(tcpClient.init(&ipAddr[0], tcpPort + i));
+    ASSERT_TRUE(tcpClient.makeConnect());
+    ASSERT_TRUE(tcpServer.makeConnect());
+
+    ASSERT_TRUE(tcpServer.setPollMethod(METHODS[i]));
+    EXPECT_EQ(METHODS[i], tcpServer.getPollMethod());
+    EXPECT_FALSE(tcpServer.isReadyReceive(10));
+
+    ASSERT_TRUE(send.load(DATA));
+    ASSERT_TRUE(tcpClient.sendBytes(send));
+    EXPECT_TRUE(tcpServer.isReadyReceive(1000));
+    ASSERT_TRUE(tcpServer.receiveBytes(recv, sizeof(shared_int)));
+
+    // A receive times out (with nothing received) without disconnecting
+    tcpServer.setReceiveTimeout(TIMEOUT);
+    start = TcpServer::getTimeMs();
+    EXPECT_FALSE(tcpServer.receiveBytes(recv, sizeof(shared_int)));
+    EXPECT_LE(TIMEOUT, (int)(TcpServer::getTimeMs() - start));
+    EXPECT_TRUE(tcpServer.isConnected());
+
+    // A partial receive times out and disconnects
+    ASSERT_TRUE(tcpClient.sendBytes(send));
+    EXPECT_FALSE(tcpServer.receiveBytes(recv, 2 * sizeof(shared_int)));
+    EXPECT_FALSE(tcpServer.isConnected());
+  }
+}
+
+struct DelayedSenderArgs
+{
+  TestTcpClient* client;
+  ByteArray parts[2];
+  int delay;  // (ms) before each part
+};
+
+// Utility for sending a message in parts, with a delay before each part
+void*
+delayedSender(void* arg)
+{
+  DelayedSenderArgs* args = (DelayedSenderArgs*)arg;
+
+  for (int i = 0; i < 2; i++)
+  {
+    SmplMsgConnection::sleepMs(args->delay);
+    args->client->sendBytes(args->parts[i]);
+  }
+  return NULL;
+}
+
+TEST(SocketSuite, receiveTimeout)
+{
+  const int tcpPort = TEST_PORT_BASE + 19;
+  char ipAddr[] = "127.0.0.1";
+  const int TIMEOUT = 300;
+  const int DELAY = 200;
+  TestTcpClient tcpClient, tcpClient2;
+  TcpServer tcpServer, tcpServer2;
+  SimpleMessage msg;
+  ByteArray prefix, header, data, message;
+  DelayedSenderArgs args;
+  pthread_t senderThrd;
+
+  // PING message with 8 data bytes: length prefix, header and data
+  ASSERT_TRUE(prefix.load((shared_int)(SimpleMessage::getHeaderSize() + 2 * sizeof(shared_int))));
+  ASSERT_TRUE(header.load((shared_int)StandardMsgTypes::PING));
+  ASSERT_TRUE(header.load((shared_int)CommTypes::TOPIC));
+  ASSERT_TRUE(header.load((shared_int)ReplyTypes::INVALID));
+  ASSERT_TRUE(data.load((shared_int)1));
+  ASSERT_TRUE(data.load((shared_int)2));
+  message.copyFrom(prefix);
+  ASSERT_TRUE(message.load(header));
+
+  ASSERT_TRUE(tcpServer.init(tcpPort));
+  ASSERT_TRUE(tcpClient.init(&ipAddr[0], tcpPort));
+  ASSERT_TRUE(tcpClient.makeConnect());
+  ASSERT_TRUE(tcpServer.makeConnect());
+  tcpServer.setReceiveTimeout(TIMEOUT);
+
+  // A receive times out (with nothing received) without disconnecting
+  EXPECT_FALSE(tcpServer.receiveMsg(msg));
+  EXPECT_TRUE(tcpServer.isConnected());
+
+  // A complete message is received
+  ASSERT_TRUE(tcpClient.sendBytes(message));
+  ASSERT_TRUE(tcpClient.sendBytes(data));
+  ASSERT_TRUE(tcpServer.receiveMsg(msg));
+  EXPECT_EQ(StandardMsgTypes::PING, msg.getMessageType());
+  EXPECT_EQ(2 * (int)sizeof(shared_int), msg.getDataLength());
+
+  // A message without its data times out and disconnects (the data would
+  // otherwise be received as the next header)
+  ASSERT_TRUE(tcpClient.sendBytes(message));
+  EXPECT_FALSE(tcpServer.receiveMsg(msg));
+  EXPECT_FALSE(tcpServer.isConnected());
+
+  // The timeout applies to the whole message, not to each of its parts (the
+  // header and data each arrive within the timeout, the message does not)
+  ASSERT_TRUE(tcpServer2.init(tcpPort + 1));
+  ASSERT_TRUE(tcpClient2.init(&ipAddr[0], tcpPort + 1));
+  ASSERT_TRUE(tcpClient2.makeConnect());
+  ASSERT_TRUE(tcpServer2.makeConnect());
+  tcpServer2.setReceiveTimeout(TIMEOUT);
+
+  args.client = &tcpClient2;
+  args.parts[0].copyFrom(message);
+  args.parts[1].copyFrom(data);
+  args.delay = DELAY;
+  pthread_create(&senderThrd, NULL, delayedSender, &args);
+  EXPECT_FALSE(tcpServer2.receiveMsg(msg));
+  EXPECT_FALSE(tcpServer2.isConnected());
+  pthread_join(senderThrd, NULL);
+}
+
+// Counts socket reads
+class ReadCountTcpServer : public TcpServer
+{
+  public:
+  ReadCountTcpServer() : reads_(0) {};
+  int rawReceiveBytes(char *buffer, shared_int num_bytes)
+  {
+    this->reads_++;
+    return RECV(this->getSockHandle(), buffer, num_bytes, 0);
+  }
+  int reads_;
+};
+
+struct StreamSenderArgs
+{
+  SmplMsgConnection* client;
+  int num_msgs;
+  bool queue;  // queue (batch) messages, see SmplMsgConnection::queueMsg
+};
+
+// Utility for sending a stream of joint messages (as fast as possible)
+void*
+streamSender(void* arg)
+{
+  StreamSenderArgs* args = (StreamSenderArgs*)arg;
+  JointData joints;
+  JointMessage jMsg;
+  SimpleMessage msg;
+
+  for (int i = 0; i < args->num_msgs; i++)
+  {
+    jMsg.init(i, joints);
+    jMsg.toTopic(msg);
+    if (!(args->queue ? args->client->queueMsg(msg) : args->client->sendMsg(msg)))
+    {
+      break;
+    }
+  }
+  args->client->flush();
+  return NULL;
+}
+
+TEST(SocketSuite, readahead)
+{
+  const int tcpPort = TEST_PORT_BASE + 9;
+  char ipAddr[] = "127.0.0.1";
+  const int NUM_MSGS = 10000;
+  int reads[2];
+
+  for (int i = 0; i < 2; i++)
+  {
+    bool readahead = (1 == i);
+    TcpClient tcpClient;
+    ReadCountTcpServer tcpServer;
+    SimpleMessage msg;
+    JointMessage jMsg;
+    StreamSenderArgs args = {&tcpClient, NUM_MSGS, false};
+    pthread_t senderThrd;
+    int received = 0;
+
+    ASSERT_TRUE(tcpServer.init(tcpPort + i));
+    ASSERT_TRUE(tcpClient.init(&ipAddr[0], tcpPort + i));
+    ASSERT_TRUE(tcpClient.makeConnect());
+    ASSERT_TRUE(tcpServer.makeConnect());
+    tcpServer.setReadahead(readahead);
+
+    pthread_create(&senderThrd, NULL, streamSender, &args);
+    for (received = 0; received < NUM_MSGS; received++)
+    {
+      if (!tcpServer.receiveMsg(msg) || !jMsg.init(msg) || received != jMsg.getSequence())
+      {
+        break;
+      }
+    }
+    pthread_join(senderThrd, NULL);
+
+    EXPECT_EQ(NUM_MSGS, received);
+    EXPECT_FALSE(tcpServer.isMsgBuffered());
+    reads[i] = tcpServer.reads_;
+  }
+
+  // Without readahead, the length/header and the data are read separately
+  EXPECT_LE(2 * NUM_MSGS, reads[0]);
+  EXPECT_GT(reads[0], reads[1]);
+}
+
+// Counts (non-vectored) socket writes
+class SendCountTcpClient : public TcpClient
+{
+  public:
+  SendCountTcpClient() : sends_(0) {};
+  int sends_;
+  protected:
+  bool sendBytes(ByteArray & buffer)
+  {
+    this->sends_++;
+    return TcpClient::sendBytes(buffer);
+  }
+};
+
+TEST(SocketSuite, batching)
+{
+  const int tcpPort = TEST_PORT_BASE + 12;
+  char ipAddr[] = "127.0.0.1";
+  const int NUM_MSGS = 10000;
+
+  SendCountTcpClient tcpClient;
+  TcpServer tcpServer;
+  UdpClient udpClient;
+  SimpleMessage msg;
+  JointData joints;
+  JointMessage jMsg;
+  StreamSenderArgs args = {&tcpClient, NUM_MSGS, true};
+  pthread_t senderThrd;
+  int received = 0;
+
+  ASSERT_TRUE(tcpServer.init(tcpPort));
+  ASSERT_TRUE(tcpClient.init(&ipAddr[0], tcpPort));
+  ASSERT_TRUE(tcpClient.makeConnect());
+  ASSERT_TRUE(tcpServer.makeConnect());
+
+  EXPECT_FALSE(tcpClient.isBatching());
+  EXPECT_FALSE(tcpClient.setBatching(-1, 0));
+  EXPECT_FALSE(tcpClient.setBatching(SmplMsgConnection::MAX_BATCH_BYTES + 1, 0));
+  EXPECT_FALSE(tcpClient.setBatching(1024, -1));
+  EXPECT_TRUE(udpClient.setBatching(1024, 0));
+  EXPECT_TRUE(udpClient.setBatching(0, 0));
+
+  // Queued messages are coalesced into (far) fewer writes, in order
+  ASSERT_TRUE(tcpClient.setBatching(SmplMsgConnection::MAX_BATCH_BYTES, 1000));
+  EXPECT_TRUE(tcpClient.isBatching());
+  pthread_create(&senderThrd, NULL, streamSender, &args);
+  for (received = 0; received < NUM_MSGS; received++)
+  {
+    if (!tcpServer.receiveMsg(msg) || !jMsg.init(msg) || received != jMsg.getSequence())
+    {
+      break;
+    }
+  }
+  pthread_join(senderThrd, NULL);
+  EXPECT_EQ(NUM_MSGS, received);
+  EXPECT_LT(0, tcpClient.sends_);
+  EXPECT_GT(NUM_MSGS / 50, tcpClient.sends_);
+
+  // Messages sent directly do not overtake queued messages
+  jMsg.init(1, joints);
+  ASSERT_TRUE(jMsg.toTopic(msg));
+  ASSERT_TRUE(tcpClient.queueMsg(msg));
+  jMsg.init(2, joints);
+  ASSERT_TRUE(jMsg.toTopic(msg));
+  ASSERT_TRUE(tcpClient.sendMsg(msg));
+  for (int i = 1; i <= 2; i++)
+  {
+    ASSERT_TRUE(tcpServer.receiveMsg(msg));
+    ASSERT_TRUE(jMsg.init(msg));
+    EXPECT_EQ(i, jMsg.getSequence());
+  }
+
+  // The delay bound flushes the batch when the next message is queued
+  ASSERT_TRUE(tcpClient.setBatching(SmplMsgConnection::MAX_BATCH_BYTES, 0));
+  jMsg.init(3, joints);
+  ASSERT_TRUE(jMsg.toTopic(msg));
+  ASSERT_TRUE(tcpClient.queueMsg(msg));
+  ASSERT_TRUE(tcpServer.receiveMsg(msg));
+  ASSERT_TRUE(jMsg.init(msg));
+  EXPECT_EQ(3, jMsg.getSequence());
+
+  // A queued message is only flushed by flushIfDue once it is due
+  ASSERT_TRUE(tcpClient.setBatching(SmplMsgConnection::MAX_BATCH_BYTES, 50));
+  EXPECT_EQ(-1, tcpClient.getFlushTimeout());
+  jMsg.init(4, joints);
+  ASSERT_TRUE(jMsg.toTopic(msg));
+  ASSERT_TRUE(tcpClient.queueMsg(msg));
+  EXPECT_LT(0, tcpClient.getFlushTimeout());
+  EXPECT_GE(50, tcpClient.getFlushTimeout());
+  ASSERT_TRUE(tcpClient.flushIfDue());
+  EXPECT_LT(0, tcpClient.getFlushTimeout());
+  SmplMsgConnection::sleepMs(100);
+  EXPECT_EQ(0, tcpClient.getFlushTimeout());
+  ASSERT_TRUE(tcpClient.flushIfDue());
+  EXPECT_EQ(-1, tcpClient.getFlushTimeout());
+  ASSERT_TRUE(tcpServer.receiveMsg(msg));
+  ASSERT_TRUE(jMsg.init(msg));
+  EXPECT_EQ(4, jMsg.getSequence());
+
+  // Without batching, queued messages are sent immediately
+  ASSERT_TRUE(tcpClient.setBatching(0, 0));
+  EXPECT_FALSE(tcpClient.isBatching());
+  jMsg.init(5, joints);
+  ASSERT_TRUE(jMsg.toTopic(msg));
+  ASSERT_TRUE(tcpClient.queueMsg(msg));
+  ASSERT_TRUE(tcpServer.receiveMsg(msg));
+  ASSERT_TRUE(jMsg.init(msg));
+  EXPECT_EQ(5, jMsg.getSequence());
+}
+
+// Utility for running a udp server connect (waits for the client handshake)
+void*
+udpConnect(void* arg)
+{
+  UdpServer* server = (UdpServer*)arg;
+  server->makeConnect();
+  return NULL;
+}
+
+TEST(SocketSuite, udpMessages)
+{
+  const int udpPort = TEST_PORT_BASE + 11;
+  char ipAddr[] = "127.0.0.1";
+
+  UdpClient udpClient;
+  UdpServer udpServer;
+  SimpleMessage send, recv;
+  JointData joints;
+  JointMessage jMsg;
+  pthread_t connectThrd;
+
+  ASSERT_TRUE(udpServer.init(udpPort));
+  ASSERT_TRUE(udpClient.init(&ipAddr[0], udpPort));
+  pthread_create(&connectThrd, NULL, udpConnect, &udpServer);
+  ASSERT_TRUE(udpClient.makeConnect());
+  pthread_join(connectThrd, NULL);
+  ASSERT_TRUE(udpServer.isConnected());
+
+  // The length, header and data are sent as a single datagram
+  for (int i = 0; i < joints.getMaxNumJoints(); i++)
+  {
+    ASSERT_TRUE(joints.setJoint(i, i + 1));
+  }
+  jMsg.init(1, joints);
+  ASSERT_TRUE(jMsg.toTopic(send));
+  ASSERT_TRUE(udpClient.sendMsg(send));
+  ASSERT_TRUE(udpServer.receiveMsg(recv));
+  EXPECT_EQ(StandardMsgTypes::JOINT, recv.getMessageType());
+  EXPECT_EQ(CommTypes::TOPIC, recv.getCommType());
+  ASSERT_EQ(send.getDataLength(), recv.getDataLength());
+  ASSERT_TRUE(jMsg.init(recv));
+  EXPECT_EQ(1, jMsg.getSequence());
+  EXPECT_TRUE(joints == jMsg.getJoints());
+
+  // Messages without data (and replies to the client)
+  ASSERT_TRUE(send.init(StandardMsgTypes::PING, CommTypes::SERVICE_REPLY, ReplyTypes::SUCCESS));
+  ASSERT_TRUE(udpServer.sendMsg(send));
+  ASSERT_TRUE(udpClient.receiveMsg(recv));
+  EXPECT_EQ(StandardMsgTypes::PING, recv.getMessageType());
+  EXPECT_EQ(ReplyTypes::SUCCESS, recv.getReplyCode());
+  EXPECT_EQ(0, recv.getDataLength());
+}
+
+// Utility udp client that allows sequence numbers to be skipped/repeated
+class SequenceUdpClient : public UdpClient
+{
+  public:
+  void setSendSequence(shared_int seq)
+  {
+    this->send_seq_ = seq;
+  }
+  // Sends a (well formed) message with an invalid comm type
+  bool sendInvalidMsg()
+  {
+    ByteArray buffer;
+    return buffer.load((shared_int)SimpleMessage::getHeaderSize()) && buffer.load((shared_int)StandardMsgTypes::PING)
+        && buffer.load((shared_int)CommTypes::INVALID) && buffer.load((shared_int)ReplyTypes::INVALID)
+        && this->sendBytes(buffer);
+  }
+};
+
+// Utility for sending a joint message (the joint message sequence identifies
+// the message)
+bool sendJointMsg(SmplMsgConnection & connection, shared_int sequence)
+{
+  JointData joints;
+  JointMessage jMsg;
+  SimpleMessage msg;
+
+  jMsg.init(sequence, joints);
+  return jMsg.toTopic(msg) && connection.sendMsg(msg);
+}
+
+TEST(SocketSuite, udpSequencing)
+{
+  const int udpPort = TEST_PORT_BASE + 16;
+  const int noServerPort = TEST_PORT_BASE + 17;
+  char ipAddr[] = "127.0.0.1";
+
+  SequenceUdpClient udpClient;
+  UdpClient noServerClient;
+  UdpServer udpServer;
+  SimpleMessage recv;
+  JointMessage jMsg;
+  pthread_t connectThrd;
+  unsigned int start;
+
+  // The handshake gives up after the connect timeout
+  ASSERT_TRUE(udpServer.init(udpPort));
+  udpServer.setConnectTimeout(100);
+  start = UdpServer::getTimeMs();
+  EXPECT_FALSE(udpServer.makeConnect());
+  EXPECT_LE(100, (int)(UdpServer::getTimeMs() - start));
+  EXPECT_FALSE(udpServer.isConnected());
+  ASSERT_TRUE(noServerClient.init(&ipAddr[0], noServerPort));
+  noServerClient.setConnectTimeout(100);
+  EXPECT_FALSE(noServerClient.makeConnect());
+  EXPECT_FALSE(noServerClient.isConnected());
+
+  udpServer.setConnectTimeout(-1);
+  udpServer.setSequencing(true);
+  udpClient.setSequencing(true);
+  ASSERT_TRUE(udpClient.init(&ipAddr[0], udpPort));
+  pthread_create(&connectThrd, NULL, udpConnect, &udpServer);
+  ASSERT_TRUE(udpClient.makeConnect());
+  pthread_join(connectThrd, NULL);
+  ASSERT_TRUE(udpServer.isConnected());
+
+  // In sequence
+  for (int i = 0; i < 2; i++)
+  {
+    ASSERT_TRUE(sendJointMsg(udpClient, i));
+    ASSERT_TRUE(udpServer.receiveMsg(recv));
+    ASSERT_TRUE(jMsg.init(recv));
+    EXPECT_EQ(i, jMsg.getSequence());
+  }
+  EXPECT_EQ(0u, udpServer.getNumLost());
+
+  // Gaps are counted as lost
+  udpClient.setSendSequence(5);
+  ASSERT_TRUE(sendJointMsg(udpClient, 5));
+  ASSERT_TRUE(udpServer.receiveMsg(recv));
+  ASSERT_TRUE(jMsg.init(recv));
+  EXPECT_EQ(5, jMsg.getSequence());
+  EXPECT_EQ(3u, udpServer.getNumLost());
+
+  // Duplicated/reordered datagrams are discarded
+  udpClient.setSendSequence(3);
+  ASSERT_TRUE(sendJointMsg(udpClient, 3));
+  udpClient.setSendSequence(5);
+  ASSERT_TRUE(sendJointMsg(udpClient, 5));
+  ASSERT_TRUE(sendJointMsg(udpClient, 6));
+  ASSERT_TRUE(udpServer.receiveMsg(recv));
+  ASSERT_TRUE(jMsg.init(recv));
+  EXPECT_EQ(6, jMsg.getSequence());
+  EXPECT_EQ(2u, udpServer.getNumStale());
+  EXPECT_EQ(3u, udpServer.getNumLost());
+
+  // Only stale datagrams, the receive times out
+  udpServer.setReceiveTimeout(100);
+  udpClient.setSendSequence(6);
+  ASSERT_TRUE(sendJointMsg(udpClient, 6));
+  EXPECT_FALSE(udpServer.receiveMsg(recv));
+  EXPECT_EQ(3u, udpServer.getNumStale());
+  EXPECT_TRUE(udpServer.isConnected());
+
+  // Latest only, older waiting messages are skipped
+  udpServer.setLatestOnly(true);
+  for (int i = 7; i < 10; i++)
+  {
+    ASSERT_TRUE(sendJointMsg(udpClient, i));
+  }
+  ASSERT_TRUE(udpServer.receiveMsg(recv));
+  ASSERT_TRUE(jMsg.init(recv));
+  EXPECT_EQ(9, jMsg.getSequence());
+  EXPECT_EQ(2u, udpServer.getNumSkipped());
+  EXPECT_EQ(3u, udpServer.getNumLost());
+
+  // Latest only, newer invalid datagrams are skipped (the latest valid
+  // message is received)
+  ASSERT_TRUE(sendJointMsg(udpClient, 10));
+  ASSERT_TRUE(sendJointMsg(udpClient, 11));
+  ASSERT_TRUE(udpClient.sendInvalidMsg());
+  ASSERT_TRUE(udpServer.receiveMsg(recv));
+  ASSERT_TRUE(jMsg.init(recv));
+  EXPECT_EQ(11, jMsg.getSequence());
+  EXPECT_EQ(3u, udpServer.getNumSkipped());
+  EXPECT_EQ(3u, udpServer.getNumLost());
+  EXPECT_TRUE(udpServer.isConnected());
+
+  // A large jump back is a restart of the sender
+  udpClient.setSendSequence(-5000);
+  ASSERT_TRUE(sendJointMsg(udpClient, 10));
+  ASSERT_TRUE(udpServer.receiveMsg(recv));
+  ASSERT_TRUE(jMsg.init(recv));
+  EXPECT_EQ(10, jMsg.getSequence());
+  EXPECT_EQ(3u, udpServer.getNumLost());
+
+  udpServer.resetSequenceStats();
+  EXPECT_EQ(0u, udpServer.getNumLost());
+  EXPECT_EQ(0u, udpServer.getNumStale());
+  EXPECT_EQ(0u, udpServer.getNumSkipped());
+}
+
+// Counts batched udp socket sends
+class SendCountUdpClient : public UdpClient
+{
+  public:
+  SendCountUdpClient() : sends_(0) {};
+  int sends_;
+  protected:
+  int rawSendBatch(mmsghdr *msgs, int count)
+  {
+    this->sends_++;
+    return UdpClient::rawSendBatch(msgs, count);
+  }
+};
+
+// Counts batched udp socket receives
+class ReceiveCountUdpServer : public UdpServer
+{
+  public:
+  ReceiveCountUdpServer() : receives_(0) {};
+  int receives_;
+  protected:
+  int rawReceiveBatch(mmsghdr *msgs, int count)
+  {
+    this->receives_++;
+    return UdpServer::rawReceiveBatch(msgs, count);
+  }
+};
+
+TEST(SocketSuite, udpBatching)
+{
+  const int udpPort = TEST_PORT_BASE + 18;
+  char ipAddr[] = "127.0.0.1";
+  const int NUM_MSGS = 64;
+
+  SendCountUdpClient udpClient;
+  ReceiveCountUdpServer udpServer;
+  SimpleMessage msg;
+  JointData joints;
+  JointMessage jMsg;
+  pthread_t connectThrd;
+
+  ASSERT_TRUE(udpServer.init(udpPort));
+  ASSERT_TRUE(udpClient.init(&ipAddr[0], udpPort));
+  udpServer.setSequencing(true);
+  udpClient.setSequencing(true);
+  pthread_create(&connectThrd, NULL, udpConnect, &udpServer);
+  ASSERT_TRUE(udpClient.makeConnect());
+  pthread_join(connectThrd, NULL);
+  ASSERT_TRUE(udpServer.isConnected());
+
+  // A flushed batch is sent as datagrams (one message each), several per
+  // socket call
+  ASSERT_TRUE(udpClient.setBatching(SmplMsgConnection::MAX_BATCH_BYTES, 1000));
+  for (int i = 0; i < NUM_MSGS; i++)
+  {
+    jMsg.init(i, joints);
+    ASSERT_TRUE(jMsg.toTopic(msg));
+    ASSERT_TRUE(udpClient.queueMsg(msg));
+  }
+  ASSERT_TRUE(udpClient.flush());
+  EXPECT_LT(0, udpClient.sends_);
+  EXPECT_GT(NUM_MSGS / 4, udpClient.sends_);
+
+  // Waiting datagrams are received several per socket call, and then
+  // received (in order) from the batch
+  for (int i = 0; i < NUM_MSGS; i++)
+  {
+    ASSERT_TRUE(udpServer.receiveMsg(msg));
+    ASSERT_TRUE(jMsg.init(msg));
+    EXPECT_EQ(i, jMsg.getSequence());
+  }
+  EXPECT_FALSE(udpServer.isMsgBuffered());
+  EXPECT_LT(0, udpServer.receives_);
+  EXPECT_GT(NUM_MSGS / 4, udpServer.receives_);
+  EXPECT_EQ(0u, udpServer.getNumLost());
+
+  // Runtime byte swapping (where supported), queued and direct sends
+  if (udpClient.setByteSwapping(true) && udpServer.setByteSwapping(true))
+  {
+    jMsg.init(NUM_MSGS, joints);
+    ASSERT_TRUE(jMsg.toTopic(msg));
+    ASSERT_TRUE(udpClient.queueMsg(msg));
+    jMsg.init(NUM_MSGS + 1, joints);
+    ASSERT_TRUE(jMsg.toTopic(msg));
+    ASSERT_TRUE(udpClient.sendMsg(msg));
+    for (int i = NUM_MSGS; i < NUM_MSGS + 2; i++)
+    {
+      ASSERT_TRUE(udpServer.receiveMsg(msg));
+      ASSERT_TRUE(jMsg.init(msg));
+      EXPECT_EQ(i, jMsg.getSequence());
+    }
+    EXPECT_EQ(0u, udpServer.getNumLost());
+    ASSERT_TRUE(udpClient.setByteSwapping(false));
+    ASSERT_TRUE(udpServer.setByteSwapping(false));
+  }
+}
+
+TEST(SocketSuite, connectBackoff)
+{
+  const int tcpPort = TEST_PORT_BASE + 13;
+  char ipAddr[] = "127.0.0.1";
+  const int BACKOFF_MAX = 80;
+
+  TcpClient tcpClient;
+  TcpServer tcpServer;
+  SimpleMessage msg, recv;
+  unsigned int start;
+  int elapsed;
+
+  ASSERT_TRUE(tcpClient.init(&ipAddr[0], tcpPort));
+  EXPECT_FALSE(tcpClient.setConnectBackoff(-1, BACKOFF_MAX));
+  EXPECT_FALSE(tcpClient.setConnectBackoff(BACKOFF_MAX + 1, BACKOFF_MAX));
+  ASSERT_TRUE(tcpClient.setConnectBackoff(10, BACKOFF_MAX));
+
+  // No server, attempts fail (and are retried) until the timeout
+  EXPECT_FALSE(tcpClient.makeConnect());
+  EXPECT_FALSE(tcpClient.pollConnect(0));
+  start = TcpClient::getTimeMs();
+  EXPECT_FALSE(tcpClient.pollConnect(200));
+  elapsed = (int)(TcpClient::getTimeMs() - start);
+  EXPECT_LE(150, elapsed);
+  EXPECT_GT(1000, elapsed);
+  EXPECT_FALSE(tcpClient.isConnected());
+
+  // Once the server is listening, the client connects (with a new socket)
+  // within the maximum backoff delay
+  ASSERT_TRUE(tcpServer.init(tcpPort));
+  start = TcpClient::getTimeMs();
+  ASSERT_TRUE(tcpClient.pollConnect(2000));
+  elapsed = (int)(TcpClient::getTimeMs() - start);
+  EXPECT_GT(BACKOFF_MAX + 200, elapsed);
+  EXPECT_FALSE(tcpClient.isConnecting());
+  ASSERT_TRUE(tcpServer.makeConnect());
+
+  ASSERT_TRUE(msg.init(StandardMsgTypes::PING, CommTypes::SERVICE_REQUEST, ReplyTypes::INVALID));
+  ASSERT_TRUE(tcpClient.sendMsg(msg));
+  ASSERT_TRUE(tcpServer.receiveMsg(recv));
+  EXPECT_EQ(StandardMsgTypes::PING, recv.getMessageType());
+
+  // Connected clients don't reconnect
+  EXPECT_TRUE(tcpClient.pollConnect(0));
+  EXPECT_FALSE(tcpClient.makeConnect());
+}
 
 TEST(SimpleMessageSuite, init)
 {
@@ -359,6 +1208,17 @@ TEST(SimpleMessageSuite, init)
   // Service request with a reply
   EXPECT_FALSE(msg.init(StandardMsgTypes::PING, CommTypes::SERVICE_REQUEST,ReplyTypes::SUCCESS, bytes));
   EXPECT_FALSE(msg.init(StandardMsgTypes::PING, CommTypes::SERVICE_REQUEST,ReplyTypes::FAILURE, bytes));
+
+  // Reused messages don't keep old data
+  ASSERT_TRUE(bytes.load((shared_int)1));
+  EXPECT_TRUE(msg.init(StandardMsgTypes::PING, CommTypes::TOPIC, ReplyTypes::INVALID, bytes));
+  EXPECT_EQ(sizeof(shared_int), msg.getDataLength());
+  EXPECT_TRUE(msg.init(StandardMsgTypes::PING, CommTypes::TOPIC, ReplyTypes::INVALID));
+  EXPECT_EQ(0, msg.getDataLength());
+  EXPECT_TRUE(msg.init(StandardMsgTypes::PING, CommTypes::TOPIC, ReplyTypes::INVALID, bytes));
+  bytes.init();
+  EXPECT_TRUE(msg.init(StandardMsgTypes::PING, CommTypes::TOPIC, ReplyTypes::INVALID, bytes));
+  EXPECT_EQ(0, msg.getDataLength());
 }
 
 TEST(PingMessageSuite, init)
@@ -433,6 +1293,473 @@ TEST(MessageManagerSuite, addHandler)
 
   ASSERT_TRUE(handler.init(&udp));
   EXPECT_FALSE(manager.add(&handler));
+  EXPECT_TRUE(manager.add(&handler, true));
+  EXPECT_EQ(1, (int)manager.getNumHandlers());
+}
+
+// Counts the messages it receives
+class CountHandler : public industrial::message_handler::MessageHandler
+{
+  public:
+  CountHandler() : count_(0) {};
+  bool init(int msg_type, SmplMsgConnection* connection)
+  {
+    return MessageHandler::init(msg_type, connection);
+  }
+  bool internalCB(SimpleMessage & in)
+  {
+    this->count_++;
+    return true;
+  }
+  int count_;
+};
+
+// "Receives" messages of a pre-defined type (without any socket I/O)
+class LoopbackConnection : public SmplMsgConnection
+{
+  public:
+  LoopbackConnection() : msg_type_(StandardMsgTypes::INVALID) {};
+  bool receiveMsg(SimpleMessage & message)
+  {
+    return message.init(this->msg_type_, CommTypes::TOPIC, ReplyTypes::INVALID);
+  }
+  bool sendMsg(SimpleMessage & message) { return true; }
+  bool isConnected() { return true; }
+  bool makeConnect() { return true; }
+  int msg_type_;
+  protected:
+  bool sendBytes(ByteArray & buffer) { return true; }
+  bool receiveBytes(ByteArray & buffer, shared_int num_bytes) { return false; }
+};
+
+TEST(MessageManagerSuite, dispatch)
+{
+  const int MAX_HANDLERS = 200;
+  const int ITERATIONS = 1000;
+  MessageManager manager;
+  LoopbackConnection connection;
+  CountHandler handlers[MAX_HANDLERS];
+
+  ASSERT_TRUE(manager.init(&connection));
+
+  // Limited by the max number of handlers (FIXED_SIZE_BUFFERS), less the ping handler
+  const int NUM_HANDLERS = std::min(MAX_HANDLERS, (int)manager.getMaxNumHandlers() - 1);
+
+  // Sparse (vendor specific) message types, more than 64 handlers if supported
+  for (int i = 0; i < NUM_HANDLERS; i++)
+  {
+    int type = (i % 2) ? StandardMsgTypes::SWRI_MSG_BEGIN + 7 * i : StandardMsgTypes::MOTOMAN_MSG_BEGIN + i;
+    ASSERT_TRUE(handlers[i].init(type, &connection));
+    ASSERT_TRUE(manager.add(&handlers[i]));
+  }
+  EXPECT_EQ(NUM_HANDLERS + 1, (int)manager.getNumHandlers());
+
+  for (int i = 0; i < NUM_HANDLERS; i++)
+  {
+    connection.msg_type_ = handlers[i].getMsgType();
+    manager.spinOnce();
+    ASSERT_EQ(1, handlers[i].count_);
+  }
+
+  // Unhandled message types are not dispatched
+  connection.msg_type_ = StandardMsgTypes::SWRI_MSG_BEGIN + 1;
+  manager.spinOnce();
+  for (int i = 0; i < NUM_HANDLERS; i++)
+  {
+    ASSERT_EQ(1, handlers[i].count_);
+  }
+
+  // Repeated messages are dispatched (only) to the same handler (see
+  // test/benchmark.cpp for the dispatch cost)
+  connection.msg_type_ = handlers[NUM_HANDLERS - 1].getMsgType();
+  for (int i = 0; i < ITERATIONS; i++)
+  {
+    manager.spinOnce();
+  }
+  EXPECT_EQ(ITERATIONS + 1, handlers[NUM_HANDLERS - 1].count_);
+  EXPECT_EQ(1, handlers[0].count_);
+}
+
+// Counts communication faults (without reconnecting)
+class CountFaultHandler : public CommsFaultHandler
+{
+  public:
+  CountFaultHandler() : send_fail_(0), receive_fail_(0), connection_fail_(0) {};
+  void sendFailCB() { this->send_fail_++; }
+  void receiveFailCB() { this->receive_fail_++; }
+  void connectionFailCB() { this->connection_fail_++; }
+  int send_fail_;
+  int receive_fail_;
+  int connection_fail_;
+};
+
+TEST(MessageReactorSuite, multiplex)
+{
+  const int NUM_CONNECTIONS = 3;
+  const int tcpPort = TEST_PORT_BASE + 3;
+  char ipAddr[] = "127.0.0.1";
+
+  TcpClient* clients[NUM_CONNECTIONS];
+  TcpServer servers[NUM_CONNECTIONS];
+  MessageManager managers[NUM_CONNECTIONS];
+  CountHandler handlers[NUM_CONNECTIONS];
+  CountFaultHandler faults[NUM_CONNECTIONS];
+  MessageReactor reactor;
+  SimpleMessage msg, pingRequest, pingReply;
+  int count = 0;
+
+  ASSERT_TRUE(reactor.init());
+  for (int i = 0; i < NUM_CONNECTIONS; i++)
+  {
+    clients[i] = new TcpClient();
+    ASSERT_TRUE(servers[i].init(tcpPort + i));
+    ASSERT_TRUE(clients[i]->init(&ipAddr[0], tcpPort + i));
+    ASSERT_TRUE(clients[i]->makeConnect());
+    ASSERT_TRUE(servers[i].makeConnect());
+
+    ASSERT_TRUE(managers[i].init(&servers[i], &faults[i]));
+    ASSERT_TRUE(handlers[i].init(StandardMsgTypes::SWRI_MSG_BEGIN, &servers[i]));
+    ASSERT_TRUE(managers[i].add(&handlers[i]));
+    ASSERT_TRUE(reactor.add(&managers[i]));
+  }
+  EXPECT_EQ(NUM_CONNECTIONS, (int)reactor.getNumManagers());
+  EXPECT_FALSE(reactor.add(&managers[0]));
+  EXPECT_FALSE(reactor.add(NULL));
+
+  // Nothing to receive
+  EXPECT_EQ(0, reactor.spinOnce(10));
+
+  // Messages are dispatched to the handlers of the receiving connection
+  ASSERT_TRUE(msg.init(StandardMsgTypes::SWRI_MSG_BEGIN, CommTypes::TOPIC, ReplyTypes::INVALID));
+  for (int i = 0; i < NUM_CONNECTIONS; i++)
+  {
+    for (int j = 0; j <= i; j++)
+    {
+      ASSERT_TRUE(clients[i]->sendMsg(msg));
+    }
+  }
+  for (int i = 0; i < 100 && count < 6; i++)
+  {
+    count += reactor.spinOnce(100);
+  }
+  EXPECT_EQ(6, count);
+  for (int i = 0; i < NUM_CONNECTIONS; i++)
+  {
+    EXPECT_EQ(i + 1, handlers[i].count_);
+  }
+
+  // Replies are sent on the requesting connection
+  ASSERT_TRUE(pingRequest.init(StandardMsgTypes::PING, CommTypes::SERVICE_REQUEST, ReplyTypes::INVALID));
+  ASSERT_TRUE(clients[1]->sendMsg(pingRequest));
+  EXPECT_EQ(1, reactor.spinOnce(1000));
+  ASSERT_TRUE(clients[1]->receiveMsg(pingReply));
+  EXPECT_EQ(ReplyTypes::SUCCESS, pingReply.getReplyCode());
+
+  // A lost connection is handled by its own fault handler, the other
+  // connections are still serviced
+  delete clients[0];
+  clients[0] = NULL;
+  EXPECT_EQ(0, reactor.spinOnce(1000));
+  EXPECT_FALSE(servers[0].isConnected());
+  EXPECT_EQ(1, faults[0].receive_fail_);
+
+  ASSERT_TRUE(clients[2]->sendMsg(msg));
+  EXPECT_EQ(1, reactor.spinOnce(1000));
+  EXPECT_EQ(4, handlers[2].count_);
+  EXPECT_LE(1, faults[0].connection_fail_);
+  EXPECT_EQ(0, faults[1].connection_fail_);
+  EXPECT_EQ(0, faults[2].connection_fail_);
+
+  EXPECT_TRUE(reactor.remove(&managers[0]));
+  EXPECT_FALSE(reactor.remove(&managers[0]));
+  EXPECT_EQ(NUM_CONNECTIONS - 1, (int)reactor.getNumManagers());
+
+  for (int i = 0; i < NUM_CONNECTIONS; i++)
+  {
+    delete clients[i];
+  }
+}
+
+TEST(MessageReactorSuite, partialMessage)
+{
+  const int NUM_CONNECTIONS = 2;
+  const int tcpPort = TEST_PORT_BASE + 21;
+  char ipAddr[] = "127.0.0.1";
+
+  TestTcpClient clients[NUM_CONNECTIONS];
+  TcpServer servers[NUM_CONNECTIONS];
+  MessageManager managers[NUM_CONNECTIONS];
+  CountHandler handlers[NUM_CONNECTIONS];
+  CountFaultHandler faults[NUM_CONNECTIONS];
+  MessageReactor reactor;
+  SimpleMessage msg;
+  ByteArray header, data;
+
+  // Message with 8 data bytes, sent in two parts: the length prefix and
+  // header, then the data
+  ASSERT_TRUE(header.load((shared_int)(SimpleMessage::getHeaderSize() + 2 * sizeof(shared_int))));
+  ASSERT_TRUE(header.load((shared_int)StandardMsgTypes::SWRI_MSG_BEGIN));
+  ASSERT_TRUE(header.load((shared_int)CommTypes::TOPIC));
+  ASSERT_TRUE(header.load((shared_int)ReplyTypes::INVALID));
+  ASSERT_TRUE(data.load((shared_int)1));
+  ASSERT_TRUE(data.load((shared_int)2));
+  ASSERT_TRUE(msg.init(StandardMsgTypes::SWRI_MSG_BEGIN, CommTypes::TOPIC, ReplyTypes::INVALID));
+
+  ASSERT_TRUE(reactor.init());
+  for (int i = 0; i < NUM_CONNECTIONS; i++)
+  {
+    ASSERT_TRUE(servers[i].init(tcpPort + i));
+    ASSERT_TRUE(clients[i].init(&ipAddr[0], tcpPort + i));
+    ASSERT_TRUE(clients[i].makeConnect());
+    ASSERT_TRUE(servers[i].makeConnect());
+
+    ASSERT_TRUE(managers[i].init(&servers[i], &faults[i]));
+    ASSERT_TRUE(handlers[i].init(StandardMsgTypes::SWRI_MSG_BEGIN, &servers[i]));
+    ASSERT_TRUE(managers[i].add(&handlers[i]));
+    ASSERT_TRUE(reactor.add(&managers[i]));
+  }
+
+  // A partial message is kept (without waiting for the rest of it), the
+  // other connection is still serviced
+  ASSERT_TRUE(clients[0].sendBytes(header));
+  ASSERT_TRUE(clients[1].sendMsg(msg));
+  for (int i = 0; i < 10 && handlers[1].count_ < 1; i++)
+  {
+    EXPECT_LE(0, reactor.spinOnce(100));
+  }
+  EXPECT_EQ(1, handlers[1].count_);
+  EXPECT_EQ(0, handlers[0].count_);
+  EXPECT_TRUE(servers[0].isConnected());
+
+  ASSERT_TRUE(clients[1].sendMsg(msg));
+  EXPECT_EQ(1, reactor.spinOnce(1000));
+  EXPECT_EQ(2, handlers[1].count_);
+
+  // The message is handled once the rest of it arrives
+  ASSERT_TRUE(clients[0].sendBytes(data));
+  EXPECT_EQ(1, reactor.spinOnce(1000));
+  EXPECT_EQ(1, handlers[0].count_);
+  EXPECT_TRUE(servers[0].isConnected());
+  EXPECT_EQ(0, faults[0].receive_fail_);
+}
+
+TEST(MessageReactorSuite, batchDelay)
+{
+  const int tcpPort = TEST_PORT_BASE + 24;
+  const int DELAY = 50;
+  char ipAddr[] = "127.0.0.1";
+
+  TcpClient tcpClient;
+  TcpServer tcpServer;
+  MessageManager manager;
+  CountFaultHandler fault;
+  MessageReactor reactor;
+  SimpleMessage msg, recv;
+  unsigned int start;
+
+  ASSERT_TRUE(reactor.init());
+  ASSERT_TRUE(tcpServer.init(tcpPort));
+  ASSERT_TRUE(tcpClient.init(&ipAddr[0], tcpPort));
+  ASSERT_TRUE(tcpClient.makeConnect());
+  ASSERT_TRUE(tcpServer.makeConnect());
+  tcpServer.setReceiveTimeout(1000);
+  ASSERT_TRUE(manager.init(&tcpClient, &fault));
+  ASSERT_TRUE(reactor.add(&manager));
+
+  // A queued message is sent once it is due, without another message being
+  // queued (the wait ends when it is due)
+  ASSERT_TRUE(tcpClient.setBatching(SmplMsgConnection::MAX_BATCH_BYTES, DELAY));
+  ASSERT_TRUE(msg.init(StandardMsgTypes::SWRI_MSG_BEGIN, CommTypes::TOPIC, ReplyTypes::INVALID));
+  ASSERT_TRUE(tcpClient.queueMsg(msg));
+  start = TcpClient::getTimeMs();
+  EXPECT_EQ(0, reactor.spinOnce(1000));
+  EXPECT_GT(500, (int)(TcpClient::getTimeMs() - start));
+  EXPECT_LE(DELAY, (int)(TcpClient::getTimeMs() - start));
+  EXPECT_EQ(-1, tcpClient.getFlushTimeout());
+  ASSERT_TRUE(tcpServer.receiveMsg(recv));
+  EXPECT_EQ(StandardMsgTypes::SWRI_MSG_BEGIN, recv.getMessageType());
+  EXPECT_EQ(0, fault.send_fail_);
+}
+
+TEST(MessageReactorSuite, connect)
+{
+  const int tcpPort = TEST_PORT_BASE + 14;
+  char ipAddr[] = "127.0.0.1";
+
+  TcpClient tcpClient;
+  TcpServer tcpServer;
+  MessageManager manager;
+  SimpleCommsFaultHandler fault;
+  MessageReactor reactor;
+  SimpleMessage msg, recv;
+  unsigned int start;
+
+  // The client connect is driven by the reactor (without blocking)
+  ASSERT_TRUE(reactor.init());
+  ASSERT_TRUE(tcpClient.init(&ipAddr[0], tcpPort));
+  ASSERT_TRUE(tcpClient.setConnectBackoff(10, 50));
+  ASSERT_TRUE(fault.init(&tcpClient));
+  ASSERT_TRUE(manager.init(&tcpClient, &fault));
+  ASSERT_TRUE(reactor.add(&manager));
+
+  for (int i = 0; i < 3; i++)
+  {
+    EXPECT_EQ(0, reactor.spinOnce(50));
+  }
+  EXPECT_FALSE(tcpClient.isConnected());
+
+  ASSERT_TRUE(tcpServer.init(tcpPort));
+  start = TcpClient::getTimeMs();
+  while (!tcpClient.isConnected() && (int)(TcpClient::getTimeMs() - start) < 2000)
+  {
+    ASSERT_LE(0, reactor.spinOnce(100));
+  }
+  ASSERT_TRUE(tcpClient.isConnected());
+  EXPECT_GT(500, (int)(TcpClient::getTimeMs() - start));
+  ASSERT_TRUE(tcpServer.makeConnect());
+
+  // The connection is serviced once connected
+  ASSERT_TRUE(msg.init(StandardMsgTypes::PING, CommTypes::SERVICE_REQUEST, ReplyTypes::INVALID));
+  ASSERT_TRUE(tcpServer.sendMsg(msg));
+  EXPECT_EQ(1, reactor.spinOnce(1000));
+  ASSERT_TRUE(tcpServer.receiveMsg(recv));
+  EXPECT_EQ(ReplyTypes::SUCCESS, recv.getReplyCode());
+}
+
+TEST(MessageServerSuite, multiClient)
+{
+  const int NUM_CLIENTS = 3;
+  const int tcpPort = TEST_PORT_BASE + 15;
+  char ipAddr[] = "127.0.0.1";
+
+  MessageReactor reactor;
+  MessageServer server;
+  CountHandler handlers[MessageServer::MAX_NUM_SESSIONS];
+  TcpClient* clients[NUM_CLIENTS];
+  SimpleMessage msg, pingRequest, pingReply;
+  int count = 0;
+
+  ASSERT_TRUE(reactor.init());
+  EXPECT_FALSE(server.init(tcpPort, NULL));
+  ASSERT_TRUE(server.init(tcpPort, &reactor));
+  EXPECT_FALSE(reactor.addServer(&server));
+  EXPECT_EQ(NULL, server.getManager(server.getMaxNumSessions()));
+  for (unsigned int i = 0; i < server.getMaxNumSessions(); i++)
+  {
+    ASSERT_TRUE(handlers[i].init(StandardMsgTypes::SWRI_MSG_BEGIN, server.getManager(i)->getConnection()));
+    ASSERT_TRUE(server.getManager(i)->add(&handlers[i]));
+  }
+
+  // Clients are accepted by the reactor, each into its own session
+  for (int i = 0; i < NUM_CLIENTS; i++)
+  {
+    clients[i] = new TcpClient();
+    ASSERT_TRUE(clients[i]->init(&ipAddr[0], tcpPort));
+    ASSERT_TRUE(clients[i]->makeConnect());
+  }
+  for (int i = 0; i < 100 && (int)server.getNumSessions() < NUM_CLIENTS; i++)
+  {
+    EXPECT_LE(0, reactor.spinOnce(100));
+  }
+  ASSERT_EQ(NUM_CLIENTS, (int)server.getNumSessions());
+  EXPECT_EQ(NUM_CLIENTS, (int)reactor.getNumManagers());
+
+  // Messages are dispatched to the handlers of the receiving session, and
+  // replies are sent to the requesting client
+  ASSERT_TRUE(msg.init(StandardMsgTypes::SWRI_MSG_BEGIN, CommTypes::TOPIC, ReplyTypes::INVALID));
+  for (int i = 0; i < NUM_CLIENTS; i++)
+  {
+    for (int j = 0; j <= i; j++)
+    {
+      ASSERT_TRUE(clients[i]->sendMsg(msg));
+    }
+  }
+  for (int i = 0; i < 100 && count < 6; i++)
+  {
+    count += reactor.spinOnce(100);
+  }
+  EXPECT_EQ(6, count);
+  for (int i = 0; i < NUM_CLIENTS; i++)
+  {
+    EXPECT_EQ(i + 1, handlers[i].count_);
+  }
+
+  ASSERT_TRUE(pingRequest.init(StandardMsgTypes::PING, CommTypes::SERVICE_REQUEST, ReplyTypes::INVALID));
+  ASSERT_TRUE(clients[2]->sendMsg(pingRequest));
+  EXPECT_EQ(1, reactor.spinOnce(1000));
+  ASSERT_TRUE(clients[2]->receiveMsg(pingReply));
+  EXPECT_EQ(ReplyTypes::SUCCESS, pingReply.getReplyCode());
+
+  // A lost client closes its session, which is reused by the next client
+  delete clients[0];
+  for (int i = 0; i < 100 && server.isSessionActive(0); i++)
+  {
+    EXPECT_LE(0, reactor.spinOnce(100));
+  }
+  EXPECT_FALSE(server.isSessionActive(0));
+  EXPECT_EQ(NUM_CLIENTS - 1, (int)server.getNumSessions());
+  EXPECT_EQ(NUM_CLIENTS - 1, (int)reactor.getNumManagers());
+
+  clients[0] = new TcpClient();
+  ASSERT_TRUE(clients[0]->init(&ipAddr[0], tcpPort));
+  ASSERT_TRUE(clients[0]->makeConnect());
+  for (int i = 0; i < 100 && !server.isSessionActive(0); i++)
+  {
+    EXPECT_LE(0, reactor.spinOnce(100));
+  }
+  ASSERT_TRUE(server.isSessionActive(0));
+  ASSERT_TRUE(clients[0]->sendMsg(msg));
+  EXPECT_EQ(1, reactor.spinOnce(1000));
+  EXPECT_EQ(2, handlers[0].count_);
+
+  for (int i = 0; i < NUM_CLIENTS; i++)
+  {
+    delete clients[i];
+  }
+}
+
+TEST(MessageServerSuite, slowClient)
+{
+  const int tcpPort = TEST_PORT_BASE + 23;
+  char ipAddr[] = "127.0.0.1";
+
+  MessageReactor reactor;
+  MessageServer server;
+  TestTcpClient slowClient;
+  TcpClient client;
+  SimpleMessage pingRequest, pingReply;
+  ByteArray prefix;
+
+  ASSERT_TRUE(reactor.init());
+  ASSERT_TRUE(server.init(tcpPort, &reactor));
+
+  // The slow client only sends the length prefix of a message
+  ASSERT_TRUE(prefix.load((shared_int)SimpleMessage::getHeaderSize()));
+  ASSERT_TRUE(slowClient.init(&ipAddr[0], tcpPort));
+  ASSERT_TRUE(slowClient.makeConnect());
+  for (int i = 0; i < 100 && server.getNumSessions() < 1; i++)
+  {
+    EXPECT_LE(0, reactor.spinOnce(100));
+  }
+  ASSERT_EQ(1, (int)server.getNumSessions());
+  ASSERT_TRUE(slowClient.sendBytes(prefix));
+  EXPECT_EQ(0, reactor.spinOnce(100));
+
+  // Other clients are still accepted and serviced
+  ASSERT_TRUE(client.init(&ipAddr[0], tcpPort));
+  ASSERT_TRUE(client.makeConnect());
+  for (int i = 0; i < 100 && server.getNumSessions() < 2; i++)
+  {
+    EXPECT_LE(0, reactor.spinOnce(100));
+  }
+  ASSERT_EQ(2, (int)server.getNumSessions());
+
+  ASSERT_TRUE(pingRequest.init(StandardMsgTypes::PING, CommTypes::SERVICE_REQUEST, ReplyTypes::INVALID));
+  ASSERT_TRUE(client.sendMsg(pingRequest));
+  EXPECT_EQ(1, reactor.spinOnce(1000));
+  ASSERT_TRUE(client.receiveMsg(pingReply));
+  EXPECT_EQ(ReplyTypes::SUCCESS, pingReply.getReplyCode());
+  EXPECT_TRUE(server.isSessionActive(0));
 }
 
 // wrapper around MessageManager::spin() that can be passed to
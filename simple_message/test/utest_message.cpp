@@ -38,12 +38,16 @@
 #include "simple_message/messages/joint_traj_pt_message.h"
 #include "simple_message/typed_message.h"
 #include "simple_message/joint_traj.h"
+#include "simple_message/joint_traj_full.h"
+#include "simple_message/messages/joint_traj_full_message.h"
 #include "simple_message/robot_status.h"
 #include "simple_message/messages/robot_status_message.h"
 
 #include <gtest/gtest.h>
 
 using namespace industrial::simple_message;
+using namespace industrial::byte_array;
+using namespace industrial::shared_types;
 using namespace industrial::tcp_socket;
 using namespace industrial::tcp_client;
 using namespace industrial::tcp_server;
@@ -53,6 +57,9 @@ using namespace industrial::joint_traj_pt;
 using namespace industrial::joint_traj_pt_message;
 using namespace industrial::typed_message;
 using namespace industrial::joint_traj;
+using namespace industrial::joint_traj_pt_full;
+using namespace industrial::joint_traj_full;
+using namespace industrial::joint_traj_full_message;
 using namespace industrial::robot_status;
 using namespace industrial::robot_status_message;
 
@@ -138,6 +145,42 @@ TEST(JointMessage, toMessage)
 
 }
 
+TEST(JointMessage, numJoints)
+{
+  JointData joint, legacy;
+  JointMessage toMsg, fromMsg;
+  SimpleMessage msg;
+
+  // Default (legacy) layout is 10 joints
+  EXPECT_EQ(10, legacy.getMaxNumJoints());
+  EXPECT_EQ(10 * sizeof(shared_real), legacy.byteLength());
+
+  // Compact layout, only the active joints are sent
+  ASSERT_TRUE(joint.setNumJoints(6));
+  EXPECT_EQ(6 * sizeof(shared_real), joint.byteLength());
+  EXPECT_TRUE(joint.setJoint(5, 6.0));
+  EXPECT_FALSE(joint.setJoint(6, 7.0));
+  EXPECT_FALSE(joint==legacy);
+
+  toMsg.init(1, joint);
+  ASSERT_TRUE(toMsg.toTopic(msg));
+  EXPECT_EQ((int)(sizeof(shared_int) + 6 * sizeof(shared_real)), msg.getDataLength());
+  ASSERT_TRUE(fromMsg.init(msg));
+  EXPECT_EQ(6, fromMsg.getJoints().getMaxNumJoints());
+  EXPECT_TRUE(joint==fromMsg.getJoints());
+
+  // More joints than the legacy layout (i.e. dual arm)
+  ASSERT_TRUE(joint.setNumJoints(13));
+  EXPECT_TRUE(joint.setJoint(12, 13.0));
+  toMsg.init(2, joint);
+  ASSERT_TRUE(toMsg.toTopic(msg));
+  ASSERT_TRUE(fromMsg.init(msg));
+  EXPECT_TRUE(joint==fromMsg.getJoints());
+
+  EXPECT_FALSE(joint.setNumJoints(joint.getJointCapacity() + 1));
+  EXPECT_FALSE(joint.setNumJoints(-1));
+}
+
 TEST(JointMessage, Comms)
 {
 
@@ -268,6 +311,178 @@ TEST(JointTraj, equal)
 
 }
 
+TEST(JointTraj, serialize)
+{
+  JointTraj send, recvArray, recvReader;
+  JointData joint;
+  JointTrajPt point;
+  ByteArray buffer;
+
+  for (int i = 0; i < 10; i++)
+  {
+    joint.init();
+    ASSERT_TRUE(joint.setJoint(0, 1.0 + i));
+    ASSERT_TRUE(joint.setJoint(9, 10.0 + i));
+    point.init(i, joint, 50.0, 100 + i);
+    ASSERT_TRUE(send.addPoint(point));
+  }
+  ASSERT_TRUE(buffer.load(send));
+
+  // Forward (in place) read, the buffer is not modified
+  ByteArrayReader reader(buffer);
+  ASSERT_TRUE(reader.unload(recvReader));
+  EXPECT_EQ(0, (int)reader.getRemainSize());
+  EXPECT_TRUE(send==recvReader);
+
+  // Standard unload (from the end of the buffer)
+  ASSERT_TRUE(buffer.unload(recvArray));
+  EXPECT_EQ(0, (int)buffer.getBufferSize());
+  EXPECT_TRUE(send==recvArray);
+
+  // Points with fewer joints (the number of joints must be set to unload them)
+  send.init();
+  for (int i = 0; i < 10; i++)
+  {
+    joint.init();
+    ASSERT_TRUE(joint.setNumJoints(6));
+    ASSERT_TRUE(joint.setJoint(5, 6.0 + i));
+    point.init(i, joint, 50.0, 100 + i);
+    ASSERT_TRUE(send.addPoint(point));
+  }
+  ASSERT_TRUE(buffer.load(send));
+  ASSERT_TRUE(recvArray.setNumJoints(6));
+  ASSERT_TRUE(buffer.unload(recvArray));
+  EXPECT_TRUE(send==recvArray);
+}
+
+TEST(JointTraj, capacity)
+{
+  JointTraj traj, recv;
+  JointData joint;
+  JointTrajPt point;
+  ByteArray buffer;
+
+  // The trajectory is limited by the message size, not internal storage
+  EXPECT_GT(traj.getMaxNumPoints(), 0);
+  EXPECT_LE(traj.getMaxNumPoints() * point.byteLength() + sizeof(shared_int), buffer.getMaxBufferSize());
+
+  for (int i = 0; i < traj.getMaxNumPoints(); i++)
+  {
+    joint.init();
+    ASSERT_TRUE(joint.setJoint(0, 1.0 + i));
+    point.init(i, joint, 50.0, 100 + i);
+    ASSERT_TRUE(traj.addPoint(point));
+  }
+  EXPECT_TRUE(traj.isFull());
+  EXPECT_FALSE(traj.addPoint(point));
+
+  // Copies are independent (deep) copies
+  JointTraj copy(traj);
+  EXPECT_TRUE(copy==traj);
+  traj.init();
+  EXPECT_EQ(0, traj.size());
+  EXPECT_FALSE(copy==traj);
+  traj = copy;
+  EXPECT_TRUE(copy==traj);
+
+  ASSERT_TRUE(buffer.load(copy));
+  ASSERT_TRUE(buffer.unload(recv));
+  EXPECT_TRUE(copy==recv);
+}
+
+TEST(JointTrajFull, serialize)
+{
+  JointTrajFull send, recvArray, recvReader;
+  JointData pos, vel, acc;
+  JointTrajPtFull point;
+  ByteArray buffer;
+  int valid = ValidFieldTypes::TIME | ValidFieldTypes::POSITION | ValidFieldTypes::VELOCITY;
+
+  for (int i = 0; i < send.getMaxNumPoints(); i++)
+  {
+    pos.init();
+    vel.init();
+    acc.init();
+    ASSERT_TRUE(pos.setJoint(0, 1.0 + i));
+    ASSERT_TRUE(vel.setJoint(9, 10.0 + i));
+    point.init(0, i, valid, 0.1 * i, pos, vel, acc);
+    ASSERT_TRUE(send.addPoint(point));
+  }
+  EXPECT_TRUE(send.isFull());
+  EXPECT_FALSE(send.addPoint(point));
+  ASSERT_TRUE(buffer.load(send));
+  EXPECT_EQ(send.byteLength(), buffer.getBufferSize());
+
+  // Forward (in place) read, the buffer is not modified
+  ByteArrayReader reader(buffer);
+  ASSERT_TRUE(reader.unload(recvReader));
+  EXPECT_EQ(0, (int)reader.getRemainSize());
+  EXPECT_TRUE(send==recvReader);
+
+  // Standard unload (from the end of the buffer)
+  ASSERT_TRUE(buffer.unload(recvArray));
+  EXPECT_EQ(0, (int)buffer.getBufferSize());
+  EXPECT_TRUE(send==recvArray);
+}
+
+TEST(JointTrajFull, toMessage)
+{
+  JointTrajFull traj;
+  JointData pos, vel, acc;
+  JointTrajPtFull point;
+  JointTrajFullMessage toMsg, fromMsg;
+  SimpleMessage msg;
+
+  pos.init();
+  vel.init();
+  acc.init();
+  ASSERT_TRUE(pos.setJoint(5, 6.0));
+  point.init(0, industrial::joint_traj_pt_full::SpecialSeqValues::START_TRAJECTORY_DOWNLOAD,
+             ValidFieldTypes::TIME | ValidFieldTypes::POSITION, 0.0, pos, vel, acc);
+  ASSERT_TRUE(traj.addPoint(point));
+  point.init(0, industrial::joint_traj_pt_full::SpecialSeqValues::END_TRAJECTORY,
+             ValidFieldTypes::TIME | ValidFieldTypes::POSITION, 1.0, pos, vel, acc);
+  ASSERT_TRUE(traj.addPoint(point));
+
+  toMsg.init(traj);
+  ASSERT_TRUE(toMsg.toTopic(msg));
+  EXPECT_EQ(StandardMsgTypes::JOINT_TRAJ_FULL, msg.getMessageType());
+  EXPECT_EQ((int)traj.byteLength(), msg.getDataLength());
+
+  ASSERT_TRUE(fromMsg.init(msg));
+  EXPECT_TRUE(toMsg.traj_==fromMsg.traj_);
+}
+
+TEST(JointTrajFull, numJoints)
+{
+  JointTrajFull traj;
+  JointData pos, vel, acc;
+  JointTrajPtFull point, legacy;
+  JointTrajFullMessage toMsg, fromMsg;
+  SimpleMessage msg;
+
+  ASSERT_TRUE(pos.setNumJoints(7));
+  ASSERT_TRUE(vel.setNumJoints(7));
+  ASSERT_TRUE(acc.setNumJoints(7));
+  for (int i = 0; i < 5; i++)
+  {
+    ASSERT_TRUE(pos.setJoint(6, 1.0 + i));
+    point.init(0, i, ValidFieldTypes::TIME | ValidFieldTypes::POSITION, 0.1 * i, pos, vel, acc);
+    ASSERT_TRUE(traj.addPoint(point));
+  }
+  EXPECT_EQ(7, traj.getNumJoints());
+
+  // Points of a different size are rejected
+  EXPECT_FALSE(traj.addPoint(legacy));
+
+  toMsg.init(traj);
+  ASSERT_TRUE(toMsg.toTopic(msg));
+  EXPECT_EQ((int)traj.byteLength(), msg.getDataLength());
+  ASSERT_TRUE(fromMsg.init(msg));
+  EXPECT_EQ(7, fromMsg.traj_.getNumJoints());
+  EXPECT_TRUE(toMsg.traj_==fromMsg.traj_);
+}
+
 TEST(RobotStatus, enumerations)
 {
   // Verifying the disabled state and aliases match
@@ -373,3 +588,35 @@ TEST(RobotStatus, Comms)
   ASSERT_TRUE(statusRecv==statusSend);
 }
 
+TEST(ByteArrayReader, read)
+{
+  JointTrajPtMessage send, recv;
+  JointTrajPt point;
+  JointData joint;
+  SimpleMessage msg;
+
+  joint.init();
+  for (int i = 0; i < joint.getMaxNumJoints(); i++)
+  {
+    ASSERT_TRUE(joint.setJoint(i, 1.0 + i));
+  }
+  point.init(1, joint, 0.5, 2.0);
+  send.init(point);
+  ASSERT_TRUE(send.toTopic(msg));
+  int length = msg.getDataLength();
+
+  // Copy and unload from the end of the buffer (previous message init method)
+  ByteArray data = msg.getData();
+  ASSERT_TRUE(data.unload(recv.point_));
+  EXPECT_TRUE(send.point_==recv.point_);
+
+  // Forward, in place, read (the message data is not modified, see
+  // test/benchmark.cpp for the decode cost)
+  recv.init();
+  ASSERT_TRUE(recv.init(msg));
+  EXPECT_TRUE(send.point_==recv.point_);
+  ASSERT_TRUE(recv.init(msg));
+  EXPECT_TRUE(send.point_==recv.point_);
+  EXPECT_EQ(length, msg.getDataLength());
+}
+